@@ -15,17 +15,33 @@
  * You should have received a copy of the GNU General Public License
  * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <iograph/httpcache.hpp>
+#include <iograph/filewatcher.hpp>
+#include <iograph/httpclient.hpp>
+#include <iograph/inflater.hpp>
+#include <iograph/memory.hpp>
+#include <iograph/progress.hpp>
+#include <iograph/resultdiff.hpp>
+#include <iograph/resultparser.hpp>
+#include <iograph/trace.hpp>
 #include <iograph/wantparser.hpp>
 #include <solver/mathtrader.hpp>
 
+#include <chrono>
+#include <csignal>
+#include <cstdio>
 #include <exception>
+#include <fstream>
 #include <iomanip>
 #include <lemon/arg_parser.h>
 #include <lemon/time_measure.h>
+#include <memory>
 #include <new>
 #include <sstream>
+#include <vector>
 
 #include "config.hpp"
+#include "progressmonitor.hpp"
 
 /* Tabular width for timer output */
 #define TABWIDTH (32)
@@ -42,6 +58,7 @@ public:
 			const std::list< std::string > & argv);
 	~Interface();
 	int run();
+	int watch();
 
 	static void showVersion( std::ostream & os = std::cout );
 
@@ -60,8 +77,40 @@ private:
 	/**
 	 * Output file stream,
 	 * when writing to a file.
+	 * Writes to a temporary file,
+	 * renamed over the output file on success.
 	 */
 	std::ofstream _ofs;
+	std::string _ofs_tmp;
+
+	/**
+	 * Want-list parser of the last successful run,
+	 * when watching; its line index is reused.
+	 */
+	std::unique_ptr< WantParser > _want_parser;
+
+	/**
+	 * Records the trace of a run, if a file is given;
+	 * writes it on destruction, on any return path.
+	 */
+	class TraceWriter {
+	public:
+		explicit TraceWriter( const std::string & fn );
+		~TraceWriter();
+	private:
+		const std::string _fn;
+	};
+
+	/**
+	 * Discard a partially written output file.
+	 */
+	void _discardOutput();
+
+	/**
+	 * A single run; see run().
+	 * Throws Cancelled on interruption.
+	 */
+	int _run( ProgressMonitor & monitor );
 
 	/**
 	 * Make uppercase
@@ -70,6 +119,19 @@ private:
 };
 
 
+/**********************************************//*
+ * 		SIGNAL HANDLERS
+ ************************************************/
+
+/**
+ * Request the cancellation of the run;
+ * async-signal-safe.
+ */
+static void onInterrupt( int ) {
+	Cancellation::request();
+}
+
+
 /**********************************************//*
  * 		MAIN FUNCTION
  ************************************************/
@@ -91,7 +153,8 @@ int main(int argc, char **argv) {
 	/**
 	 * Input/Output
 	 */
-	ap.stringOption("-input-file", "input official wants file (default: stdin)");
+	ap.stringOption("-input-file", "input official wants file,"
+			" optionally gzip-compressed (default: stdin)");
 	ap.synonym("f", "-input-file");
 	ap.synonym("-official-wants", "-input-file");
 
@@ -102,13 +165,42 @@ int main(int argc, char **argv) {
 	ap.stringOption("-input-url",
 			"input official wants file from url");
 
+	ap.stringOption("-input-files",
+			"comma-separated official wants files,"
+			" combined into a single trade;"
+			" each given as [NAMESPACE=]FILE"
+			" (default namespace: the file name up to its first '.')");
+
 	ap.stringOption("-input-lgf-file",
-			"parse directly a lemon graph format (LGF) file;"
+			"parse directly a lemon graph format (LGF) file,"
+			" optionally gzip-compressed;"
 			" no wants file will be read");
 
+	ap.stringOption("-cache-dir",
+			"cache directory for -input-url;"
+			" unchanged remote files are not downloaded again");
+
+	ap.stringOption("-index-file",
+			"line index of the previous want-list parse;"
+			" only new or changed lines are tokenized."
+			" Updated after parsing");
+
+	ap.boolOption("-watch",
+			"keep running; re-run whenever the input file"
+			" (-input-file or -input-lgf-file) is saved");
+	ap.intOption("-watch-debounce",
+			"wait for this many milliseconds without changes"
+			" before re-running (default: 200)", 200);
+
+	ap.stringOption("-trace",
+			"write the phases of the run as Chrome trace events"
+			" to the given JSON file;"
+			" open it in chrome://tracing or ui.perfetto.dev");
+
 	ap.onlyOneGroup("input_file").
 		optionGroup("input_file", "-input-file").
 		optionGroup("input_file", "-input-url").
+		optionGroup("input_file", "-input-files").
 		optionGroup("input_file", "-input-lgf-file");
 
 
@@ -184,6 +276,19 @@ int main(int argc, char **argv) {
 			"show the dummy items instead of merging them; "
 			"only useful for debugging purposes");
 
+	/**
+	 * Verify the results in memory.
+	 */
+	ap.boolOption("-verify",
+			"verify that the results form valid trade loops"
+			" over the want lists; fail otherwise");
+
+	/**
+	 * Report changes against previous results.
+	 */
+	ap.stringOption("-diff-against",
+			"report the changes against a previous official results file");
+
 	/**
 	 * Export input to lgf file.
 	 */
@@ -204,6 +309,35 @@ int main(int argc, char **argv) {
 	ap.boolOption("-show-strongly-connected",
 			"analyze strongly connected components of input graph");
 
+	/**
+	 * Show the statistics of the minimum cost flow algorithm.
+	 */
+	ap.boolOption("-show-solver-stats",
+			"show the flow network size, peak memory"
+			" and the counters of the minimum cost flow algorithm");
+
+	/**
+	 * Show the progress of long phases.
+	 */
+	ap.boolOption("-progress",
+			"print the phase, elapsed time and, where known,"
+			" the ETA to the standard error every second");
+
+	/**
+	 * Show the memory of each phase and data structure.
+	 */
+	ap.boolOption("-show-memory",
+			"show the heap allocations of each phase,"
+			" the estimated memory of each data structure"
+			" and the peak resident set size");
+
+	/**
+	 * Back the flow network by huge pages.
+	 */
+	ap.boolOption("-huge-pages",
+			"back the flow network and the arrays of the algorithm"
+			" by transparent huge pages, if the kernel supports them");
+
 	/**
 	 * Show version
 	 */
@@ -221,6 +355,11 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 
+	/* Count the heap allocations from now on. */
+	if ( ap.given("-show-memory") ) {
+		MemoryAccount::enable();
+	}
+
 
 	/********************************************//*
 	 * 	Show version
@@ -241,6 +380,26 @@ int main(int argc, char **argv) {
 	}
 
 
+	/********************************************//*
+	 * 	Check watch mode
+	 **********************************************/
+
+	if ( ap.given("-watch") && !ap.given("-input-file")
+			&& !ap.given("-input-lgf-file") ) {
+		std::cerr << "Option -watch requires"
+			" -input-file or -input-lgf-file"
+			<< std::endl;
+		return 1;
+	}
+
+	if ( ap.given("-input-files") && ap.given("-index-file") ) {
+		std::cerr << "Option -index-file cannot be combined"
+			" with -input-files"
+			<< std::endl;
+		return 1;
+	}
+
+
 	/********************************************//*
 	 * 	Tokenize arguments
 	 **********************************************/
@@ -265,14 +424,25 @@ int main(int argc, char **argv) {
 	 */
 	Interface runner(ap, arg_list);
 
+	/**
+	 * Ctrl-C cancels the run at its next checkpoint;
+	 * nothing partial is written.
+	 */
+	std::signal( SIGINT, onInterrupt );
+
 	/**
 	 * Run the application.
 	 * Any caught exceptions should be considered FATAL.
 	 * In general, class Interface should handle exceptions
 	 * and re-throw them only when FATAL.
 	 */
+	int status = 0;
 	try {
-		runner.run();
+		if ( ap.given("-watch") ) {
+			status = runner.watch();
+		} else {
+			status = runner.run();
+		}
 	} catch ( const std::exception & error ) {
 		std::cerr << "FATAL error: "
 			<< error.what()
@@ -285,7 +455,13 @@ int main(int argc, char **argv) {
 		return -2;
 	}
 
-	return 0;
+	/* Interrupted; as the shell would report SIGINT. */
+	if ( Cancellation::requested() ) {
+		return 130;
+	}
+
+	/* Failed, e.g., to parse or to verify the results. */
+	return status;
 }
 
 
@@ -299,22 +475,108 @@ Interface::Interface( const lemon::ArgParser & ap,
 	_ap( ap ),
 	_argv( argv )
 {
+	/* Start with an empty index when watching. */
+	if ( ap.given("-watch") ) {
+		_want_parser.reset( new WantParser() );
+	}
 }
 
 Interface::~Interface() {
 
 	/**
-	 * On destruction: always close file stream
-	 * if applicable
+	 * On destruction: discard any output file
+	 * that has not been completed.
 	 */
+	_discardOutput();
+}
+
+void
+Interface::_discardOutput() {
+
 	if ( _ofs.is_open() ) {
 		_ofs.close();
+		std::remove( _ofs_tmp.c_str() );
+	}
+}
+
+int
+Interface::watch() {
+
+	auto const & ap = this->_ap;
+	const std::string & fn = ap.given("-input-lgf-file") ?
+		ap["-input-lgf-file"] : ap["-input-file"];
+	const int debounce_ms = ap["-watch-debounce"];
+
+	/**
+	 * Start watching before the first run,
+	 * so that no save is missed.
+	 */
+	FileWatcher watcher(fn, debounce_ms);
+	int status = this->run();
+
+	while ( !Cancellation::requested() ) {
+		std::cerr << "Watching " << fn
+			<< " for changes; press Ctrl-C to stop."
+			<< std::endl;
+
+		/* Interrupted, e.g., by Ctrl-C. */
+		FileWatcher::Clock::time_point saved;
+		if ( !watcher.wait(saved) ) {
+			break;
+		}
+
+		/**
+		 * Re-run; the previous results are kept
+		 * if anything fails.
+		 */
+		status = this->run();
+		if ( status == 130 ) {
+			break;
+		}
+
+		const std::chrono::duration< double > elapsed =
+			FileWatcher::Clock::now() - saved;
+		std::cerr << std::left << std::setw(TABWIDTH)
+			<< "Save to results:"
+			<< elapsed.count() << "s"
+			<< std::endl;
 	}
+	return status;
 }
 
 int
 Interface::run() {
 
+	/**
+	 * Follow the phases of the run:
+	 * print the heartbeat, if requested;
+	 * abort if the run cannot be cancelled in time.
+	 */
+	ProgressMonitor monitor( std::cerr, _ap.given("-progress") );
+
+	try {
+		return this->_run( monitor );
+
+	} catch ( const Cancelled & ) {
+
+		/**
+		 * Cancelled at a checkpoint:
+		 * discard the output; report where the time went.
+		 */
+		monitor.stop();
+		_discardOutput();
+		std::cerr << "Cancelled during "
+			<< monitor.phase()
+			<< "; no results have been written."
+			<< std::endl;
+		monitor.report( std::cerr );
+		return 130;
+	}
+}
+
+int
+Interface::_run( ProgressMonitor & monitor ) {
+
 	/**
 	 * Start the global timer
 	 */
@@ -328,6 +590,19 @@ Interface::run() {
 	 */
 	auto const & ap = this->_ap;
 
+	/**
+	 * Trace the phases of the run, if requested.
+	 * The zone of the run ends before the trace is written.
+	 */
+	TraceWriter trace_writer( ap.given("-trace") ?
+			std::string( ap["-trace"] ) : std::string() );
+	TraceZone zone("run", "app");
+
+	/**
+	 * Memory of each phase, if requested.
+	 */
+	MemoryReport memory_report;
+
 
 	/**************************************//*
 	 * OPEN OUTPUT STREAM
@@ -335,16 +610,23 @@ Interface::run() {
 
 	/**
 	 * First operation is always to open the output file stream.
-	 * The output will be written to either a file or std::cout.
+	 * The output will be written to either a file or std::cout;
+	 * to std::cout only once complete.
 	 * Open the output file, if needed.
 	 */
 	std::ofstream & fs = this->_ofs;
 	bool write_to_file = ap.given("-output-file");
+	_discardOutput();
 
 	if ( write_to_file ) {
 
+		/**
+		 * Write to a temporary file;
+		 * replace the output file only once complete.
+		 */
 		const std::string & fn = ap["-output-file"];
-		fs.open(fn, std::ios_base::out);
+		_ofs_tmp = fn + ".tmp";
+		fs.open(_ofs_tmp, std::ios_base::out);
 
 		/**
 		 * On fail, just append to std::cout
@@ -358,14 +640,18 @@ Interface::run() {
 				+ "; will append to standard output instead."
 				<< std::endl;
 			write_to_file = false;
+		} else {
+			monitor.discardOnAbort( _ofs_tmp );
 		}
 	}
 
 	/**
 	 * Set the output stream to the file stream
-	 * or std::cout, whichever is applicable.
+	 * or the buffer of std::cout, whichever is applicable.
 	 */
-	std::ostream & os = (write_to_file) ? fs : std::cout;
+	std::stringstream cout_buffer;
+	std::ostream & os = (write_to_file) ?
+		static_cast< std::ostream & >(fs) : cout_buffer;
 
 
 	/**************************************//*
@@ -397,6 +683,9 @@ Interface::run() {
 	} else if ( ap.given("-input-url") ) {
 		const std::string & url = ap["-input-url"];
 		os << "remote official wants file: " << url;
+	} else if ( ap.given("-input-files") ) {
+		const std::string & files = ap["-input-files"];
+		os << "local official-wants files: " << files;
 	} else {
 		os << "stdin";
 	}
@@ -412,13 +701,17 @@ Interface::run() {
 	 * The Math Trader object.
 	 */
 	MathTrader math_trader;
+	math_trader.setProgress( [&monitor]( const Progress & progress ) {
+		monitor.update( progress );
+	});
 
 	/*
 	 * Want List parser.
 	 * Will parse the want-list and configure
 	 * the Math Trader.
 	 */
-	WantParser want_parser;
+	std::unique_ptr< WantParser > want_parser_ptr( new WantParser() );
+	WantParser & want_parser = *want_parser_ptr;
 
 	/**
 	 * Input File Operations
@@ -438,17 +731,30 @@ Interface::run() {
 			/**
 			 * Start the timer
 			 */
+			monitor.enter( "graph", false );
 			std::stringstream time_ss;
 			time_ss << std::left << std::setw(TABWIDTH)
 				<< "Reading the input graph:";
 			lemon::TimeReport t(time_ss.str());
+			MemoryReport::Phase memory_phase( memory_report, "graph" );
 
 			/**
 			 * Read the input LGF,
 			 * from either std::cin or file.
+			 * A gzip-compressed file is decompressed
+			 * while read.
 			 */
 			const std::string & fn = ap["-input-lgf-file"];
-			math_trader.graphReader(fn);
+			if ( Inflater::isGzipFile(fn) ) {
+				std::filebuf fb;
+				fb.open(fn, std::ios::in | std::ios::binary);
+				InflateStreambuf zb(&fb);
+				std::istream is(&zb);
+				is.exceptions(std::ios::badbit);
+				math_trader.graphReader(is);
+			} else {
+				math_trader.graphReader(fn);
+			}
 
 		} catch ( const std::exception & error ) {
 			std::cerr << "Error during reading"
@@ -463,20 +769,55 @@ Interface::run() {
 		/* A want-list file will be provided.
 		 * Invoke the WantParser to convert it
 		 * to a LGF file. */
+		std::unique_ptr< HttpCache > cache;
 		try {
-			time_ss << std::left << std::setw(TABWIDTH)
-				<< "Parsing want-lists: ";
-
 			/* Start the timer. */
+			monitor.enter( "parse" );
 			std::stringstream time_ss;
+			time_ss << std::left << std::setw(TABWIDTH)
+				<< "Parsing want-lists:";
 			lemon::TimeReport t(time_ss.str());
+			MemoryReport::Phase memory_phase( memory_report, "parse" );
+
+			/* Reuse the tokens of unchanged lines:
+			 * of the previous run when watching,
+			 * otherwise of the index file. */
+			const bool reused = _want_parser
+				&& want_parser.reuseIndex(*_want_parser);
+			if ( !reused && ap.given("-index-file") ) {
+				want_parser.loadIndex(ap["-index-file"]);
+			}
 
 			/* Check input source. */
 			if ( ap.given("-input-url") ) {
 
-				/* Remote file. */
+				/* Remote file;
+				 * conditional on any cached copy. */
 				const std::string & url = ap["-input-url"];
-				want_parser.parseUrl(url);
+				HttpClient client;
+				if ( ap.given("-cache-dir") ) {
+					cache.reset( new HttpCache(ap["-cache-dir"]) );
+					client.setCache( cache.get() );
+				}
+				want_parser.parseUrl(url, client);
+
+			} else if ( ap.given("-input-files") ) {
+
+				/* Local files; one namespace each. */
+				std::vector< std::string > files, namespaces;
+				std::stringstream list( ap["-input-files"] );
+				std::string entry;
+				while ( std::getline(list, entry, ',') ) {
+					const auto eq = entry.find('=');
+					if ( eq == std::string::npos ) {
+						namespaces.emplace_back();
+						files.push_back( entry );
+					} else {
+						namespaces.push_back( entry.substr(0, eq) );
+						files.push_back( entry.substr(eq + 1) );
+					}
+				}
+				want_parser.parseFiles(files, namespaces);
 
 			} else if ( ap.given("-input-file") ) {
 
@@ -488,6 +829,10 @@ Interface::run() {
 				want_parser.parseStream(std::cin);
 			}
 
+			if ( ap.given("-index-file") ) {
+				want_parser.saveIndex(ap["-index-file"]);
+			}
+
 		} catch ( const std::exception & error ) {
 			std::cerr << "Error during want-list parsing: "
 				<< error.what()
@@ -495,22 +840,52 @@ Interface::run() {
 			return -1;
 		}
 
+		/* Cache statistics, along with the timings. */
+		if ( cache ) {
+			auto const & stats = cache->stats();
+			std::cerr << std::left << std::setw(TABWIDTH)
+				<< "Want-list cache:"
+				<< stats.hits << " hit(s), "
+				<< stats.misses << " miss(es); "
+				<< stats.bytes_reused << " bytes reused, "
+				<< stats.bytes_downloaded << " bytes downloaded"
+				<< std::endl;
+		}
+
+		/* Line index statistics, along with the timings. */
+		if ( ap.given("-index-file") || ap.given("-watch") ) {
+			auto const stats = want_parser.getIndexStats();
+			std::cerr << std::left << std::setw(TABWIDTH)
+				<< "Want-list line index:"
+				<< stats.reused << " line(s) reused, "
+				<< stats.tokenized << " tokenized, "
+				<< stats.dropped << " dropped; "
+				<< stats.changed_items.size() << " want-list(s) changed"
+				<< std::endl;
+		}
 
 		/**
 		 * Print the Nodes & Arcs;
 		 * forward them to Math Trader.
 		 */
 		std::stringstream ss;
-		want_parser.print(ss);
+		{
+			monitor.enter( "print-lgf", false );
+			MemoryReport::Phase memory_phase( memory_report, "print-lgf" );
+			want_parser.print(ss);
+		}
+		memory_report.add( "LGF stringstream", ss.tellp() );
 
 		try {
 			/**
 			 * Start the timer
 			 */
+			monitor.enter( "graph", false );
 			std::stringstream time_ss;
 			time_ss << std::left << std::setw(TABWIDTH)
 				<< "Passing input graph:";
 			lemon::TimeReport t(time_ss.str());
+			MemoryReport::Phase memory_phase( memory_report, "graph" );
 
 			/**
 			 * Start the reading
@@ -604,6 +979,11 @@ Interface::run() {
 			math_trader.hideNonTrades();
 		}
 
+		/**
+		 * Flow network on huge pages
+		 */
+		math_trader.useHugePages( ap.given("-huge-pages") );
+
 		/**
 		 * Algorithm to be used
 		 * Make uppercase.
@@ -649,8 +1029,10 @@ Interface::run() {
 
 	/**
 	 * Run the math trading algorithm.
+	 * The solver reports its own phases.
 	 */
 	try {
+		monitor.enter( "solve", false );
 		if ( !ap.given("-benchmark") ) {
 
 			/**
@@ -660,6 +1042,7 @@ Interface::run() {
 			time_ss << std::left << std::setw(TABWIDTH)
 				<< "Execution:";
 			lemon::TimeReport t(time_ss.str());
+			MemoryReport::Phase memory_phase( memory_report, "solve" );
 
 			/**
 			 * Start the execution
@@ -729,6 +1112,7 @@ Interface::run() {
 	 */
 	if ( !ap.given("-show-dummy-items") ) {
 		try {
+			MemoryReport::Phase memory_phase( memory_report, "merge" );
 			math_trader.mergeDummyItems();
 		} catch ( const std::exception & error ) {
 			std::cerr << "Error during merging dummy items: "
@@ -737,6 +1121,27 @@ Interface::run() {
 		}
 	}
 
+	/**
+	 * Verify the results, if requested.
+	 * Nothing is written on failure.
+	 */
+	if ( ap.given("-verify") ) {
+		try {
+			std::stringstream time_ss;
+			time_ss << std::left << std::setw(TABWIDTH)
+				<< "Result verification:";
+			lemon::TimeReport t(time_ss.str());
+
+			math_trader.verify();
+
+		} catch ( const std::exception & error ) {
+			std::cerr << "Error during verifying the results: "
+				<< error.what()
+				<< std::endl;
+			return -1;
+		}
+	}
+
 
 	/**
 	 * Print the WantParser and the MathTrader results
@@ -747,10 +1152,12 @@ Interface::run() {
 		/**
 		 * Start the timer
 		 */
+		monitor.enter( "report" );
 		std::stringstream time_ss;
 		time_ss << std::left << std::setw(TABWIDTH)
 			<< "Result processing & report:";
 		lemon::TimeReport t(time_ss.str());
+		MemoryReport::Phase memory_phase( memory_report, "report" );
 
 		/**
 		 * Print want_parser information:
@@ -795,6 +1202,67 @@ Interface::run() {
 		math_trader.writeStrongComponents(os);
 	}
 
+	/**
+	 * Show the solver statistics, if requested.
+	 */
+	if ( ap.given("-show-solver-stats") ) {
+		math_trader.writeSolverStats(os);
+	}
+
+	/**
+	 * Show the memory report, if requested.
+	 */
+	if ( ap.given("-show-memory") ) {
+		want_parser.memoryUsage( memory_report );
+		math_trader.memoryUsage( memory_report );
+		memory_report.print(os);
+	}
+
+	/**
+	 * Report the changes against previous results,
+	 * if requested.
+	 */
+	if ( ap.given("-diff-against") ) {
+		try {
+			monitor.enter( "diff" );
+			std::stringstream time_ss;
+			time_ss << std::left << std::setw(TABWIDTH)
+				<< "Result diff:";
+			lemon::TimeReport t(time_ss.str());
+
+			const std::string & fn = ap["-diff-against"];
+			if ( !std::ifstream(fn) ) {
+				throw std::runtime_error("Could not open " + fn);
+			}
+
+			ResultParser result_parser;
+			result_parser.parse(fn);
+			result_parser.showErrors(std::cerr);
+
+			std::vector< std::string > items, users;
+			std::vector< uint32_t > loops;
+			math_trader.getLoops( items, users, loops );
+
+			ResultDiff result_diff;
+			result_diff.setPrevious( result_parser.getItems(),
+					result_parser.getUsers(),
+					result_parser.getLoops() );
+			result_diff.setCurrent( items, users, loops );
+			result_diff.run();
+
+			os << std::endl
+				<< "CHANGES AGAINST " << fn << std::endl
+				<< std::endl;
+			result_diff.print(os);
+
+		} catch ( const std::exception & error ) {
+			std::cerr << "Error during comparing the results: "
+				<< error.what()
+				<< std::endl;
+			return -1;
+		}
+	}
+
 	/**
 	 * End of STANDARD mathtrader++ operations.
 	 * The LAST thing to append to the standard output (file)
@@ -811,9 +1279,35 @@ Interface::run() {
 			<< std::endl;
 	}
 
-	/* Close file stream */
+	/**
+	 * Last checkpoint; the output is written from here on.
+	 */
+	monitor.enter( "write", false );
+
+	/* Close file stream;
+	 * replace the output file atomically,
+	 * also with respect to an abort of the monitor. */
 	if ( fs.is_open() ) {
 		fs.close();
+		const std::string & fn = ap["-output-file"];
+		if ( !monitor.commitOutput( fn ) ) {
+			std::cerr << "Error writing output file "
+				<< fn
+				<< std::endl;
+			std::remove( _ofs_tmp.c_str() );
+			return -1;
+		}
+	} else {
+		std::cout << cout_buffer.str() << std::flush;
+	}
+
+	/**
+	 * Keep the parser for the next run, when watching;
+	 * only now that the results are out,
+	 * so that a failed run reuses the index of the last good one.
+	 */
+	if ( _want_parser ) {
+		_want_parser.swap( want_parser_ptr );
 	}
 
 
@@ -852,6 +1346,29 @@ Interface::run() {
 	return 0;
 }
 
+Interface::TraceWriter::TraceWriter( const std::string & fn ) :
+	_fn( fn )
+{
+	if ( !_fn.empty() ) {
+		Trace::instance().start();
+	}
+}
+
+Interface::TraceWriter::~TraceWriter() {
+
+	if ( _fn.empty() ) {
+		return;
+	}
+	Trace::instance().stop();
+	try {
+		Trace::instance().write(_fn);
+	} catch ( const std::exception & error ) {
+		std::cerr << "Error during writing the trace: "
+			<< error.what()
+			<< std::endl;
+	}
+}
+
 void
 Interface::_toUpper( std::string & str ) {
 
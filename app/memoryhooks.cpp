@@ -0,0 +1,108 @@
+/* This file is part of MathTrader++, a C++ utility
+ * for finding, on a directed graph whose arcs have costs,
+ * a set of vertex-disjoint cycles that maximizes the number
+ * of covered vertices as a first priority
+ * and minimizes the total cost as a second priority.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Replaces the global operator new and operator delete
+ * to report the heap allocations to MemoryAccount;
+ * they are counted once MemoryAccount::enable() is called.
+ * Large blocks are backed by huge pages within a HugePages::Scope. */
+
+#include <iograph/memory.hpp>
+
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+static void * allocate( std::size_t size ) noexcept {
+
+	void * ptr = HugePages::wanted( size ) ?
+		HugePages::allocate( size ) : nullptr;
+	if ( !ptr ) {
+		ptr = std::malloc( size ? size : 1 );
+	}
+	if ( ptr ) {
+		MemoryAccount::allocated( malloc_usable_size(ptr) );
+	}
+	return ptr;
+}
+
+static void deallocate( void * ptr ) noexcept {
+
+	if ( ptr ) {
+		MemoryAccount::freed( malloc_usable_size(ptr) );
+		std::free( ptr );
+	}
+}
+
+static void * allocateOrThrow( std::size_t size ) {
+
+	for ( ;; ) {
+		void * ptr = allocate( size );
+		if ( ptr ) {
+			return ptr;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if ( !handler ) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void * operator new( std::size_t size ) {
+	return allocateOrThrow( size );
+}
+
+void * operator new[]( std::size_t size ) {
+	return allocateOrThrow( size );
+}
+
+void * operator new( std::size_t size, const std::nothrow_t & ) noexcept {
+	return allocate( size );
+}
+
+void * operator new[]( std::size_t size, const std::nothrow_t & ) noexcept {
+	return allocate( size );
+}
+
+void operator delete( void * ptr ) noexcept {
+	deallocate( ptr );
+}
+
+void operator delete[]( void * ptr ) noexcept {
+	deallocate( ptr );
+}
+
+void operator delete( void * ptr, std::size_t ) noexcept {
+	deallocate( ptr );
+}
+
+void operator delete[]( void * ptr, std::size_t ) noexcept {
+	deallocate( ptr );
+}
+
+void operator delete( void * ptr, const std::nothrow_t & ) noexcept {
+	deallocate( ptr );
+}
+
+void operator delete[]( void * ptr, const std::nothrow_t & ) noexcept {
+	deallocate( ptr );
+}
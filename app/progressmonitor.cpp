@@ -0,0 +1,252 @@
+/* This file is part of MathTrader++, a C++ utility
+ * for finding, on a directed graph whose arcs have costs,
+ * a set of vertex-disjoint cycles that maximizes the number
+ * of covered vertices as a first priority
+ * and minimizes the total cost as a second priority.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "progressmonitor.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+/* Aligned with the timers of the application. */
+#define TABWIDTH (32)
+
+
+/**************************************
+ * 	PUBLIC METHODS - CONSTRUCTORS
+ **************************************/
+
+ProgressMonitor::ProgressMonitor( std::ostream & os, bool heartbeat,
+		Clock::duration interval, Clock::duration grace ) :
+	_os( os ),
+	_heartbeat( heartbeat ),
+	_interval( interval ),
+	_grace( grace ),
+	_start( Clock::now() ),
+	_stopped( false ),
+	_phase_start( _start )
+{
+	_progress.phase = "setup";
+	_thread = std::thread( &ProgressMonitor::_loop, this );
+}
+
+ProgressMonitor::~ProgressMonitor() {
+	this->stop();
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - PHASES
+ **************************************/
+
+void
+ProgressMonitor::enter( const char * phase, bool interruptible ) {
+
+	Cancellation::check();
+
+	Progress progress;
+	progress.phase = phase;
+	progress.interruptible = interruptible;
+	this->update( progress );
+}
+
+void
+ProgressMonitor::update( const Progress & progress ) {
+
+	std::lock_guard< std::mutex > lock( _mutex );
+	if ( std::strcmp( progress.phase, _progress.phase ) != 0 ) {
+		const auto now = Clock::now();
+		_endPhase( now );
+		_phase_start = now;
+	}
+	_progress = progress;
+}
+
+void
+ProgressMonitor::discardOnAbort( const std::string & fn ) {
+
+	std::lock_guard< std::mutex > lock( _mutex );
+	_discard = fn;
+}
+
+bool
+ProgressMonitor::commitOutput( const std::string & fn ) {
+
+	std::lock_guard< std::mutex > lock( _mutex );
+	if ( std::rename( _discard.c_str(), fn.c_str() ) != 0 ) {
+		return false;
+	}
+	_discard.clear();
+	_written = fn;
+	return true;
+}
+
+void
+ProgressMonitor::stop() {
+
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		if ( _stopped ) {
+			return;
+		}
+		_stopped = true;
+		_endPhase( Clock::now() );
+	}
+	_cv.notify_all();
+	_thread.join();
+}
+
+std::string
+ProgressMonitor::phase() const {
+
+	std::lock_guard< std::mutex > lock( _mutex );
+	return _progress.phase;
+}
+
+void
+ProgressMonitor::report( std::ostream & os ) const {
+
+	std::lock_guard< std::mutex > lock( _mutex );
+	_report( os );
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS
+ **************************************/
+
+void
+ProgressMonitor::_loop() {
+
+	std::unique_lock< std::mutex > lock( _mutex );
+	Clock::time_point next_beat = _start + _interval;
+	Clock::time_point cancelled;
+	bool cancelling = false;
+
+	/* Poll: the cancellation may be requested by a signal handler,
+	 * which cannot notify the condition variable. */
+	while ( !_stopped ) {
+
+		_cv.wait_for( lock, std::chrono::milliseconds(100) );
+		if ( _stopped ) {
+			break;
+		}
+		const auto now = Clock::now();
+
+		if ( Cancellation::requested() ) {
+			if ( !cancelling ) {
+				cancelling = true;
+				cancelled = now;
+				_os << "Interrupted; cancelling " << _progress.phase
+					<< ( _progress.interruptible ?
+						"" : ", which cannot be interrupted" )
+					<< std::endl;
+			} else if ( now - cancelled >= _grace ) {
+				_abort( now );
+			}
+		}
+
+		if ( _heartbeat && ( now >= next_beat )) {
+			_beat( now );
+			next_beat = now + _interval;
+		}
+	}
+}
+
+void
+ProgressMonitor::_endPhase( Clock::time_point now ) {
+
+	const std::chrono::duration< double > elapsed = now - _phase_start;
+	_phases.push_back({ _progress.phase, elapsed.count() });
+	_phase_start = now;
+}
+
+void
+ProgressMonitor::_beat( Clock::time_point now ) {
+
+	const std::chrono::duration< double > total = now - _start,
+		phase = now - _phase_start;
+	const auto flags = _os.flags();
+	const auto precision = _os.precision();
+
+	_os << std::fixed << std::setprecision(1)
+		<< "[progress] " << total.count() << "s: "
+		<< _progress.phase << " " << phase.count() << "s";
+
+	/* Steps and ETA, if the phase reports its steps. */
+	if ( _progress.total > 0 ) {
+		const int64_t done = std::min( _progress.done, _progress.total );
+		_os << ", " << done << "/" << _progress.total
+			<< " (" << ( 100.0 * done / _progress.total ) << "%)";
+		if ( done > 0 ) {
+			_os << ", ETA "
+				<< phase.count() * ( _progress.total - done ) / done
+				<< "s";
+		}
+	}
+	if ( _progress.has_objective ) {
+		_os << ", objective " << _progress.objective;
+	}
+	_os << std::endl;
+	_os.flags( flags );
+	_os.precision( precision );
+}
+
+void
+ProgressMonitor::_report( std::ostream & os ) const {
+
+	const auto flags = os.flags();
+	const auto precision = os.precision();
+
+	os << "Time per phase:" << std::endl;
+	for ( auto const & phase : _phases ) {
+		os << "  " << std::left << std::setw(TABWIDTH - 2)
+			<< ( std::string(phase.name) + ":" )
+			<< std::fixed << std::setprecision(3)
+			<< phase.seconds << "s"
+			<< std::endl;
+	}
+	os.flags( flags );
+	os.precision( precision );
+}
+
+void
+ProgressMonitor::_abort( Clock::time_point now ) {
+
+	_endPhase( now );
+	_os << "Aborted during " << _progress.phase;
+	if ( _written.empty() ) {
+		_os << "; no results have been written.";
+	} else {
+		_os << "; the results have been written to " << _written << ".";
+	}
+	_os << std::endl;
+	_report( _os );
+
+	if ( !_discard.empty() ) {
+		std::remove( _discard.c_str() );
+	}
+	_os.flush();
+
+	/* Skip the destructors: the main thread is still running. */
+	std::_Exit( 130 );
+}
@@ -0,0 +1,159 @@
+/* This file is part of MathTrader++, a C++ utility
+ * for finding, on a directed graph whose arcs have costs,
+ * a set of vertex-disjoint cycles that maximizes the number
+ * of covered vertices as a first priority
+ * and minimizes the total cost as a second priority.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_APP_PROGRESSMONITOR_HPP_
+#define _MATHTRADER_APP_PROGRESSMONITOR_HPP_
+
+#include <iograph/progress.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Watches the phases of a run.
+ * Follows the phases entered by the application
+ * and the progress reported by the solver;
+ * a background thread:
+ * - prints a heartbeat line every interval, if requested,
+ *   with the elapsed time, the steps of the phase and an ETA
+ *   wherever the phase reports its steps;
+ * - once a Cancellation has been requested,
+ *   aborts the process if no checkpoint has been reached
+ *   within the grace period, e.g., during an algorithm
+ *   that cannot be interrupted; any file given to
+ *   discardOnAbort() and not yet committed is removed first.
+ */
+class ProgressMonitor {
+
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * @brief Constructor.
+	 * Starts the background thread.
+	 * @param os stream of the heartbeat and of the reports
+	 * @param heartbeat print a heartbeat line every interval
+	 * @param interval interval of the heartbeat
+	 * @param grace time from a cancellation request to the abort
+	 */
+	ProgressMonitor( std::ostream & os, bool heartbeat,
+			Clock::duration interval = std::chrono::seconds(1),
+			Clock::duration grace = std::chrono::seconds(2) );
+
+	/**
+	 * @brief Destructor.
+	 * Stops the background thread.
+	 */
+	~ProgressMonitor();
+
+	/**
+	 * @brief Enter a phase; checkpoint.
+	 * Throws Cancelled if a Cancellation has been requested.
+	 * @param phase name of the phase; a string literal
+	 * @param interruptible whether the phase checks for cancellation
+	 */
+	void enter( const char * phase, bool interruptible = true );
+
+	/**
+	 * @brief Progress of the current phase, or a new phase.
+	 * May be given as the ProgressCallback of the solver.
+	 */
+	void update( const Progress & progress );
+
+	/**
+	 * @brief Remove the given file, if aborting.
+	 * @param fn the file; empty for none.
+	 */
+	void discardOnAbort( const std::string & fn );
+
+	/**
+	 * @brief Rename the file given to discardOnAbort() to its place.
+	 * Atomic with respect to an abort: the file is either
+	 * discarded, or renamed and no longer discarded,
+	 * in which case the abort reports the results as written.
+	 * @param fn the output file
+	 * @return false if the file could not be renamed.
+	 */
+	bool commitOutput( const std::string & fn );
+
+	/**
+	 * @brief Stop the background thread; end the current phase.
+	 */
+	void stop();
+
+	/**
+	 * @brief Name of the current phase, or of the last one if stopped.
+	 */
+	std::string phase() const ;
+
+	/**
+	 * @brief Where the time went.
+	 * Prints the time of each phase so far,
+	 * aligned with the timers of the application.
+	 */
+	void report( std::ostream & os ) const ;
+
+private:
+	struct Phase_t {
+		const char * name;
+		double seconds;
+	};
+
+	std::ostream & _os;
+	const bool _heartbeat;
+	const Clock::duration _interval;
+	const Clock::duration _grace;
+	const Clock::time_point _start;
+
+	/**
+	 * State shared with the background thread.
+	 */
+	mutable std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _stopped;
+	Progress _progress;			/**< of the current phase */
+	Clock::time_point _phase_start;
+	std::vector< Phase_t > _phases;		/**< finished phases */
+	std::string _discard;
+	std::string _written;			/**< committed output file */
+
+	std::thread _thread;
+
+	/**
+	 * Background thread.
+	 */
+	void _loop();
+
+	/**
+	 * The following require _mutex to be held.
+	 */
+	void _endPhase( Clock::time_point now );
+	void _beat( Clock::time_point now );
+	void _report( std::ostream & os ) const ;
+	void _abort( Clock::time_point now );
+};
+
+#endif /* _MATHTRADER_APP_PROGRESSMONITOR_HPP_ */
@@ -23,11 +23,62 @@
 #include <iograph/wantparser.hpp>
 #include <solver/routechecker.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <exception>
+#include <fstream>
 #include <iomanip>
 #include <lemon/arg_parser.h>
 #include <lemon/time_measure.h>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief Outcome of checking a result file.
+ */
+struct FileCheck {
+	std::string fn;			/**< result file */
+	bool checked = false;		/**< whether the loops have been checked */
+	RouteChecker::LoopCheck check;	/**< cost, visited items and violations */
+	std::vector< std::string >
+		errors;			/**< parse errors; not violations */
+};
+
+/**
+ * @brief Check a result file.
+ * Parses the result file and checks its loops
+ * against the shared, already indexed, input graph.
+ * Parse errors are recorded apart from the violations;
+ * the loops are checked regardless, as far as they have been parsed.
+ * @param route_checker The RouteChecker holding the input graph.
+ * @param file The result file; its outcome is filled in.
+ */
+static void checkFile( const RouteChecker & route_checker, FileCheck & file ) {
+
+	try {
+		if ( !std::ifstream( file.fn ) ) {
+			throw std::runtime_error("Could not open " + file.fn);
+		}
+		ResultParser result_parser;
+		result_parser.parse( file.fn );
+
+		auto const & errors = result_parser.getErrors();
+		for ( auto const & error : errors.records() ) {
+			file.errors.push_back( errors.format(error) );
+		}
+
+		file.check = route_checker.check( result_parser.getItems(),
+				result_parser.getLoops() );
+		file.checked = true;
+
+	} catch ( const std::exception & error ) {
+		file.errors.push_back( std::string("ResultParser error: ")
+				+ error.what() );
+	}
+}
 
 
 int main(int argc, char **argv) {
@@ -50,7 +101,8 @@ int main(int argc, char **argv) {
 	ap.stringOption("f", "input official wants file", "", true);
 	ap.synonym("-official-wants", "f");
 
-	ap.stringOption("r", "input official results file", "", true);
+	ap.stringOption("r", "input official results file(s), separated by commas;"
+			" further result files may follow the options", "", true);
 	ap.synonym("-official-results", "r");
 
 	ap.stringOption("o", "output official results file (default: stdout)");
@@ -97,6 +149,13 @@ int main(int argc, char **argv) {
 	ap.stringOption("-export-input-dot-file",
 			"export the input graph to .dot formatted file");
 
+	/**
+	 * Concurrent checks of multiple result files.
+	 */
+	ap.intOption("-threads",
+			"number of result files checked concurrently"
+			" (default: number of hardware threads)", 0);
+
 
 	/********************************************//*
 	 * 	Argument Parsing
@@ -124,12 +183,28 @@ int main(int argc, char **argv) {
 	RouteChecker route_checker;
 
 	/*
-	 * Want lists and results parsers.
-	 * Will parse the the want-list
-	 * and the result files.
+	 * Want lists parser.
+	 * Will parse the the want-list file.
 	 */
 	WantParser   want_parser;
-	ResultParser result_parser;
+
+	/**
+	 * Result files: comma-separated with -r
+	 * and any further arguments.
+	 */
+	std::vector< FileCheck > files;
+	{
+		std::stringstream ss( ap["r"] );
+		std::string fn;
+		while ( std::getline( ss, fn, ',' )) {
+			if ( !fn.empty() ) {
+				files.push_back( FileCheck{ fn, {} } );
+			}
+		}
+		for ( auto const & fn : ap.files() ) {
+			files.push_back( FileCheck{ fn, {} } );
+		}
+	}
 
 	/**
 	 * Input File Operations
@@ -150,34 +225,17 @@ int main(int argc, char **argv) {
 		return -1;
 	}
 
-	/**
-	 * Input File Operations
-	 * Read file from results.
-	 */
-	try {
-		lemon::TimeReport t("Result reading:       ");
-		const std::string & fn = ap["r"];
-
-		/**
-		 * Run the parser
-		 */
-		result_parser.parse(fn);
-
-	} catch ( const std::exception & error ) {
-		std::cerr << "ResultParser error: " << error.what()
-			<< std::endl;
-		return -1;
-	}
-
 	/**
 	 * Print the Nodes & Arcs;
 	 * forward them to RouteChecker.
+	 * Index them once for all result files.
 	 */
 	try {
 		lemon::TimeReport t("Passing input graph:  ");
 		std::stringstream ss;
 		want_parser.print(ss);
 		route_checker.graphReader(ss);
+		route_checker.buildIndex();
 
 	} catch ( const std::exception & error ) {
 		std::cerr << "Error during reading "
@@ -196,34 +254,6 @@ int main(int argc, char **argv) {
 		return -1;
 	}
 
-	/**
-	 * Print the trade loops;
-	 * forward them to RouteChecker.
-	 */
-	try {
-		lemon::TimeReport t("Passing trade loops:  ");
-		std::stringstream ss;
-		result_parser.print(ss);
-		route_checker.loopReader(ss);
-
-	} catch ( const std::exception & error ) {
-
-		std::cerr << "Error during reading "
-			" the trade loops: "
-			<< error.what()
-			<< std::endl;
-
-		const std::string fn = "error_loops.txt";
-		result_parser.print(fn);
-
-		std::cerr << "The extracted trade loops"
-			" have been written to "
-			<< fn
-			<< std::endl;
-
-		return -1;
-	}
-
 
 	/**************************************//*
 	 * PARAMETER CONFIGURATION
@@ -281,19 +311,43 @@ int main(int argc, char **argv) {
 	 ****************************************/
 
 	/**
-	 * Run the RouteChecker.
+	 * Check the result files concurrently;
+	 * each thread takes the next unchecked file.
+	 * The input graph is only read from now on.
 	 */
-	try {
+	{
 		lemon::TimeReport t("RouteChecker execution:  ");
-		route_checker.run();
 
-	} catch ( const std::exception & error ) {
-		std::cerr << "Error during execution: "
-			<< error.what()
-			<< std::endl;
-		return -1;
+		const int threads_given = ap["-threads"];
+		unsigned num_threads = ( threads_given > 0 )
+			? static_cast< unsigned >( threads_given )
+			: std::thread::hardware_concurrency();
+		num_threads = std::max( 1u, std::min< unsigned >( num_threads,
+					files.size() ));
+
+		std::atomic< size_t > next(0);
+		auto const worker = [&]() {
+			for ( size_t i = next ++ ; i < files.size(); i = next ++ ) {
+				checkFile( route_checker, files[i] );
+			}
+		};
+
+		std::vector< std::thread > threads;
+		threads.reserve( num_threads - 1 );
+		for ( unsigned i = 1; i < num_threads; ++ i ) {
+			threads.emplace_back( worker );
+		}
+		worker();
+		for ( auto & thread : threads ) {
+			thread.join();
+		}
 	}
 
+	const bool failed = std::any_of( files.begin(), files.end(),
+			[]( const FileCheck & file ) {
+				return !file.checked || !file.check.violations.empty();
+			});
+
 
 	/**************************************//*
 	 * OUTPUT OPERATIONS - MATH TRADES
@@ -332,7 +386,8 @@ int main(int argc, char **argv) {
 	std::ostream & os = (write_to_file) ? fs : std::cout;
 
 	/**
-	 * Print the WantParser and the MathTrader results
+	 * Print the WantParser errors, a summary line per result file
+	 * and then the results, parse errors and violations of each file,
 	 * to the same output stream, i.e., either std::cout
 	 * or the output file.
 	 */
@@ -340,7 +395,48 @@ int main(int argc, char **argv) {
 		lemon::TimeReport t("Result report:        ");
 
 		want_parser.printErrors(os);
-		route_checker.writeResults(os);
+
+		size_t width = 4;
+		for ( auto const & file : files ) {
+			width = std::max( width, file.fn.length() );
+		}
+
+		/* ERROR: the file could not be checked at all. */
+		os << std::left << std::setw(width) << "FILE"
+			<< std::right
+			<< std::setw(8) << "STATUS"
+			<< std::setw(14) << "COST"
+			<< std::setw(10) << "VISITED"
+			<< std::setw(12) << "VIOLATIONS"
+			<< std::setw(8) << "ERRORS"
+			<< std::endl;
+		for ( auto const & file : files ) {
+			auto const & check = file.check;
+			os << std::left << std::setw(width) << file.fn
+				<< std::right
+				<< std::setw(8) << ( !file.checked ? "ERROR" :
+						check.violations.empty() ? "OK" : "FAIL" )
+				<< std::setw(14) << check.total_cost
+				<< std::setw(10) << check.visited
+				<< std::setw(12) << check.violations.size()
+				<< std::setw(8) << file.errors.size()
+				<< std::endl;
+		}
+
+		/* As a single result file has always been reported. */
+		for ( auto const & file : files ) {
+			os << std::endl << "RESULTS: " << file.fn << std::endl;
+			if ( file.checked ) {
+				os << "Total cost = " << file.check.total_cost << std::endl;
+				os << "Visited non-dummy items = " << file.check.visited << std::endl;
+			}
+			for ( auto const & error : file.errors ) {
+				os << error << std::endl;
+			}
+			for ( auto const & violation : file.check.violations ) {
+				os << "**** " << violation << std::endl;
+			}
+		}
 
 	} catch ( const std::exception & error ) {
 		std::cerr << "Error during printing the results: " << error.what()
@@ -357,7 +453,6 @@ int main(int argc, char **argv) {
 	}
 
 
-
 	/**************************************//*
 	 * OUTPUT OPERATIONS - UTILITIES
 	 ****************************************/
@@ -380,5 +475,5 @@ int main(int argc, char **argv) {
 		route_checker.exportInputToDot(fn);
 	}
 
-	return 0;
+	return failed ? -1 : 0;
 }
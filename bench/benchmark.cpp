@@ -0,0 +1,786 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/httpclient.hpp>
+#include <iograph/memory.hpp>
+#include <iograph/resultparser.hpp>
+#include <iograph/wantparser.hpp>
+#include <solver/mathtrader.hpp>
+#include <solver/routechecker.hpp>
+#include <httpfixtureserver.hpp>
+
+#include "perfcounters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <lemon/arg_parser.h>
+#include <lemon/time_measure.h>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+/* Tabular width for benchmark output */
+#define TABWIDTH (36)
+
+
+/**********************************************//*
+ * 		BENCHMARK RECORDS
+ ************************************************/
+
+/**
+ * @brief Single run of a phase.
+ * Real time plus any phase-specific counters.
+ */
+struct Sample {
+	double seconds;		/**< real time */
+	std::map< std::string, double > counters;	/**< extra counters */
+};
+
+/**
+ * @brief Measurements of a phase.
+ * Median real time of a pipeline phase on a fixture
+ * over all repetitions, plus the counters of the median run.
+ */
+struct Record {
+	std::string fixture;	/**< fixture name, without extension */
+	std::string phase;	/**< pipeline phase */
+	std::vector< Sample > samples;	/**< one per repetition */
+	double seconds;		/**< median real time; see summarize() */
+	double deviation;	/**< median absolute deviation of the times */
+	std::map< std::string, double > counters;	/**< of the median run */
+};
+
+/**
+ * @brief Baseline.
+ * Maps (fixture, phase) to the reference time in seconds.
+ */
+typedef std::map< std::pair< std::string, std::string >, double > Baseline;
+
+/**
+ * @brief Fixture name.
+ * Strips the directory and any extensions.
+ */
+static std::string fixtureName( const std::string & fn ) {
+
+	const size_t slash = fn.find_last_of("/\\");
+	std::string name = ( slash == std::string::npos ) ?
+		fn : fn.substr(slash + 1);
+	return name.substr(0, name.find('.'));
+}
+
+/**
+ * @brief Add a run of a phase.
+ * Adds a new record on the first measurement.
+ * @returns the sample of the run
+ */
+static Sample & addSample( std::vector< Record > & records,
+		const std::string & fixture,
+		const std::string & phase,
+		double seconds ) {
+
+	for ( auto & record : records ) {
+		if (( record.fixture == fixture ) && ( record.phase == phase )) {
+			record.samples.push_back( Sample{ seconds, {} } );
+			return record.samples.back();
+		}
+	}
+	records.push_back( Record{ fixture, phase,
+			{ Sample{ seconds, {} } }, 0, 0, {} } );
+	return records.back().samples.back();
+}
+
+/**
+ * @brief Median of some values.
+ * The mean of the middle two, for an even count.
+ */
+static double median( std::vector< double > values ) {
+
+	if ( values.empty() ) {
+		return 0;
+	}
+	std::sort( values.begin(), values.end() );
+	const size_t mid = values.size() / 2;
+	return ( values.size() % 2 ) ?
+		values[mid] : ( values[ mid - 1 ] + values[mid] ) / 2;
+}
+
+/**
+ * @brief Summarize the runs of each phase.
+ * Sets the median time, its median absolute deviation,
+ * and the counters of the run closest to the median.
+ */
+static void summarize( std::vector< Record > & records ) {
+
+	for ( auto & record : records ) {
+		std::vector< double > times, deviations;
+		for ( auto const & sample : record.samples ) {
+			times.push_back( sample.seconds );
+		}
+		record.seconds = median( times );
+		for ( double t : times ) {
+			deviations.push_back( std::fabs( t - record.seconds ));
+		}
+		record.deviation = median( deviations );
+
+		auto const closest = std::min_element( record.samples.begin(),
+				record.samples.end(),
+				[&]( const Sample & a, const Sample & b ) {
+			return std::fabs( a.seconds - record.seconds )
+				< std::fabs( b.seconds - record.seconds );
+		});
+		record.counters = closest->counters;
+	}
+}
+
+/**
+ * @brief Phase timer.
+ * Measures the real time of a phase,
+ * its heap allocations and, if given, the hardware counters.
+ */
+class PhaseTimer {
+
+public:
+	/**
+	 * @param perf hardware counters; may be NULL
+	 */
+	explicit PhaseTimer( PerfCounters * perf ) :
+		_perf( perf )
+	{
+	}
+
+	/**
+	 * @brief Start measuring a phase.
+	 */
+	void restart() {
+		_allocations = MemoryAccount::allocations();
+		_timer.restart();
+		if ( _perf ) {
+			_perf->start();
+		}
+	}
+
+	/**
+	 * @brief Stop measuring and add the run to the record of the phase.
+	 * @returns the sample of the run
+	 */
+	Sample & update( std::vector< Record > & records,
+			const std::string & fixture,
+			const std::string & phase ) {
+
+		const double seconds = _timer.realTime();
+		if ( _perf ) {
+			_perf->stop();
+		}
+		const uint64_t allocations =
+			MemoryAccount::allocations() - _allocations;
+
+		Sample & sample = addSample( records, fixture, phase, seconds );
+		sample.counters["allocations"] = allocations;
+		if ( _perf ) {
+			for ( size_t i = 0; i < _perf->size(); ++ i ) {
+				sample.counters[ _perf->name(i) ] = _perf->value(i);
+			}
+		}
+		return sample;
+	}
+
+private:
+	lemon::Timer _timer;
+	PerfCounters * _perf;
+	uint64_t _allocations = 0;	/**< at restart() */
+};
+
+/**
+ * @brief Copy the solver statistics to the counters of a run.
+ */
+static void addSolverStats( Sample & sample, const SolverStats & stats ) {
+
+	sample.counters["nodes"] = stats.nodes;
+	sample.counters["arcs"] = stats.arcs;
+	sample.counters["total_cost"] = stats.total_cost;
+	sample.counters["peak_rss_kb"] = stats.peak_rss_kb;
+	for ( auto const & counter : stats.counters ) {
+		sample.counters[ counter.first ] = counter.second;
+	}
+}
+
+/**
+ * @brief Run the pipeline on a fixture.
+ * Runs all phases of mathtrader++ once
+ * and adds a run to each phase.
+ * If huge_pages is set, the solve phase is repeated
+ * with the flow network on huge pages, as solve-hp.
+ */
+static void runFixture( const std::string & fn,
+		const std::string & algorithm,
+		bool huge_pages,
+		PerfCounters * perf,
+		std::vector< Record > & records ) {
+
+	const std::string name = fixtureName(fn);
+
+	PhaseTimer t( perf );
+	auto update = [&]( const std::string & phase ) -> Sample & {
+		return t.update( records, name, phase );
+	};
+
+	WantParser want_parser;
+	MathTrader math_trader;
+
+	t.restart();
+	want_parser.parseFile(fn);
+	update( "parse" );
+
+	/* Same input over the loopback HTTP server;
+	 * the server is set up outside the measurement. */
+	{
+		HttpFixtureServer server;
+		server.serveFile( "/" + name + ".txt", fn );
+
+		WantParser url_parser;
+		t.restart();
+		url_parser.parseUrl( server.url("/" + name + ".txt") );
+		update( "url" );
+	}
+
+	/* Unchanged input against the line index of the previous parse;
+	 * the index is built outside the measurement. */
+	{
+		const std::string index = name + ".idx";
+		std::remove( index.c_str() );
+		WantParser cold_parser;
+		cold_parser.loadIndex( index );
+		cold_parser.parseFile( fn );
+		cold_parser.saveIndex( index );
+
+		WantParser warm_parser;
+		t.restart();
+		warm_parser.loadIndex( index );
+		warm_parser.parseFile( fn );
+		update( "reparse" );
+		std::remove( index.c_str() );
+	}
+
+	t.restart();
+	{
+		std::stringstream ss;
+		want_parser.print(ss);
+		math_trader.graphReader(ss);
+	}
+	update( "graph" ).counters["graph_bytes"] = math_trader.inputGraphBytes();
+
+	/* Traversal of the input graph:
+	 * strongly connected components, over the out-arcs of each item. */
+	t.restart();
+	{
+		std::stringstream ss;
+		math_trader.writeStrongComponents(ss);
+	}
+	update( "scc" );
+
+	/* The input graph in compressed adjacency form, against plain
+	 * arrays as the static graph keeps them: bytes of either form,
+	 * and a pass over the targets and ranks of all wants in either.
+	 * The plain arrays are copied from the input graph
+	 * outside the measurement. */
+	t.restart();
+	const CompressedAdjacency adjacency = math_trader.compressAdjacency();
+	{
+		Sample & sample = update( "compress" );
+		sample.counters["packed_bytes"] = adjacency.bytes();
+		sample.counters["simd"] = CompressedAdjacency::simd();
+	}
+	{
+		std::vector< uint32_t > first_out, targets;
+		std::vector< int > ranks;
+		math_trader.inputAdjacency( first_out, targets, ranks );
+		const uint32_t nodes = first_out.size() - 1;
+
+		uint64_t plain_sum = 0, packed_sum = 0;
+		t.restart();
+		for ( uint32_t v = 0; v < nodes; ++ v ) {
+			for ( uint32_t a = first_out[v]; a < first_out[ v + 1 ]; ++ a ) {
+				plain_sum += targets[a] + ranks[a];
+			}
+		}
+		update( "walk-plain" ).counters["plain_bytes"] =
+			( first_out.size() + targets.size() + ranks.size() )
+			* sizeof(uint32_t);
+
+		CompressedAdjacency::Wants wants;
+		t.restart();
+		for ( uint32_t v = 0; v < nodes; ++ v ) {
+			for ( CompressedAdjacency::OutArcIt a( adjacency, v, wants );
+					a.valid(); ++ a ) {
+				packed_sum += a.target() + a.rank();
+			}
+		}
+		update( "walk-packed" );
+
+		/* Every want of the compressed form against the input graph,
+		 * outside the measurement. */
+		bool match = ( plain_sum == packed_sum )
+			&& ( adjacency.numNodes() == nodes )
+			&& ( adjacency.numArcs() == targets.size() );
+		for ( uint32_t v = 0; match && ( v < nodes ); ++ v ) {
+			for ( CompressedAdjacency::OutArcIt a( adjacency, v, wants );
+					match && a.valid(); ++ a ) {
+				match = ( a.arc() < first_out[ v + 1 ] )
+					&& ( a.target() == targets[ a.arc() ] )
+					&& ( a.rank() == ranks[ a.arc() ] );
+			}
+			match = match && ( adjacency.firstArc(v) == first_out[v] )
+				&& ( adjacency.outDegree(v) == first_out[ v + 1 ] - first_out[v] );
+		}
+		if ( !match ) {
+			throw std::logic_error("Compressed adjacency does not match "
+					"the input graph");
+		}
+	}
+
+	/* Configure as mathtrader++ would. */
+	std::string priorities = want_parser.getPriorityScheme();
+	if ( priorities.length() > 0 ) {
+		std::transform( priorities.begin(), priorities.end(),
+				priorities.begin(), ::toupper );
+		math_trader.setPriorities( priorities );
+	}
+	math_trader.setAlgorithm( algorithm );
+
+	t.restart();
+	math_trader.run();
+	addSolverStats( update( "solve" ), math_trader.getSolverStats() );
+
+	/* The same solve, with the flow network on huge pages;
+	 * the graph is read outside the measurement. */
+	if ( huge_pages ) {
+		MathTrader huge_trader;
+		{
+			std::stringstream ss;
+			want_parser.print(ss);
+			huge_trader.graphReader(ss);
+		}
+		if ( priorities.length() > 0 ) {
+			huge_trader.setPriorities( priorities );
+		}
+		huge_trader.setAlgorithm( algorithm );
+		huge_trader.useHugePages();
+
+		t.restart();
+		huge_trader.run();
+		addSolverStats( update( "solve-hp" ), huge_trader.getSolverStats() );
+	}
+
+	/* Parse the results, dummy items included,
+	 * and check them against the input graph;
+	 * the results are written outside the measurement. */
+	{
+		std::stringstream results, graph;
+		math_trader.writeResults(results);
+		want_parser.print(graph);
+
+		RouteChecker route_checker;
+		route_checker.graphReader(graph);
+		if ( priorities.length() > 0 ) {
+			route_checker.setPriorities( priorities );
+		}
+		t.restart();
+		ResultParser result_parser;
+		result_parser.parse(results);
+		route_checker.loopReader( result_parser.getItems(),
+				result_parser.getLoops() );
+		route_checker.run();
+		update( "check" );
+	}
+
+	t.restart();
+	math_trader.mergeDummyItems();
+	update( "merge" );
+
+	t.restart();
+	math_trader.verify();
+	update( "verify" );
+
+	t.restart();
+	{
+		std::stringstream ss;
+		math_trader.writeResults(ss);
+	}
+	update( "report" );
+}
+
+/**
+ * @brief Retrieve all fixtures over HTTP.
+ * Serves the fixtures over a loopback server that trickles
+ * the responses, as a slow link would, then parses them:
+ * one after the other over a single persistent connection ("fetch-seq"),
+ * and all at once over concurrent connections ("fetch-conc").
+ * Recorded under the "all-fixtures" name.
+ */
+static void runFetch( const std::vector< std::string > & fns,
+		PerfCounters * perf,
+		std::vector< Record > & records ) {
+
+	HttpFixtureServer server;
+	HttpFixtureServer::Response response;
+	response.piece = (1 << 12);
+	response.delay = std::chrono::milliseconds(1);
+
+	std::vector< std::string > urls;
+	for ( auto const & fn : fns ) {
+		const std::string path = "/" + fixtureName(fn) + ".txt";
+		server.serveFile( path, fn, response );
+		urls.push_back( server.url(path) );
+	}
+
+	PhaseTimer t( perf );
+	{
+		HttpClient client;
+		std::vector< WantParser > want_parsers( urls.size() );
+		t.restart();
+		for ( size_t i = 0; i < urls.size(); ++ i ) {
+			want_parsers[i].parseUrl( urls[i], client );
+		}
+		Sample & sample = t.update( records, "all-fixtures", "fetch-seq" );
+		sample.counters["connections"] = client.connections();
+	}
+	{
+		std::vector< WantParser > want_parsers( urls.size() );
+		std::vector< HttpClient::Sink > sinks;
+		for ( auto & want_parser : want_parsers ) {
+			sinks.push_back( [&want_parser]( const char * data, size_t length ) {
+				want_parser.parseChunk( data, length );
+			});
+		}
+		t.restart();
+		HttpClient::getAll( urls, sinks );
+		for ( auto & want_parser : want_parsers ) {
+			want_parser.parseEnd();
+		}
+		Sample & sample = t.update( records, "all-fixtures", "fetch-conc" );
+		sample.counters["connections"] = urls.size();
+	}
+}
+
+/**
+ * @brief Read the baseline.
+ * Each non-comment line holds: fixture phase seconds
+ */
+static Baseline readBaseline( const std::string & fn ) {
+
+	Baseline baseline;
+	std::ifstream ifs(fn);
+	if ( !ifs ) {
+		throw std::runtime_error("Failed to open "
+				+ fn);
+	}
+
+	std::string line;
+	while ( std::getline(ifs, line) ) {
+		if ( line.empty() || ( line.front() == '#' ) ) {
+			continue;
+		}
+		std::stringstream ss(line);
+		std::string fixture, phase;
+		double seconds;
+		if ( !(ss >> fixture >> phase >> seconds) ) {
+			throw std::runtime_error("Malformed baseline line: "
+					+ line);
+		}
+		baseline[ std::make_pair(fixture, phase) ] = seconds;
+	}
+	return baseline;
+}
+
+/**
+ * @brief Write the baseline.
+ * Overwrites the given file with the current measurements.
+ */
+static void writeBaseline( const std::string & fn,
+		const std::vector< Record > & records ) {
+
+	std::ofstream ofs(fn);
+	if ( !ofs ) {
+		throw std::runtime_error("Failed to open "
+				+ fn);
+	}
+	ofs << "# MathTrader++ performance baseline." << std::endl
+		<< "# Generated by mathtrader-bench -update-baseline;" << std::endl
+		<< "# median times over " << ( records.empty() ?
+				0 : records.front().samples.size() )
+		<< " runs." << std::endl
+		<< "# Re-record only in a commit of its own that says so." << std::endl
+		<< "# <fixture> <phase> <seconds>" << std::endl;
+	for ( auto const & record : records ) {
+		ofs << record.fixture << " "
+			<< record.phase << " "
+			<< record.seconds << std::endl;
+	}
+}
+
+/**
+ * @brief Write the records as JSON.
+ */
+static void writeJson( std::ostream & os,
+		const std::vector< Record > & records ) {
+
+	/* Counts, e.g. instructions, in full. */
+	os << std::setprecision(15);
+	os << "[" << std::endl;
+	for ( size_t i = 0; i < records.size(); ++ i ) {
+		auto const & record = records[i];
+		os << "  {\"fixture\": \"" << record.fixture << "\""
+			<< ", \"phase\": \"" << record.phase << "\""
+			<< ", \"seconds\": " << record.seconds
+			<< ", \"deviation\": " << record.deviation
+			<< ", \"runs\": " << record.samples.size();
+		for ( auto const & counter : record.counters ) {
+			os << ", \"" << counter.first << "\": " << counter.second;
+		}
+		os << "}" << ((i + 1 < records.size()) ? "," : "") << std::endl;
+	}
+	os << "]" << std::endl;
+}
+
+
+/**********************************************//*
+ * 		MAIN FUNCTION
+ ************************************************/
+
+int main(int argc, char **argv) {
+
+	/**************************************//*
+	 * COMMAND LINE ARGUMENT PARSING
+	 ****************************************/
+
+	lemon::ArgParser ap(argc,argv);
+	ap.throwOnProblems();
+
+	ap.other("fixtures", "official wants files to benchmark");
+
+	ap.stringOption("-algorithm", "set the minimum cost"
+			" flow algorithm (default: NETWORK-SIMPLEX)",
+			"NETWORK-SIMPLEX");
+	ap.intOption("-repeat", "repetitions per fixture;"
+			" the median time is kept", 5);
+
+	ap.stringOption("-baseline", "baseline file to compare against");
+	ap.boolOption("-update-baseline", "overwrite the baseline file"
+			" with the current measurements");
+	ap.doubleOption("-tolerance", "allowed relative slowdown"
+			" of the median over the baseline", 0.25);
+	ap.doubleOption("-slack", "allowed absolute slowdown"
+			" over the baseline, in seconds", 0.01);
+	ap.boolOption("-require-baseline", "also fail on phases"
+			" without a baseline");
+
+	ap.stringOption("-json", "write the measurements as JSON to file");
+	ap.boolOption("-perf", "also count instructions, cycles, cache misses"
+			" and branch misses of each phase, if the kernel allows");
+	ap.boolOption("-huge-pages", "also solve with the flow network"
+			" on transparent huge pages, as phase solve-hp");
+
+	try {
+		ap.parse();
+	} catch ( const lemon::ArgParserException & error ) {
+		return 1;
+	}
+
+	if ( ap.files().empty() ) {
+		std::cerr << "No fixtures given" << std::endl;
+		return 1;
+	}
+
+
+	/**************************************//*
+	 * MEASUREMENTS
+	 ****************************************/
+
+	/* Heap allocations of each phase;
+	 * counted by the hooks of memoryhooks.cpp. */
+	MemoryAccount::enable();
+
+	/* Hardware counters, if requested and available. */
+	std::unique_ptr< PerfCounters > perf;
+	if ( ap.given("-perf") ) {
+		perf.reset( new PerfCounters() );
+		if ( !perf->available() ) {
+			std::cerr << "Hardware counters unavailable ("
+				<< perf->error()
+				<< "); timing only"
+				<< std::endl;
+			perf.reset();
+		}
+	}
+
+	std::vector< Record > records;
+	try {
+		std::string algorithm( ap["-algorithm"] );
+		std::transform( algorithm.begin(), algorithm.end(),
+				algorithm.begin(), ::toupper );
+
+		const int repeat = std::max( 1, static_cast< int >(ap["-repeat"]) );
+		for ( auto const & fn : ap.files() ) {
+			for ( int i = 0; i < repeat; ++ i ) {
+				runFixture( fn, algorithm, ap.given("-huge-pages"),
+						perf.get(), records );
+			}
+		}
+		for ( int i = 0; i < repeat; ++ i ) {
+			runFetch( ap.files(), perf.get(), records );
+		}
+		summarize( records );
+
+	} catch ( const std::exception & error ) {
+		std::cerr << "Error during benchmarking: "
+			<< error.what()
+			<< std::endl;
+		return -1;
+	}
+
+
+	/**************************************//*
+	 * REPORT & REGRESSION CHECK
+	 ****************************************/
+
+	const double tolerance = ap["-tolerance"],
+	      slack = ap["-slack"];
+
+	Baseline baseline;
+	const bool check = ap.given("-baseline") && !ap.given("-update-baseline");
+	try {
+		if ( check ) {
+			baseline = readBaseline( ap["-baseline"] );
+		}
+	} catch ( const std::exception & error ) {
+		std::cerr << "Error during reading the baseline: "
+			<< error.what()
+			<< std::endl;
+		return -1;
+	}
+
+	int regressions = 0, missing = 0;
+	if ( perf ) {
+		std::cout << "Hardware counters: whole process,"
+			" as the difference of the totals at the start and the end"
+			" of each phase; threads count once they have exited"
+			<< std::endl;
+	}
+	std::cout << std::left
+		<< std::setw(TABWIDTH) << "Fixture"
+		<< std::setw(12) << "Phase"
+		<< std::setw(14) << "Median (s)"
+		<< std::setw(14) << "MAD (s)"
+		<< std::setw(14) << "Allocations";
+	if ( perf ) {
+		for ( size_t i = 0; i < perf->size(); ++ i ) {
+			std::cout << std::setw(16) << perf->name(i);
+		}
+	}
+	std::cout << std::setw(14) << "Baseline (s)"
+		<< "Status"
+		<< std::endl;
+
+	for ( auto const & record : records ) {
+
+		std::cout << std::left
+			<< std::setw(TABWIDTH) << record.fixture
+			<< std::setw(12) << record.phase
+			<< std::setw(14) << record.seconds
+			<< std::setw(14) << record.deviation
+			<< std::setw(14)
+			<< static_cast< uint64_t >( record.counters.at("allocations") );
+		if ( perf ) {
+			for ( size_t i = 0; i < perf->size(); ++ i ) {
+				auto const counter = record.counters.find( perf->name(i) );
+				if ( counter == record.counters.end() ) {
+					std::cout << std::setw(16) << "-";
+				} else {
+					std::cout << std::setw(16)
+						<< static_cast< uint64_t >( counter->second );
+				}
+			}
+		}
+
+		/* Only the phases in the baseline are checked;
+		 * the others are counted, and fail with -require-baseline. */
+		auto const it = baseline.find( std::make_pair(record.fixture, record.phase) );
+		if ( it == baseline.end() ) {
+			std::cout << std::setw(14) << "-"
+				<< (check ? "NO BASELINE" : "");
+			missing += check;
+		} else {
+			const double limit = it->second * (1 + tolerance) + slack;
+			const bool regressed = ( record.seconds > limit );
+			std::cout << std::setw(14) << it->second
+				<< (regressed ? "REGRESSION" : "ok");
+			regressions += regressed;
+		}
+		std::cout << std::endl;
+	}
+
+	try {
+		if ( ap.given("-update-baseline") ) {
+			if ( !ap.given("-baseline") ) {
+				throw std::runtime_error("No baseline file given");
+			}
+			writeBaseline( ap["-baseline"], records );
+		}
+		if ( ap.given("-json") ) {
+			const std::string & fn = ap["-json"];
+			std::ofstream ofs(fn);
+			if ( !ofs ) {
+				throw std::runtime_error("Failed to open "
+						+ fn);
+			}
+			writeJson( ofs, records );
+		}
+	} catch ( const std::exception & error ) {
+		std::cerr << "Error during writing the results: "
+			<< error.what()
+			<< std::endl;
+		return -1;
+	}
+
+	if ( missing > 0 ) {
+		std::cerr << missing
+			<< " phase" << ((missing > 1) ? "s have" : " has")
+			<< " no baseline and" << ((missing > 1) ? " were" : " was")
+			<< " not checked; record "
+			<< ((missing > 1) ? "them" : "it")
+			<< " with -update-baseline"
+			<< std::endl;
+	}
+	if ( regressions > 0 ) {
+		std::cerr << regressions
+			<< " phase" << ((regressions > 1) ? "s" : "")
+			<< " regressed beyond the baseline tolerance"
+			<< std::endl;
+	}
+	if (( regressions > 0 )
+			|| (( missing > 0 ) && ap.given("-require-baseline") )) {
+		return 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,179 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "perfcounters.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+/**************************************
+ * 	PUBLIC METHODS
+ **************************************/
+
+#ifdef __linux__
+
+PerfCounters::PerfCounters() {
+
+	static const struct {
+		const char * name;
+		uint64_t config;
+	} EVENTS[] = {
+		{ "instructions", PERF_COUNT_HW_INSTRUCTIONS },
+		{ "cycles", PERF_COUNT_HW_CPU_CYCLES },
+		{ "cache-misses", PERF_COUNT_HW_CACHE_MISSES },
+		{ "branch-misses", PERF_COUNT_HW_BRANCH_MISSES },
+	};
+
+	for ( auto const & event : EVENTS ) {
+
+		struct perf_event_attr attr;
+		std::memset( &attr, 0, sizeof(attr) );
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = event.config;
+		attr.disabled = 0;
+		attr.inherit = 1;	/* threads created later, e.g. HTTP fetches */
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+			| PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		/* This process, on any CPU. */
+		const int fd = static_cast< int >( syscall( SYS_perf_event_open,
+					&attr, 0, -1, -1, 0 ));
+		if ( fd < 0 ) {
+			if ( error_.empty() ) {
+				error_ = std::string( event.name ) + ": "
+					+ std::strerror( errno );
+			}
+			continue;
+		}
+		counters_.push_back({ event.name, fd, 0, { 0, 0, 0 } });
+	}
+}
+
+PerfCounters::~PerfCounters() {
+	for ( auto const & counter : counters_ ) {
+		close( counter.fd );
+	}
+}
+
+void
+PerfCounters::start() {
+
+	/* Never reset: with inherit, the counts of threads that have
+	 * exited collect in the child count of the event,
+	 * which PERF_EVENT_IOC_RESET does not clear.
+	 * The counters keep running, and each phase takes the difference
+	 * of the totals read at start() and at stop() instead. */
+	for ( auto & counter : counters_ ) {
+		counter.value = 0;
+		readTotals_( counter, counter.start );
+	}
+}
+
+void
+PerfCounters::stop() {
+
+	for ( auto & counter : counters_ ) {
+		uint64_t totals[3];
+		if ( !readTotals_( counter, totals ) ) {
+			counter.value = 0;
+			continue;
+		}
+		const uint64_t value = totals[0] - counter.start[0],
+		      enabled = totals[1] - counter.start[1],
+		      running = totals[2] - counter.start[2];
+		if (( running > 0 ) && ( running < enabled )) {
+			counter.value = static_cast< uint64_t >( static_cast< double >( value )
+					* enabled / running );
+		} else {
+			counter.value = value;
+		}
+	}
+}
+
+bool
+PerfCounters::readTotals_( const Counter_t_ & counter, uint64_t totals[3] ) {
+
+	/* value, time enabled, time running */
+	if ( read( counter.fd, totals, 3 * sizeof(uint64_t) )
+			!= 3 * sizeof(uint64_t) ) {
+		totals[0] = totals[1] = totals[2] = 0;
+		return false;
+	}
+	return true;
+}
+
+#else /* __linux__ */
+
+PerfCounters::PerfCounters() :
+	error_( "perf_event_open requires Linux" )
+{
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+void
+PerfCounters::start() {
+}
+
+void
+PerfCounters::stop() {
+}
+
+bool
+PerfCounters::readTotals_( const Counter_t_ &, uint64_t totals[3] ) {
+	totals[0] = totals[1] = totals[2] = 0;
+	return false;
+}
+
+#endif /* __linux__ */
+
+bool
+PerfCounters::available() const {
+	return !counters_.empty();
+}
+
+const std::string &
+PerfCounters::error() const {
+	return error_;
+}
+
+size_t
+PerfCounters::size() const {
+	return counters_.size();
+}
+
+const std::string &
+PerfCounters::name( size_t i ) const {
+	return counters_.at(i).name;
+}
+
+uint64_t
+PerfCounters::value( size_t i ) const {
+	return counters_.at(i).value;
+}
@@ -0,0 +1,108 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_BENCH_PERFCOUNTERS_HPP_
+#define _MATHTRADER_BENCH_PERFCOUNTERS_HPP_
+
+/*! @file perfcounters.hpp
+ *  @brief Hardware performance counters around benchmark phases
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*! @brief Count hardware events of the process.
+ *
+ *  Reads the instructions, cycles, cache misses and branch misses
+ *  of the process, and of the threads it creates afterwards,
+ *  through Linux ``perf_event_open``.
+ *  The counters run from construction on; a measurement is
+ *  the difference of the totals read at start() and at stop().
+ *  A thread counts once it has exited, so threads that exit between
+ *  start() and stop() count towards that measurement only,
+ *  and threads that are still running are not counted yet.
+ *  Counts are scaled up, if the kernel had to multiplex the counters.
+ *
+ *  Counters that cannot be opened, e.g. within containers,
+ *  virtual machines without a virtual PMU,
+ *  or due to ``/proc/sys/kernel/perf_event_paranoid``,
+ *  are skipped; if none can be opened, available() is false
+ *  and start()/stop() do nothing.
+ *
+ *  Example:
+ *
+ *  	PerfCounters counters;
+ *  	counters.start();
+ *  	// ...
+ *  	counters.stop();
+ *  	for ( size_t i = 0; i < counters.size(); ++ i ) {
+ *  		std::cout << counters.name(i) << ": " << counters.value(i);
+ *  	}
+ */
+class PerfCounters {
+
+public:
+	/*! @brief Open the counters. */
+	PerfCounters();
+
+	/*! @brief Close the counters. */
+	~PerfCounters();
+
+	PerfCounters( const PerfCounters & ) = delete;
+	PerfCounters & operator=( const PerfCounters & ) = delete;
+
+	/*! @brief Whether any counter could be opened. */
+	bool available() const ;
+
+	/*! @brief Why no counter could be opened, if not available(). */
+	const std::string & error() const ;
+
+	/*! @brief Read the totals at the start of a measurement. */
+	void start();
+
+	/*! @brief Read the totals and keep the counts since start(). */
+	void stop();
+
+	/*! @brief Number of counters opened. */
+	size_t size() const ;
+
+	/*! @brief Name of a counter, e.g. "instructions". */
+	const std::string & name( size_t i ) const ;
+
+	/*! @brief Count of a counter between start() and stop(). */
+	uint64_t value( size_t i ) const ;
+
+private:
+	/*! @brief An open counter. */
+	struct Counter_t_ {
+		std::string name;
+		int fd;
+		uint64_t value;
+		uint64_t start[3];	/*!< totals at start() */
+	};
+
+	/*! @brief Read the value, time enabled and time running of a counter.
+	 *  @returns false if the counter could not be read
+	 */
+	static bool readTotals_( const Counter_t_ & counter, uint64_t totals[3] );
+
+	std::vector< Counter_t_ > counters_;
+	std::string error_;
+};
+
+#endif /* _MATHTRADER_BENCH_PERFCOUNTERS_HPP_ */
@@ -0,0 +1,81 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wantgenerator.hpp"
+
+#include <exception>
+#include <lemon/arg_parser.h>
+
+
+int main(int argc, char **argv) {
+
+	/**************************************//*
+	 * COMMAND LINE ARGUMENT PARSING
+	 ****************************************/
+
+	lemon::ArgParser ap(argc,argv);
+	ap.throwOnProblems();
+
+	ap.intOption("-items", "number of official items", 1000);
+	ap.intOption("-users", "number of users", 60);
+	ap.intOption("-avg-wants", "average want-list length", 25);
+	ap.intOption("-dummy-percent", "percentage of users grouping wants"
+			" behind a dummy item", 20);
+	ap.intOption("-missing-percent", "percentage of items"
+			" without a want-list", 3);
+	ap.intOption("-seed", "seed of the pseudo-random generator", 1);
+
+	ap.stringOption("-output-file", "output official wants file (default: stdout)");
+	ap.synonym("o", "-output-file");
+
+	try {
+		ap.parse();
+	} catch ( const lemon::ArgParserException & error ) {
+		return 1;
+	}
+
+
+	/**************************************//*
+	 * GENERATION
+	 ****************************************/
+
+	try {
+		WantGenerator generator;
+		generator.
+			items( static_cast< int >(ap["-items"]) ).
+			users( static_cast< int >(ap["-users"]) ).
+			avgWants( static_cast< int >(ap["-avg-wants"]) ).
+			dummyPercent( static_cast< int >(ap["-dummy-percent"]) ).
+			missingPercent( static_cast< int >(ap["-missing-percent"]) ).
+			seed( static_cast< int >(ap["-seed"]) );
+
+		if ( ap.given("-output-file") ) {
+			const std::string & fn = ap["-output-file"];
+			generator.write(fn);
+		} else {
+			generator.write(std::cout);
+		}
+
+	} catch ( const std::exception & error ) {
+		std::cerr << "Error during want-list generation: "
+			<< error.what()
+			<< std::endl;
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,256 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wantgenerator.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+
+/**************************************
+ * 	PUBLIC METHODS - PARAMETERS
+ **************************************/
+
+WantGenerator &
+WantGenerator::items( unsigned n ) {
+	items_ = n;
+	return *this;
+}
+
+WantGenerator &
+WantGenerator::users( unsigned n ) {
+	users_ = n;
+	return *this;
+}
+
+WantGenerator &
+WantGenerator::avgWants( unsigned n ) {
+	avg_wants_ = n;
+	return *this;
+}
+
+WantGenerator &
+WantGenerator::dummyPercent( unsigned percent ) {
+	dummy_percent_ = percent;
+	return *this;
+}
+
+WantGenerator &
+WantGenerator::missingPercent( unsigned percent ) {
+	missing_percent_ = percent;
+	return *this;
+}
+
+WantGenerator &
+WantGenerator::seed( uint64_t seed ) {
+	seed_ = seed;
+	return *this;
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - OUTPUT
+ **************************************/
+
+void
+WantGenerator::write( const std::string & fn ) const {
+
+	std::ofstream ofs(fn);
+	if ( !ofs ) {
+		throw std::runtime_error("Failed to open "
+				+ fn);
+	}
+	this->write(ofs);
+}
+
+void
+WantGenerator::write( std::ostream & os ) const {
+
+	/* Sanity checks. */
+	if (( users_ == 0 ) || ( items_ < users_ )) {
+		throw std::runtime_error("Expected at least one item per user; given "
+				+ std::to_string(items_) + " items and "
+				+ std::to_string(users_) + " users");
+	}
+	if (( dummy_percent_ > 100 ) || ( missing_percent_ > 100 )) {
+		throw std::runtime_error("Percentages must be in [0,100]");
+	}
+
+	Random_ random( seed_ );
+
+	/* Item names and owners.
+	 * Every user offers at least one item;
+	 * the rest are distributed with a skew,
+	 * so that a few users offer many items. */
+	std::vector< std::string > name( items_ );
+	std::vector< unsigned > owner( items_ );
+	for ( unsigned i = 0; i < items_; ++ i ) {
+		name[i] = itemName_( i + 1, random );
+		owner[i] = ( i < users_ ) ? i : random.skewed( users_ );
+	}
+
+	/* Item popularity: a random permutation.
+	 * popular[0] is the most wanted item. */
+	std::vector< unsigned > popular( items_ );
+	for ( unsigned i = 0; i < items_; ++ i ) {
+		popular[i] = i;
+	}
+	for ( unsigned i = items_ - 1; i > 0; -- i ) {
+		std::swap( popular[i], popular[random.below(i + 1)] );
+	}
+
+	auto username = []( unsigned u ) {
+		std::stringstream ss;
+		ss << "user" << std::setw(4) << std::setfill('0') << u + 1;
+		return ss.str();
+	};
+
+	/* Draws a want-list for the given user. */
+	auto draw_wants = [&]( unsigned user, unsigned length ) {
+		std::vector< unsigned > wants;
+		std::unordered_set< unsigned > seen;
+		for ( unsigned k = 0; k < 4 * length && wants.size() < length; ++ k ) {
+			const unsigned target = popular[ random.skewed(items_) ];
+			if (( owner[target] != user ) && seen.insert(target).second ) {
+				wants.push_back( target );
+			}
+		}
+		return wants;
+	};
+
+	/* Prints a want-list; occasionally separate by a semicolon. */
+	auto print_wants = [&]( const std::vector< unsigned > & wants ) {
+		for ( auto const target : wants ) {
+			if ( random.below(16) == 0 ) {
+				os << " ;";
+			}
+			os << " " << name[target];
+		}
+	};
+
+	/* Header & options. */
+	os << "# Generated by mathtrader-wantgen"
+		<< " (items=" << items_
+		<< " users=" << users_
+		<< " avg-wants=" << avg_wants_
+		<< " dummies=" << dummy_percent_ << "%"
+		<< " missing=" << missing_percent_ << "%"
+		<< " seed=" << seed_ << ")"
+		<< std::endl
+		<< "#! ALLOW-DUMMIES" << std::endl
+		<< "#! REQUIRE-COLONS" << std::endl
+		<< "#! REQUIRE-USERNAMES" << std::endl
+		<< "#! HIDE-NONTRADES" << std::endl
+		<< "#! LINEAR-PRIORITIES" << std::endl
+		<< "#! SMALL-STEP=1" << std::endl
+		<< "#! BIG-STEP=9" << std::endl
+		<< std::endl;
+
+	/* Official names. */
+	os << "!BEGIN-OFFICIAL-NAMES" << std::endl;
+	for ( unsigned i = 0; i < items_; ++ i ) {
+		os << name[i]
+			<< " ==> \"Generated Game " << i + 1 << "\""
+			<< " (from " << username(owner[i]) << ")"
+			<< std::endl;
+	}
+	os << "!END-OFFICIAL-NAMES" << std::endl;
+
+	/* Items per user. */
+	std::vector< std::vector< unsigned > > offered( users_ );
+	for ( unsigned i = 0; i < items_; ++ i ) {
+		offered[ owner[i] ].push_back(i);
+	}
+
+	/* Want-lists, grouped by user. */
+	for ( unsigned u = 0; u < users_; ++ u ) {
+
+		const std::string user = username(u);
+		os << std::endl
+			<< "#pragma user \"" << user << "\"" << std::endl;
+
+		/* A user may group popular wants behind a dummy item. */
+		const bool has_dummy = ( random.below(100) < dummy_percent_ );
+		if ( has_dummy ) {
+			os << "(" << user << ") %GROUP :";
+			print_wants( draw_wants(u, 2 * avg_wants_) );
+			os << std::endl;
+		}
+
+		for ( auto const i : offered[u] ) {
+
+			/* Missing want-list. */
+			if ( random.below(100) < missing_percent_ ) {
+				continue;
+			}
+
+			const unsigned length = random.below( 2 * avg_wants_ + 1 );
+			os << "(" << user << ") " << name[i] << " :";
+			if ( has_dummy && ( random.below(100) < 50 ) ) {
+				os << " %GROUP";
+			}
+			print_wants( draw_wants(u, length) );
+			os << std::endl;
+		}
+	}
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS - UTILS
+ **************************************/
+
+std::string
+WantGenerator::itemName_( unsigned id, Random_ & random ) {
+
+	std::stringstream ss;
+	ss << std::setw(4) << std::setfill('0') << id << "-";
+	const unsigned length = 3 + random.below(5);
+	for ( unsigned k = 0; k < length; ++ k ) {
+		ss << static_cast< char >( 'A' + random.below(26) );
+	}
+	return ss.str();
+}
+
+uint64_t
+WantGenerator::Random_::next() {
+
+	uint64_t z = ( state_ += 0x9e3779b97f4a7c15ULL );
+	z = ( z ^ (z >> 30) ) * 0xbf58476d1ce4e5b9ULL;
+	z = ( z ^ (z >> 27) ) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+uint64_t
+WantGenerator::Random_::below( uint64_t n ) {
+	return next() % n;
+}
+
+uint64_t
+WantGenerator::Random_::skewed( uint64_t n ) {
+
+	/* Product of two uniform variables in [0,1)
+	 * leans towards zero. */
+	const double x = static_cast< double >(next() >> 11) / (1ULL << 53),
+	      y = static_cast< double >(next() >> 11) / (1ULL << 53);
+	const uint64_t v = static_cast< uint64_t >( x * y * n );
+	return ( v < n ) ? v : n - 1;
+}
@@ -0,0 +1,141 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_BENCH_WANTGENERATOR_HPP_
+#define _MATHTRADER_BENCH_WANTGENERATOR_HPP_
+
+/*! @file wantgenerator.hpp
+ *  @brief Synthetic want-list generator
+ *
+ *  Generates reproducible official-wants files
+ *  to be used as test fixtures and benchmark inputs.
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*! @brief Generate synthetic official-wants files.
+ *
+ *  Produces an official-wants file in the same format
+ *  as the [Online Want List Generator (OLWLG)](http://bgg.activityclub.org/olwlg),
+ *  i.e., options, official names and want-lists with usernames and dummy items.
+ *
+ *  The generated trade mimics the shape of real BGG math trades:
+ *  users offer a variable number of items, item popularity is skewed
+ *  so that few items are wanted by many users,
+ *  some users group their wants behind dummy items
+ *  and some items are submitted without a want-list.
+ *
+ *  The output only depends on the parameters and the seed.
+ */
+class WantGenerator {
+
+public:
+	/*! @brief Default constructor.
+	 */
+	WantGenerator() = default;
+
+	~WantGenerator() = default;
+
+	/*! @name Parameters
+	 *
+	 *  All setters return ``*this`` to allow chaining.
+	 */
+	/*! @{ */ // start of group
+
+	/*! @brief Set the number of official (non-dummy) items.
+	 *  @param[in]	n	number of items; default: 1000
+	 */
+	WantGenerator & items( unsigned n );
+
+	/*! @brief Set the number of users.
+	 *  @param[in]	n	number of users; default: 60
+	 */
+	WantGenerator & users( unsigned n );
+
+	/*! @brief Set the average number of wanted items per want-list.
+	 *  @param[in]	n	average want-list length; default: 25
+	 */
+	WantGenerator & avgWants( unsigned n );
+
+	/*! @brief Set the percentage of items grouped behind dummy items.
+	 *  @param[in]	percent	in [0,100]; default: 20
+	 */
+	WantGenerator & dummyPercent( unsigned percent );
+
+	/*! @brief Set the percentage of items without a want-list.
+	 *  @param[in]	percent	in [0,100]; default: 3
+	 */
+	WantGenerator & missingPercent( unsigned percent );
+
+	/*! @brief Set the seed of the pseudo-random generator.
+	 *  @param[in]	seed	the seed; default: 1
+	 */
+	WantGenerator & seed( uint64_t seed );
+
+	/*! @} */ // end of group
+
+	/*! @brief Write the official-wants file.
+	 *
+	 *  @param	os	output stream to write the want-list file to
+	 *  @throws	std::runtime_error if the parameters are inconsistent
+	 */
+	void write( std::ostream & os ) const ;
+
+	/*! @brief Write the official-wants file to a file.
+	 *
+	 *  @param[in]	fn	output file to write the want-list file to
+	 *  @throws	std::runtime_error if file ``fn`` cannot be opened
+	 */
+	void write( const std::string & fn ) const ;
+
+private:
+	unsigned items_ = 1000;		/*!< official items */
+	unsigned users_ = 60;		/*!< users offering items */
+	unsigned avg_wants_ = 25;	/*!< average want-list length */
+	unsigned dummy_percent_ = 20;	/*!< items using dummies */
+	unsigned missing_percent_ = 3;	/*!< items without want-list */
+	uint64_t seed_ = 1;		/*!< pseudo-random generator seed */
+
+	/*! @brief Pseudo-random generator.
+	 *
+	 *  SplitMix64; the standard distributions are implementation-defined,
+	 *  which would make the output differ between standard libraries.
+	 */
+	class Random_ {
+	public:
+		explicit Random_( uint64_t seed ) : state_( seed ) {}
+
+		/*! @brief Next 64-bit value. */
+		uint64_t next();
+
+		/*! @brief Uniform value in ``[0,n)``. */
+		uint64_t below( uint64_t n );
+
+		/*! @brief Skewed value in ``[0,n)``; small values are more likely. */
+		uint64_t skewed( uint64_t n );
+
+	private:
+		uint64_t state_;
+	};
+
+	/*! @brief Generate an item identifier, e.g., ``0042-ABCDE``. */
+	static std::string itemName_( unsigned id, Random_ & random );
+};
+
+#endif /* _MATHTRADER_BENCH_WANTGENERATOR_HPP_ */
@@ -0,0 +1,181 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_ARENA_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_ARENA_HPP_
+
+/*! @file arena.hpp
+ *  @brief Monotonic arena for the temporaries of a phase
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+/*! @brief Monotonic arena.
+ *
+ *  Serves allocations from large blocks by bumping a pointer;
+ *  deallocation does nothing.
+ *  The temporaries of a phase are freed at once by release(),
+ *  or when the arena is destroyed.
+ *  reset() rewinds the arena but keeps its largest block,
+ *  so that a loop, e.g. over the lines of a file,
+ *  stops allocating from the heap once the block is large enough.
+ *
+ *  Containers use it through ArenaAllocator,
+ *  as the ``std::pmr`` containers of C++17 use
+ *  a ``monotonic_buffer_resource``:
+ *
+ *  	Arena arena;
+ *  	ArenaVector< int > ids( arena );
+ *  	ArenaString name( "item", arena );
+ *
+ *  Not thread-safe; use one arena per thread.
+ *  Copies of an arena start empty, since temporaries are not shared.
+ */
+class Arena {
+
+public:
+	/*! @brief Constructor.
+	 *
+	 *  @param[in]	block_size	bytes of the first block;
+	 *  		each further block doubles the last one
+	 */
+	explicit Arena( size_t block_size = 4096 );
+
+	Arena( const Arena & other );
+	Arena & operator=( const Arena & other );
+	~Arena();
+
+	/*! @brief Allocate from the current block, or a new one.
+	 *
+	 *  @param[in]	bytes	bytes to allocate
+	 *  @param[in]	alignment	a power of two
+	 *  @return the memory; valid until reset() or release()
+	 */
+	void * allocate( size_t bytes, size_t alignment );
+
+	/*! @brief Free all but the largest block and rewind it. */
+	void reset();
+
+	/*! @brief Free all blocks. */
+	void release();
+
+	/*! @brief Allocations served since construction. */
+	uint64_t allocations() const ;
+
+	/*! @brief Heap blocks held. */
+	size_t blocks() const ;
+
+	/*! @brief Bytes of the heap blocks held. */
+	size_t bytes() const ;
+
+private:
+	/*! @brief A heap block. */
+	struct Block_t_ {
+		char * data;
+		size_t size;
+	};
+
+	std::vector< Block_t_ > blocks_;
+	char * next_ = nullptr;		/*!< first free byte of the last block */
+	char * end_ = nullptr;		/*!< end of the last block */
+	size_t block_size_;
+	uint64_t allocations_ = 0;
+
+	/*! @brief Allocate from a new block. */
+	void * grow_( size_t bytes, size_t alignment );
+};
+
+inline void *
+Arena::allocate( size_t bytes, size_t alignment ) {
+
+	++ allocations_;
+	const uintptr_t next = reinterpret_cast< uintptr_t >(next_),
+	      aligned = ( next + alignment - 1 ) & ~( alignment - 1 );
+	if ( ( next_ == nullptr )
+			|| ( aligned + bytes > reinterpret_cast< uintptr_t >(end_) )) {
+		return grow_( bytes, alignment );
+	}
+	next_ = reinterpret_cast< char * >( aligned + bytes );
+	return reinterpret_cast< void * >(aligned);
+}
+
+
+/*! @brief Allocator over an Arena.
+ *
+ *  Implicitly constructible from the arena,
+ *  so that the containers below take the arena directly.
+ *  Containers given the same arena compare equal
+ *  and may swap or splice their elements.
+ */
+template < typename T >
+class ArenaAllocator {
+
+public:
+	typedef T value_type;
+
+	ArenaAllocator( Arena & arena ) noexcept :
+		arena_( &arena ) {}
+
+	template < typename U >
+	ArenaAllocator( const ArenaAllocator< U > & other ) noexcept :
+		arena_( &other.arena() ) {}
+
+	T * allocate( size_t n ) {
+		return static_cast< T * >(
+				arena_->allocate( n * sizeof(T), alignof(T) ));
+	}
+
+	void deallocate( T *, size_t ) noexcept {}
+
+	/*! @brief The arena allocated from. */
+	Arena & arena() const { return *arena_; }
+
+private:
+	Arena * arena_;
+};
+
+template < typename T, typename U >
+bool operator==( const ArenaAllocator< T > & a, const ArenaAllocator< U > & b ) {
+	return &a.arena() == &b.arena();
+}
+
+template < typename T, typename U >
+bool operator!=( const ArenaAllocator< T > & a, const ArenaAllocator< U > & b ) {
+	return !( a == b );
+}
+
+/*! @brief Containers over an Arena. */
+template < typename T >
+using ArenaVector = std::vector< T, ArenaAllocator< T > >;
+
+template < typename T >
+using ArenaList = std::list< T, ArenaAllocator< T > >;
+
+template < typename K, typename V, typename C = std::less< K > >
+using ArenaMultimap = std::multimap< K, V, C,
+	ArenaAllocator< std::pair< const K, V > > >;
+
+typedef std::basic_string< char, std::char_traits< char >,
+	ArenaAllocator< char > > ArenaString;
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_ARENA_HPP_ */
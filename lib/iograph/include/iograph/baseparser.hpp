@@ -22,6 +22,8 @@
 #ifndef _BASEPARSER_HPP_
 #define _BASEPARSER_HPP_
 
+#include <iograph/diagnostic.hpp>
+
 #include <iostream>
 #include <fstream>
 #include <list>
@@ -85,6 +87,13 @@ public:
 	 */
 	const BaseParser & showErrors( std::ostream & os = std::cout ) const ;
 
+	/**
+	 * @brief Errors generated during parse().
+	 * @return The error records, formatted on demand
+	 * through Diagnostics::format().
+	 */
+	const Diagnostics & getErrors() const ;
+
 	/********************************//*
 	 *  UTILITY STATIC FUNCTIONS
 	 ***********************************/
@@ -124,6 +133,17 @@ public:
 	 */
 	static void _toUpper( std::string & str );
 
+protected:
+
+	/**
+	 * @brief Record an error of the current line.
+	 * Malformed lines are recorded, not thrown;
+	 * the message is formatted by showErrors().
+	 * @param code What went wrong.
+	 * @param item The offending item, if any.
+	 */
+	void _error( Diagnostic::Code code, const std::string & item = std::string() );
+
 private:
 
 	/***************************//*
@@ -149,7 +169,12 @@ private:
 	/**
 	 * Errors list.
 	 */
-	std::list< std::string > _errors;
+	Diagnostics _errors;
+
+	/**
+	 * Number of the line being parsed.
+	 */
+	uint64_t _line_n = 0;
 };
 
 #endif /* _BASEPARSER_HPP_ */
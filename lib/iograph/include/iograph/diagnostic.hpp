@@ -0,0 +1,154 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_DIAGNOSTIC_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_DIAGNOSTIC_HPP_
+
+/*! @file diagnostic.hpp
+ *  @brief Compact records of parse errors
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*! @brief Parse error record.
+ *
+ *  Malformed input lines are recorded as a code
+ *  along with their position and the offending item;
+ *  the message is only formatted when printed,
+ *  through @ref Diagnostics::format().
+ */
+struct Diagnostic {
+
+	/*! @brief Error codes. */
+	enum Code : uint16_t {
+		OPTION_NOT_AT_BEGINNING = 0,	/*!< option after the first item */
+		NAMES_BEING_GIVEN,		/*!< repeated ``!BEGIN-OFFICIAL-NAMES`` */
+		NAMES_ALREADY_GIVEN,		/*!< ``!BEGIN-OFFICIAL-NAMES`` after ``!END-OFFICIAL-NAMES`` */
+		NAMES_AFTER_WANTS,		/*!< ``!BEGIN-OFFICIAL-NAMES`` after the want-lists */
+		UNKNOWN_DIRECTIVE,		/*!< unrecognized ``!`` directive; item: the line */
+		MISSING_OPTION_VALUE,		/*!< integer option without value; item: the option */
+		UNKNOWN_INT_OPTION,		/*!< item: the option */
+		UNKNOWN_OPTION,			/*!< item: the option */
+		BAD_NAME_LINE,			/*!< malformed official name line */
+		BAD_NAME_USERNAME,		/*!< malformed ``(from username)``; item: the token and the error */
+		DUMMY_NOT_ALLOWED,		/*!< dummy item without ``ALLOW-DUMMIES``; item: the dummy */
+		DUMMY_WITHOUT_USERNAME,		/*!< item: the dummy */
+		BAD_WANT_LIST,			/*!< empty or malformed want-list line */
+		MISSING_USERNAME,		/*!< no username with ``REQUIRE-USERNAMES`` */
+		MISSING_SOURCE,			/*!< no offered item */
+		MISSING_COLON,			/*!< no colon with ``REQUIRE-COLONS`` */
+		NO_OFFICIAL_NAME,		/*!< item: the offered item */
+		EXISTING_ENTRY,			/*!< repeated official name; item: the item */
+		REPEATED_WANT_LIST,		/*!< item: the offered item */
+		MULTIPLE_WANT_LISTS,		/*!< item: the offered item */
+		INVALID_COLON,			/*!< colon among the wanted items */
+		BAD_LOOP,			/*!< malformed trade loop line; item: the line */
+		MESSAGE,			/*!< free-form; item: the message */
+		MAX_CODES			/*!< not a code; always the __last__ code */
+	};
+
+	/*! @brief No item; see @ref item. */
+	static const uint32_t NO_ITEM = UINT32_MAX;
+
+	uint32_t line;		/*!< input line, starting from 1 */
+	uint32_t column;	/*!< column of the offending token, starting from 1; ``0`` if unknown */
+	Code code;		/*!< what went wrong */
+	uint16_t source;	/*!< prefix index; ``0`` for none */
+	uint32_t item;		/*!< id of the offending item; @ref NO_ITEM if none */
+};
+
+/*! @brief Collection of parse error records.
+ *
+ *  Offending items are interned,
+ *  so that each record stays fixed-size.
+ *  Records merged from another collection may carry a prefix,
+ *  e.g., the namespace of a combined trade.
+ */
+class Diagnostics {
+
+public:
+	/*! @brief Record an error.
+	 *
+	 *  @param[in]	line	input line, starting from 1
+	 *  @param[in]	column	column of the offending token; ``0`` if unknown
+	 *  @param[in]	code	what went wrong
+	 *  @param[in]	item	the offending item, if any
+	 */
+	void add( uint64_t line, size_t column, Diagnostic::Code code,
+			const std::string & item = std::string() );
+
+	/*! @brief Append the records of another collection.
+	 *
+	 *  @param[in]	other	the records to append
+	 *  @param[in]	prefix	prepended to each appended record,
+	 *  		as ``PREFIX:LINE:COLUMN:MESSAGE``
+	 */
+	void merge( const Diagnostics & other, const std::string & prefix );
+
+	/*! @brief Remove all records. */
+	void clear();
+
+	/*! @brief Whether no error has been recorded. */
+	bool empty() const ;
+
+	/*! @brief Number of records. */
+	size_t size() const ;
+
+	/*! @brief The records, in order. */
+	const std::vector< Diagnostic > & records() const ;
+
+	/*! @brief The offending item of a record; empty if none. */
+	const std::string & item( const Diagnostic & diagnostic ) const ;
+
+	/*! @brief Format a record as ``[PREFIX:]LINE:COLUMN:MESSAGE``.
+	 *
+	 *  The column is left out, as ``[PREFIX:]LINE:MESSAGE``, if unknown.
+	 */
+	std::string format( const Diagnostic & diagnostic ) const ;
+
+	/*! @brief Print all records, as @ref format(), one per line.
+	 *
+	 *  @param	os	output stream
+	 *  @param	lead	written before each record
+	 */
+	void print( std::ostream & os, const std::string & lead = std::string() ) const ;
+
+private:
+	/*! @brief Recorded errors. */
+	std::vector< Diagnostic > records_;
+
+	/*! @brief Interned items by id. */
+	std::vector< std::string > items_;
+
+	/*! @brief Item ids by item. */
+	std::unordered_map< std::string, uint32_t > item_ids_;
+
+	/*! @brief Record prefixes by index; index ``0`` is no prefix. */
+	std::vector< std::string > prefixes_ = std::vector< std::string >( 1 );
+
+	/*! @brief Intern an item.
+	 *
+	 *  @returns	its id; @ref Diagnostic::NO_ITEM if empty
+	 */
+	uint32_t intern_( const std::string & item );
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_DIAGNOSTIC_HPP_ */
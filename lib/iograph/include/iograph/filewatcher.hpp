@@ -0,0 +1,141 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_FILEWATCHER_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_FILEWATCHER_HPP_
+
+/*! @file filewatcher.hpp
+ *  @brief Wait for changes of a local file
+ */
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+/*! @brief Waits for a local file to be saved.
+ *
+ *  On Linux, the directory of the file is watched through inotify,
+ *  so that both in-place writes and the write-and-rename
+ *  of most editors are detected.
+ *  Elsewhere, the modification time of the file is polled.
+ *
+ *  Editors often save a file in several steps;
+ *  a change is only reported once no further change
+ *  has been seen for the debounce period.
+ *
+ *  Example:
+ *
+ *  	FileWatcher watcher("wants.txt");
+ *  	FileWatcher::Clock::time_point saved;
+ *  	while ( watcher.wait(saved) ) {
+ *  		// re-run
+ *  	}
+ */
+class FileWatcher {
+
+public:
+	/*! @brief Clock of the reported change times. */
+	typedef std::chrono::steady_clock Clock;
+
+	/*! @brief Source of changes.
+	 *
+	 *  Waits for the next change of the file, for at most
+	 *  the given milliseconds; negative to wait indefinitely.
+	 *  Returns ``false`` on timeout or interruption.
+	 */
+	typedef std::function< bool( int ) > Events;
+
+	/*! @brief Source of the current time. */
+	typedef std::function< Clock::time_point() > Now;
+
+	/*! @brief Start watching a file.
+	 *
+	 *  @param[in]	fn	the file to watch; it need not exist yet
+	 *  @param[in]	debounce_ms	quiet period after the last change,
+	 *  				in milliseconds
+	 *  @throws	std::runtime_error if the file cannot be watched
+	 */
+	explicit FileWatcher( const std::string & fn, int debounce_ms = 200 );
+
+	/*! @brief Debounce the changes of another source.
+	 *
+	 *  E.g., scripted changes on a simulated clock, in tests.
+	 *
+	 *  @param[in]	events	the source of changes
+	 *  @param[in]	now	the source of the current time
+	 *  @param[in]	debounce_ms	quiet period after the last change,
+	 *  				in milliseconds
+	 */
+	FileWatcher( Events events, Now now, int debounce_ms = 200 );
+
+	/*! @brief Destructor; stops watching. */
+	~FileWatcher();
+
+	FileWatcher( const FileWatcher & ) = delete;
+	FileWatcher & operator=( const FileWatcher & ) = delete;
+
+	/*! @brief Wait for the file to be saved.
+	 *
+	 *  Returns after the file has been changed
+	 *  and no further change has been seen for the debounce period.
+	 *
+	 *  @param[out]	changed	time of the last change
+	 *  @param[in]	timeout_ms	maximum wait for the first change,
+	 *  			in milliseconds; negative to wait indefinitely
+	 *  @returns	``false`` if no change has been seen within ``timeout_ms``,
+	 *  		or the wait has been interrupted by a signal
+	 *  @throws	std::runtime_error if watching fails
+	 */
+	bool wait( Clock::time_point & changed, int timeout_ms = -1 );
+
+	/*! @brief The watched file. */
+	const std::string & file() const ;
+
+private:
+	/*! @brief The watched file. */
+	std::string fn_;
+
+	/*! @brief Name of the watched file within its directory. */
+	std::string name_;
+
+	/*! @brief Quiet period after the last change, in milliseconds. */
+	int debounce_ms_;
+
+	/*! @brief Source of changes; next_() unless given. */
+	Events events_;
+
+	/*! @brief Source of the current time; Clock::now() unless given. */
+	Now now_;
+
+	/*! @brief inotify descriptor; ``-1`` if polling. */
+	int fd_ = -1;
+
+	/*! @brief Last seen modification time, if polling. */
+	std::string stamp_;
+
+	/*! @brief Wait for the next change.
+	 *
+	 *  @param[in]	timeout_ms	maximum wait; negative to wait indefinitely
+	 *  @returns	``false`` on timeout
+	 */
+	bool next_( int timeout_ms );
+
+	/*! @brief Modification time and size of the file, if polling. */
+	std::string readStamp_() const ;
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_FILEWATCHER_HPP_ */
@@ -0,0 +1,189 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_HTTPCACHE_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_HTTPCACHE_HPP_
+
+/*! @file httpcache.hpp
+ *  @brief On-disk cache of remote files
+ *
+ *  Stores retrieved payloads along with their validators,
+ *  so that unchanged files are not downloaded again.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+
+/*! @brief On-disk cache for conditional HTTP requests.
+ *
+ *  Attached to an HttpClient through HttpClient::setCache().
+ *  For every URL, the cache stores the last payload
+ *  together with its ``ETag`` and ``Last-Modified`` validators.
+ *  Subsequent requests carry ``If-None-Match`` and ``If-Modified-Since``;
+ *  on ``304 Not Modified`` the stored payload is replayed instead.
+ *
+ *  Each URL is stored as two files in the cache directory,
+ *  named after a hash of the URL:
+ *  ``<hash>.body`` holds the payload and ``<hash>.meta`` the validators.
+ *  Both are written to temporary files and renamed into place,
+ *  the metadata last, so that an interrupted run
+ *  never leaves a payload that appears valid but is not.
+ *
+ *  Payloads without any validator are not stored.
+ */
+class HttpCache {
+
+public:
+	/*! @brief Cache statistics. */
+	struct Stats {
+		unsigned requests = 0;	/*!< requests that consulted the cache */
+		unsigned hits = 0;	/*!< payloads replayed after ``304 Not Modified`` */
+		unsigned misses = 0;	/*!< payloads downloaded */
+		unsigned stores = 0;	/*!< payloads stored */
+		uint64_t bytes_downloaded = 0;	/*!< payload bytes downloaded */
+		uint64_t bytes_reused = 0;	/*!< payload bytes replayed from disk */
+	};
+
+	/*! @brief Validators of a stored payload. */
+	struct Entry {
+		std::string url;		/*!< the cached URL */
+		std::string etag;		/*!< ``ETag`` of the payload, if any */
+		std::string last_modified;	/*!< ``Last-Modified`` of the payload, if any */
+		uint64_t length = 0;		/*!< payload size in bytes */
+	};
+
+	/*! @brief Constructor.
+	 *
+	 *  @param[in]	directory	cache directory; created if missing
+	 *  @throws	std::runtime_error if the directory cannot be created
+	 */
+	explicit HttpCache( const std::string & directory );
+
+	/*! @brief The cache directory. */
+	const std::string & directory() const ;
+
+	/*! @brief Statistics since construction. */
+	const Stats & stats() const ;
+
+	/*! @brief Look up a URL.
+	 *
+	 *  @param[in]	url	the URL to look up
+	 *  @param[out]	entry	validators of the stored payload
+	 *  @returns	``true`` if a complete payload is stored for ``url``
+	 */
+	bool lookup( const std::string & url, Entry & entry ) const ;
+
+	/*! @brief Conditional request header fields for a URL.
+	 *
+	 *  @param[in]	url	the URL to be requested
+	 *  @returns	``If-None-Match`` and ``If-Modified-Since`` fields,
+	 *  		or none if nothing is stored for ``url``
+	 */
+	std::map< std::string, std::string > validators( const std::string & url );
+
+	/*! @brief Replay a stored payload.
+	 *
+	 *  Called on ``304 Not Modified``; counts as a hit.
+	 *
+	 *  @param[in]	url	the requested URL
+	 *  @param[in]	sink	receives the stored payload, piece by piece;
+	 *  			may be empty
+	 *  @returns	number of bytes replayed
+	 *  @throws	std::runtime_error if nothing is stored for ``url``
+	 */
+	uint64_t replay( const std::string & url,
+			const std::function< void(const char *, size_t) > & sink );
+
+	/*! @brief Discards the payload being stored on destruction.
+	 *
+	 *  Guards a request against exceptions and early returns:
+	 *  unless the payload was committed, @ref abort() removes
+	 *  its temporary file when the guard goes out of scope.
+	 */
+	class Guard {
+	public:
+		/*! @param[in]	cache	the cache; may be NULL */
+		explicit Guard( HttpCache * cache ) : cache_( cache ) {}
+		~Guard() {
+			if ( cache_ ) {
+				cache_->abort();
+			}
+		}
+		Guard( const Guard & ) = delete;
+		Guard & operator=( const Guard & ) = delete;
+	private:
+		HttpCache * cache_;
+	};
+
+	/*! @brief Destructor; discards any payload not committed. */
+	~HttpCache();
+
+	/*! @brief Start storing a downloaded payload.
+	 *
+	 *  Opens a temporary file; feed it with @ref append()
+	 *  and finish with @ref commit(), or discard it with @ref abort().
+	 *  Any previous temporary file is discarded.
+	 *  Call only once the response is known to carry the payload,
+	 *  i.e. on ``200 OK``.
+	 *
+	 *  @param[in]	url	the requested URL
+	 */
+	void begin( const std::string & url );
+
+	/*! @brief Append to the payload started by @ref begin(). */
+	void append( const char * data, size_t length );
+
+	/*! @brief Finish the payload started by @ref begin(); counts as a miss.
+	 *
+	 *  Renames the payload into place if it carries a validator;
+	 *  discards it otherwise.
+	 *
+	 *  @param[in]	headers	response header fields; names in lowercase
+	 *  @param[in]	length	payload size in bytes
+	 *  @throws	std::runtime_error if the payload cannot be stored
+	 */
+	void commit( const std::map< std::string, std::string > & headers,
+			uint64_t length );
+
+	/*! @brief Discard the payload started by @ref begin().
+	 *
+	 *  Closes and removes its temporary file;
+	 *  does nothing if no payload is being stored.
+	 */
+	void abort();
+
+private:
+	/*! @brief Cache directory. */
+	std::string directory_;
+
+	/*! @brief Statistics since construction. */
+	Stats stats_;
+
+	/*! @brief URL being stored by @ref begin(); empty if none. */
+	std::string pending_url_;
+
+	/*! @brief Temporary file being written by @ref append(). */
+	std::ofstream pending_;
+
+	/*! @brief Path of the cache files of a URL, without extension. */
+	std::string path_( const std::string & url ) const ;
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_HTTPCACHE_HPP_ */
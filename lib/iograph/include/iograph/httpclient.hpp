@@ -0,0 +1,209 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_HTTPCLIENT_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_HTTPCLIENT_HPP_
+
+/*! @file httpclient.hpp
+ *  @brief Minimal HTTP/1.1 client
+ *
+ *  Retrieves remote want-list files.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class HttpCache;
+
+/*! @brief Minimal HTTP/1.1 client.
+ *
+ *  Issues ``GET`` requests and passes the payload
+ *  to a sink piece by piece, as it is received.
+ *  The following are supported:
+ *
+ *  * ``Content-Length``, chunked and connection-delimited payloads.
+ *  * Persistent connections; idle connections are kept per host
+ *    and reused by subsequent requests.
+ *  * Timeouts; sockets are non-blocking and every wait
+ *    (connect, send, receive) is limited by @ref timeout().
+ *  * Concurrent retrieval of several URLs through @ref getAll().
+ *  * Conditional requests through an optional HttpCache;
+ *    see @ref setCache().
+ *  * ``gzip`` content encoding; the payload is decompressed
+ *    as it is received when the response carries
+ *    ``Content-Encoding: gzip``. Request it by passing
+ *    ``Accept-Encoding: gzip`` to @ref get().
+ *
+ *  Only plain ``http://`` URLs are supported.
+ *
+ *  Example:
+ *
+ *  	HttpClient client;
+ *  	std::string data;
+ *  	auto response = client.get( url, [&]( const char * p, size_t n ) {
+ *  		data.append( p, n );
+ *  	});
+ */
+class HttpClient {
+
+public:
+	/*! @brief Receives pieces of the payload. */
+	typedef std::function< void(const char *, size_t) > Sink;
+
+	/*! @brief Received response. */
+	struct Response {
+		int status = 0;		/*!< status code, e.g., ``200`` */
+		std::string reason;	/*!< reason phrase, e.g., ``OK`` */
+		std::map< std::string, std::string >
+			headers;	/*!< header fields; names in lowercase */
+		uint64_t length = 0;	/*!< payload bytes passed to the sink */
+		uint64_t transferred = 0;	/*!< payload bytes received,
+					  *  before any decoding */
+		bool reused = false;	/*!< served over a persistent connection */
+		bool cached = false;	/*!< payload replayed from the cache */
+	};
+
+	/*! @brief Constructor.
+	 *
+	 *  @param[in]	timeout_ms	maximum wait for any network operation,
+	 *  				in milliseconds
+	 */
+	explicit HttpClient( int timeout_ms = 30000 );
+
+	/*! @brief Destructor; closes all connections. */
+	~HttpClient();
+
+	HttpClient( const HttpClient & ) = delete;
+	HttpClient & operator=( const HttpClient & ) = delete;
+
+	/*! @brief Retrieve a URL.
+	 *
+	 *  The payload is passed to ``sink`` only on a ``2xx`` status;
+	 *  otherwise, it is discarded.
+	 *  A ``gzip``-encoded payload is passed decompressed.
+	 *  Any other status is not an error; check @ref Response::status.
+	 *
+	 *  @param[in]	url	URL in the form of ``http://host[:port]/path``
+	 *  @param[in]	sink	called with each received piece of the payload
+	 *  @param[in]	headers	additional request header fields
+	 *  @returns	the response status and header fields
+	 *  @throws	std::runtime_error if the URL is not supported,
+	 *  		a malformed response is received,
+	 *  		the content encoding is not supported or is corrupt,
+	 *  		the connection fails or an operation times out
+	 */
+	Response get( const std::string & url,
+			const Sink & sink,
+			const std::map< std::string, std::string > & headers
+				= std::map< std::string, std::string >() );
+
+	/*! @brief Retrieve several URLs concurrently.
+	 *
+	 *  Each URL is retrieved by its own thread and client;
+	 *  ``sinks[i]`` receives the payload of ``urls[i]``
+	 *  and is only ever called from that thread.
+	 *
+	 *  @param[in]	urls	URLs to retrieve
+	 *  @param[in]	sinks	one sink per URL
+	 *  @param[in]	timeout_ms	maximum wait for any network operation,
+	 *  				in milliseconds
+	 *  @returns	the responses, in the order of ``urls``
+	 *  @throws	std::logic_error if the number of sinks and URLs differ
+	 *  @throws	std::runtime_error on the first failed retrieval,
+	 *  		after all retrievals have finished
+	 */
+	static std::vector< Response > getAll(
+			const std::vector< std::string > & urls,
+			const std::vector< Sink > & sinks,
+			int timeout_ms = 30000 );
+
+	/*! @brief Maximum wait for any network operation, in milliseconds. */
+	int timeout() const ;
+
+	/*! @brief Set the maximum wait for any network operation.
+	 *
+	 *  @param[in]	timeout_ms	timeout in milliseconds
+	 */
+	void setTimeout( int timeout_ms );
+
+	/*! @brief Number of connections opened so far. */
+	unsigned connections() const ;
+
+	/*! @brief Attach an on-disk cache.
+	 *
+	 *  Requests become conditional on the cached validators;
+	 *  on ``304 Not Modified`` the cached payload is passed to the sink
+	 *  and reported as a ``200`` response with @ref Response::cached set.
+	 *  Downloaded payloads are stored as they are received.
+	 *
+	 *  @param[in]	cache	the cache, which must outlive the client;
+	 *  			``nullptr`` to detach
+	 */
+	void setCache( HttpCache * cache );
+
+private:
+	/*! @brief Open connection and its receive buffer. */
+	struct Connection_;
+
+	/*! @brief Components of a URL. */
+	struct Url_ {
+		std::string host;	/*!< e.g., ``bgg.activityclub.org`` */
+		unsigned short port;	/*!< e.g., ``80`` */
+		std::string authority;	/*!< ``host[:port]``, as given */
+		std::string target;	/*!< e.g., ``/olwlg/207635-officialwants.txt`` */
+	};
+
+	/*! @brief Maximum wait for any network operation, in milliseconds. */
+	int timeout_ms_;
+
+	/*! @brief Number of connections opened so far. */
+	unsigned connections_ = 0;
+
+	/*! @brief Attached cache, if any. */
+	HttpCache * cache_ = nullptr;
+
+	/*! @brief Idle persistent connections, by ``host:port``. */
+	std::map< std::string, std::unique_ptr< Connection_ > > idle_;
+
+	/*! @brief Split a URL into its components.
+	 *
+	 *  @throws	std::runtime_error if the URL is not supported
+	 */
+	static Url_ parseUrl_( const std::string & url );
+
+	/*! @brief Read the status line and header fields.
+	 *
+	 *  Skips any interim ``1xx`` responses.
+	 */
+	static void readHeader_( Connection_ & connection,
+			Response & response );
+
+	/*! @brief Read the payload.
+	 *
+	 *  @param[in]	sink	receives the payload; may be empty to discard it
+	 *  @returns	``true`` if the connection may be reused
+	 */
+	static bool readBody_( Connection_ & connection,
+			Response & response,
+			const Sink & sink );
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_HTTPCLIENT_HPP_ */
@@ -0,0 +1,184 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_INFLATER_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_INFLATER_HPP_
+
+/*! @file inflater.hpp
+ *  @brief Incremental gzip decompression
+ *
+ *  Decompresses gzip data piece by piece, as it is received or read,
+ *  without holding the whole input or output in memory.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+/*! @brief Incremental gzip decompressor.
+ *
+ *  Push-style: compressed data is fed through @ref feed()
+ *  and the decompressed data is passed to a sink piece by piece.
+ *  Concatenated gzip members, as produced by ``cat a.gz b.gz``,
+ *  are decompressed one after the other.
+ *
+ *  Example:
+ *
+ *  	Inflater inflater;
+ *  	auto sink = [&]( const char * p, size_t n ) {
+ *  		want_parser.parseChunk( p, n );
+ *  	};
+ *  	while ( ... ) {
+ *  		inflater.feed( data, length, sink );
+ *  	}
+ *  	inflater.finish();
+ */
+class Inflater {
+
+public:
+	/*! @brief Receives pieces of the decompressed data. */
+	typedef std::function< void(const char *, size_t) > Sink;
+
+	/*! @brief Constructor.
+	 *
+	 *  @throws	std::runtime_error if zlib cannot be initialized
+	 */
+	Inflater();
+
+	/*! @brief Destructor. */
+	~Inflater();
+
+	Inflater( const Inflater & ) = delete;
+	Inflater & operator=( const Inflater & ) = delete;
+
+	/*! @brief Check for the gzip magic number.
+	 *
+	 *  @param[in]	data	pointer to the start of the data
+	 *  @param[in]	length	number of bytes in ``data``
+	 *  @returns	``true`` if ``data`` starts with ``1f 8b``
+	 */
+	static bool isGzip( const char * data, size_t length );
+
+	/*! @brief Check whether a file is gzip-compressed.
+	 *
+	 *  @param[in]	fn	the file to check
+	 *  @returns	``true`` if ``fn`` can be opened
+	 *  		and starts with the gzip magic number
+	 */
+	static bool isGzipFile( const std::string & fn );
+
+	/*! @brief Decompress the next piece of compressed data.
+	 *
+	 *  @param[in]	data	pointer to the compressed data
+	 *  @param[in]	length	number of bytes in ``data``
+	 *  @param[in]	sink	called with each piece of decompressed data
+	 *  @throws	std::runtime_error if the data is not valid gzip
+	 */
+	void feed( const char * data, size_t length, const Sink & sink );
+
+	/*! @brief Decompress into a buffer.
+	 *
+	 *  Pull-style counterpart of @ref feed().
+	 *  Consumes compressed data from ``data`` and ``length``
+	 *  until ``out`` is full or the input is exhausted.
+	 *
+	 *  @param[in,out]	data	pointer to the compressed data;
+	 *  			advanced past the consumed bytes
+	 *  @param[in,out]	length	number of bytes in ``data``;
+	 *  			decreased by the consumed bytes
+	 *  @param[out]	out	buffer for the decompressed data
+	 *  @param[in]	capacity	size of ``out``
+	 *  @returns	number of bytes written to ``out``
+	 *  @throws	std::runtime_error if the data is not valid gzip
+	 */
+	size_t inflate( const char * & data, size_t & length,
+			char * out, size_t capacity );
+
+	/*! @brief Check that the compressed data is complete.
+	 *
+	 *  @throws	std::runtime_error if the data ends
+	 *  		in the middle of a gzip member
+	 */
+	void finish() const ;
+
+	/*! @brief Number of compressed bytes consumed so far. */
+	uint64_t consumed() const ;
+
+	/*! @brief Number of decompressed bytes produced so far. */
+	uint64_t produced() const ;
+
+private:
+	/*! @brief zlib state; keeps ``zlib.h`` out of this header. */
+	struct State_;
+	std::unique_ptr< State_ > state_;
+};
+
+/*! @brief Input stream buffer decompressing a gzip source.
+ *
+ *  Pull-style counterpart of Inflater;
+ *  wraps the stream buffer of a gzip file
+ *  so that it can be read through a ``std::istream``.
+ *
+ *  Example:
+ *
+ *  	std::filebuf fb;
+ *  	fb.open( "wants.txt.gz", std::ios::in | std::ios::binary );
+ *  	InflateStreambuf zb( &fb );
+ *  	std::istream is( &zb );
+ *  	is.exceptions( std::ios::badbit );
+ *
+ *  Errors are thrown from @ref underflow(); streams report them
+ *  by setting ``badbit``, so enable exceptions on ``badbit``
+ *  to tell a corrupt file from a short one.
+ */
+class InflateStreambuf : public std::streambuf {
+
+public:
+	/*! @brief Constructor.
+	 *
+	 *  @param[in]	source	the compressed data;
+	 *  			must outlive this stream buffer
+	 */
+	explicit InflateStreambuf( std::streambuf * source );
+
+protected:
+	/*! @brief Refill the get area with decompressed data.
+	 *
+	 *  @throws	std::runtime_error if the source is not valid gzip,
+	 *  		or ends in the middle of a gzip member
+	 */
+	int_type underflow() override;
+
+private:
+	static const size_t BUFSIZE = (1 << 16);
+
+	std::streambuf * source_;
+	Inflater inflater_;
+
+	/*! @brief Compressed data read from the source;
+	 *  ``[in_next_, in_next_ + in_length_)`` is not consumed yet. */
+	std::unique_ptr< char[] > in_;
+	const char * in_next_;
+	size_t in_length_ = 0;
+
+	/*! @brief Decompressed data; the get area. */
+	std::unique_ptr< char[] > out_;
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_INFLATER_HPP_ */
@@ -0,0 +1,247 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_MEMORY_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_MEMORY_HPP_
+
+/*! @file memory.hpp
+ *  @brief Account the memory of the pipeline phases and data structures
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*! @brief Heap allocations of the process.
+ *
+ *  Counts the bytes and the number of heap allocations,
+ *  once enabled, as reported by allocated() and freed().
+ *  The program reports them by replacing the global
+ *  ``operator new`` and ``operator delete``;
+ *  e.g., ``mathtrader++`` does so in ``app/memoryhooks.cpp``.
+ *  Otherwise, only the resident set size is available.
+ *
+ *  Blocks allocated before enable() and freed afterwards
+ *  are subtracted too; enable it as early as possible.
+ */
+class MemoryAccount {
+
+public:
+	/*! @brief Start counting. */
+	static void enable();
+
+	/*! @brief Whether counting has been enabled. */
+	static bool enabled();
+
+	/*! @brief Account an allocation; called by operator new.
+	 *
+	 *  @param[in]	bytes	usable size of the block
+	 */
+	static void allocated( size_t bytes );
+
+	/*! @brief Account a deallocation; called by operator delete.
+	 *
+	 *  @param[in]	bytes	usable size of the block
+	 */
+	static void freed( size_t bytes );
+
+	/*! @brief Bytes currently allocated. */
+	static int64_t current();
+
+	/*! @brief Most bytes allocated at once since resetPeak(). */
+	static int64_t peak();
+
+	/*! @brief Number of allocations so far. */
+	static uint64_t allocations();
+
+	/*! @brief Restart tracking the peak from the current bytes. */
+	static void resetPeak();
+
+	/*! @brief Resident set size of the process, in KiB; 0 if unknown. */
+	static long currentRss();
+
+	/*! @brief Peak resident set size of the process, in KiB; 0 if unknown. */
+	static long peakRss();
+};
+
+/*! @brief Huge-page policy for large heap blocks.
+ *
+ *  Within a Scope, heap blocks of at least SIZE bytes,
+ *  e.g. the flow network and the potentials of the solver,
+ *  are aligned to SIZE and advised to be backed by
+ *  transparent huge pages (``madvise(MADV_HUGEPAGE)``),
+ *  to save TLB misses when they are traversed at random.
+ *  Where the aligned allocation fails, blocks are allocated as usual;
+ *  where the kernel does not take the advice, they stay on small pages.
+ *
+ *  Like MemoryAccount, it applies only where
+ *  the global ``operator new`` asks for it through wanted();
+ *  e.g., ``app/memoryhooks.cpp`` does so.
+ */
+class HugePages {
+
+public:
+	/*! @brief Size of a huge page, and the least size of a block. */
+	static constexpr size_t SIZE = 2 << 20;
+
+	/*! @brief Requests huge pages within the enclosing scope.
+	 *
+	 *  Scopes may nest, also over threads;
+	 *  the policy applies while any enabled one is open.
+	 */
+	class Scope {
+
+	public:
+		/*! @brief Open the scope.
+		 *
+		 *  @param[in]	enable	whether to request huge pages at all
+		 */
+		explicit Scope( bool enable = true );
+
+		/*! @brief Close the scope. */
+		~Scope();
+
+		Scope( const Scope & ) = delete;
+		Scope & operator=( const Scope & ) = delete;
+
+		/*! @brief Blocks advised since the scope was opened. */
+		uint64_t blocks() const ;
+
+		/*! @brief Bytes of the blocks advised since the scope was opened. */
+		uint64_t bytes() const ;
+
+	private:
+		bool enable_;
+		uint64_t blocks_;
+		uint64_t bytes_;
+	};
+
+	/*! @brief Whether a block is to be allocated by allocate().
+	 *
+	 *  @param[in]	bytes	requested size of the block
+	 */
+	static bool wanted( size_t bytes );
+
+	/*! @brief Allocate a block aligned to SIZE and advise huge pages.
+	 *
+	 *  Does not allocate through ``operator new``;
+	 *  safe to call from it.
+	 *
+	 *  @param[in]	bytes	requested size of the block
+	 *  @return the block, to be freed by ``std::free()``;
+	 *  	``nullptr`` if it could not be allocated
+	 */
+	static void * allocate( size_t bytes );
+
+	/*! @brief Blocks advised so far. */
+	static uint64_t blocks();
+
+	/*! @brief Bytes of the blocks advised so far. */
+	static uint64_t bytes();
+
+	/*! @brief Anonymous memory of the process on huge pages, in KiB;
+	 *  0 if none or unknown.
+	 */
+	static long residentKb();
+};
+
+/*! @brief Memory report of a run.
+ *
+ *  Collects the allocations of each pipeline phase,
+ *  as counted by MemoryAccount,
+ *  and the estimated bytes of each data structure (subsystem),
+ *  as reported by their owners, e.g. @ref WantParser::memoryUsage().
+ *
+ *  Example:
+ *
+ *  	MemoryReport report;
+ *  	{
+ *  		MemoryReport::Phase phase( report, "parse" );
+ *  		want_parser.parseFile(fn);
+ *  	}
+ *  	want_parser.memoryUsage( report );
+ *  	report.print( std::cout );
+ */
+class MemoryReport {
+
+public:
+	/*! @brief Accounts the enclosing scope as a phase. */
+	class Phase {
+
+	public:
+		/*! @brief Start the phase.
+		 *
+		 *  Restarts tracking the allocation peak.
+		 */
+		Phase( MemoryReport & report, const std::string & name );
+
+		/*! @brief End the phase and add it to the report. */
+		~Phase();
+
+		Phase( const Phase & ) = delete;
+		Phase & operator=( const Phase & ) = delete;
+
+	private:
+		MemoryReport & report_;
+		std::string name_;
+		int64_t current_;
+		uint64_t allocations_;
+	};
+
+	/*! @brief Add the estimated bytes of a data structure.
+	 *
+	 *  @param[in]	subsystem	name of the data structure
+	 *  @param[in]	bytes	estimated bytes
+	 */
+	void add( const std::string & subsystem, size_t bytes );
+
+	/*! @brief Print the phases, the subsystems and the RSS.
+	 *
+	 *  @param[in]	os	the output stream
+	 */
+	void print( std::ostream & os ) const ;
+
+	/*! @brief Heap bytes of a string, beyond the string object. */
+	static size_t heapBytes( const std::string & str );
+
+	/*! @brief Heap bytes of a node of a node-based container,
+	 *  e.g. ``std::map``, beyond its value.
+	 */
+	static constexpr size_t NODE_OVERHEAD = 4 * sizeof(void *);
+
+private:
+	/*! @brief Allocations of a phase. */
+	struct Phase_t_ {
+		std::string name;
+		int64_t peak;		/*!< peak bytes over the start */
+		int64_t retained;	/*!< bytes still allocated at the end */
+		uint64_t allocations;
+		long peak_rss;		/*!< peak RSS at the end, in KiB */
+	};
+
+	/*! @brief Estimated bytes of a data structure. */
+	struct Subsystem_t_ {
+		std::string name;
+		size_t bytes;
+	};
+
+	std::vector< Phase_t_ > phases_;
+	std::vector< Subsystem_t_ > subsystems_;
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_MEMORY_HPP_ */
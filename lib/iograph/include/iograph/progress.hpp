@@ -0,0 +1,91 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_PROGRESS_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_PROGRESS_HPP_
+
+/*! @file progress.hpp
+ *  @brief Report the progress of long phases; cancel them cooperatively
+ */
+
+#include <cstdint>
+#include <functional>
+
+/*! @brief Progress of a phase of a run.
+ *
+ *  Reported when a phase starts and, where the phase
+ *  can tell, after each of its steps;
+ *  e.g., after each augmenting path of the solver.
+ */
+struct Progress {
+	const char * phase = "";	/*!< name of the phase; a string literal */
+	int64_t done = 0;		/*!< steps done so far */
+	int64_t total = 0;		/*!< steps expected; 0 if unknown */
+	int64_t objective = 0;		/*!< current objective, if has_objective */
+	bool has_objective = false;
+	bool interruptible = true;	/*!< whether the phase checks for cancellation */
+};
+
+/*! @brief Receives the progress of a run.
+ *
+ *  Called on the thread that makes the progress;
+ *  it should return quickly.
+ */
+typedef std::function< void( const Progress & ) > ProgressCallback;
+
+/*! @brief Thrown by Cancellation::check().
+ *
+ *  Deliberately not a std::exception:
+ *  the error handlers of the phases let it through,
+ *  up to the caller that requested the cancellation.
+ */
+class Cancelled {};
+
+/*! @brief Cooperative cancellation of the process.
+ *
+ *  A request is only a flag; the parser and the solver
+ *  check it at their checkpoints and throw Cancelled.
+ *
+ *  Example:
+ *
+ *  	void onInterrupt( int ) { Cancellation::request(); }
+ *  	...
+ *  	std::signal( SIGINT, onInterrupt );
+ */
+class Cancellation {
+
+public:
+	/*! @brief Request the cancellation.
+	 *
+	 *  Async-signal-safe; may be called from a signal handler.
+	 */
+	static void request();
+
+	/*! @brief Whether the cancellation has been requested. */
+	static bool requested();
+
+	/*! @brief Withdraw any request. */
+	static void reset();
+
+	/*! @brief Checkpoint.
+	 *
+	 *  @throws	Cancelled if the cancellation has been requested
+	 */
+	static void check();
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_PROGRESS_HPP_ */
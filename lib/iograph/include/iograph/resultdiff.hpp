@@ -0,0 +1,155 @@
+/* This file is part of MathTrader++, a C++ utility
+ * for finding, on a directed graph whose arcs have costs,
+ * a set of vertex-disjoint cycles that maximizes the number
+ * of covered vertices as a first priority
+ * and minimizes the total cost as a second priority.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _RESULTDIFF_HPP_
+#define _RESULTDIFF_HPP_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ResultDiff {
+
+public:
+	/**
+	 * @brief Constructor.
+	 * Details.
+	 */
+	ResultDiff();
+
+	/**
+	 * @brief Destructor.
+	 * Details.
+	 */
+	~ResultDiff();
+
+	/**
+	 * @brief Set the previous results.
+	 * Trade loops as item ids, each loop ending with its first item,
+	 * e.g., as given by a ResultParser.
+	 * @param items Item names, indexed by id
+	 * @param users Usernames of the item owners, indexed by id
+	 * @param loops Item ids of the loops
+	 * @return *this
+	 */
+	ResultDiff & setPrevious( const std::vector< std::string > & items,
+			const std::vector< std::string > & users,
+			const std::vector< uint32_t > & loops );
+
+	/**
+	 * @brief Set the current results.
+	 * Same format as setPrevious().
+	 * @return *this
+	 */
+	ResultDiff & setCurrent( const std::vector< std::string > & items,
+			const std::vector< std::string > & users,
+			const std::vector< uint32_t > & loops );
+
+	/**
+	 * @brief Compute the changes.
+	 * Compares what each item receives, item by item,
+	 * and which loops its items have moved to, loop by loop.
+	 * Runs in time linear to the number of items.
+	 */
+	void run();
+
+	/**
+	 * @brief Print the change report.
+	 * Counts of the changes, followed by
+	 * a line for each item that changed
+	 * and the users that no longer trade.
+	 * @param os The output stream (default: std::cout).
+	 * @return *this
+	 */
+	const ResultDiff & print( std::ostream & os = std::cout ) const ;
+
+	/**
+	 * @brief Change counts.
+	 */
+	unsigned getNumChanged() const ;	/**< items receiving another item */
+	unsigned getNumLost() const ;		/**< items no longer trading */
+	unsigned getNumGained() const ;		/**< items newly trading */
+	unsigned getNumSplit() const ;		/**< previous loops split */
+	unsigned getNumMerged() const ;		/**< current loops merged */
+
+	/**
+	 * @brief Users no longer trading.
+	 * @return The usernames, in order of appearance
+	 */
+	const std::vector< std::string > & getLostUsers() const ;
+
+private:
+	/**
+	 * @brief No item, no loop.
+	 */
+	static const uint32_t NONE = UINT32_MAX;
+
+	/**
+	 * @brief Trade of each item in a set of results.
+	 * Indexed by the common item ids.
+	 */
+	struct Results_t_ {
+		std::vector< uint32_t > receive;	/**< item received */
+		std::vector< uint32_t > loop;		/**< loop of the item */
+		std::vector< uint32_t > sequence;	/**< items loop by loop */
+		uint32_t n_loops = 0;			/**< number of loops */
+	};
+	Results_t_ _previous, _current;
+
+	/**
+	 * @brief Common item table.
+	 * Item names and owners by common id, and ids by name.
+	 */
+	std::vector< std::string > _items;
+	std::vector< std::string > _users;
+	std::unordered_map< std::string, uint32_t > _item_ids;
+
+	/**
+	 * @brief Changes found by run().
+	 */
+	std::vector< uint32_t > _changed, _lost, _gained;
+	unsigned _n_split, _n_merged;
+	std::vector< std::string > _lost_users;
+
+	/**
+	 * @brief Load results.
+	 * Maps their items to common ids.
+	 */
+	void _load( Results_t_ & results,
+			const std::vector< std::string > & items,
+			const std::vector< std::string > & users,
+			const std::vector< uint32_t > & loops );
+
+	/**
+	 * @brief Count loops of @from whose trading items
+	 * are now found in more than one loop of @to.
+	 */
+	unsigned _countSplit( const Results_t_ & from, const Results_t_ & to ) const ;
+
+	/**
+	 * @brief Item with its owner, as "(USER) ITEM".
+	 */
+	std::string _label( uint32_t id ) const ;
+};
+
+#endif /* _RESULTDIFF_HPP_ */
@@ -23,7 +23,9 @@
 #define _RESULTPARSER_HPP_
 
 #include "baseparser.hpp"
+#include <cstdint>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 class ResultParser : public BaseParser {
@@ -58,6 +60,30 @@ public:
 	 */
 	const ResultParser & print( const std::string & fn ) const ;
 
+	/**
+	 * @brief Items of the loops.
+	 * Uppercase item names, without quotation marks,
+	 * indexed by the ids in getLoops().
+	 * Dummy items are named as "%ITEM-(USERNAME)".
+	 * @return The item names
+	 */
+	const std::vector< std::string > & getItems() const ;
+
+	/**
+	 * @brief Owners of the items.
+	 * Usernames, without parentheses, indexed by item id.
+	 * @return The usernames
+	 */
+	const std::vector< std::string > & getUsers() const ;
+
+	/**
+	 * @brief Trade loops.
+	 * Item ids of the loops, each loop ending with its first item:
+	 * 	A B C A E F E ...
+	 * @return The item ids
+	 */
+	const std::vector< uint32_t > & getLoops() const ;
+
 private:
 	/***************************//*
 	 * 	OPTIONS
@@ -79,12 +105,20 @@ private:
 	 * INTERNAL DATA STRUCTURES
 	 *****************************/
 
+	/**
+	 * @brief Item table.
+	 * Names of the items by id, and ids by name.
+	 */
+	std::vector< std::string > _items;
+	std::vector< std::string > _users;
+	std::unordered_map< std::string, uint32_t > _item_ids;
+
 	/**
 	 * @brief Cycle list.
-	 * List to keep cycle nodes.
+	 * Item ids of the cycle nodes.
 	 * Expected: A B C D A E F G H E
 	 */
-	std::list< std::string > _item_list;
+	std::vector< uint32_t > _loops;
 
 	/**
 	 * @brief Loop flags
@@ -92,7 +126,7 @@ private:
 	 * First item of cycle to detect its end.
 	 */
 	bool _new_loop;
-	std::string _first_item;
+	uint32_t _first_item;
 
 
 	/********************************//*
@@ -115,10 +149,24 @@ private:
 
 	/**
 	 * @brief Parse loop
+	 * Scans a loop line in a single pass:
+	 * 	(USER) ITEM receives (USER) ITEM
+	 * where either item may be given as
+	 * 	%DUMMY for user (USER)
 	 * @return *this
 	 */
 	ResultParser & _parseLoop( const std::string & option );
 
+	/**
+	 * @brief Item id.
+	 * Makes the item uppercase and adds it to the table,
+	 * if not already there.
+	 * @param item The item name; modified.
+	 * @param user The owner, as "(USERNAME)".
+	 * @return The item id
+	 */
+	uint32_t _itemId( std::string & item, const std::string & user );
+
 };
 
 #endif /* _RESULTPARSER_HPP_ */
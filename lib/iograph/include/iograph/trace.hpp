@@ -0,0 +1,167 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_TRACE_HPP_
+#define _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_TRACE_HPP_
+
+/*! @file trace.hpp
+ *  @brief Trace the phases of a run as Chrome trace events
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*! @brief Collects timed zones of all threads.
+ *
+ *  Zones are recorded as complete ("X") events of the
+ *  Chrome trace-event format, with the process id and a small
+ *  per-thread id, so that the trace can be inspected
+ *  in chrome://tracing or in the Perfetto UI.
+ *
+ *  Recording is off by default; a zone then costs
+ *  a single atomic load.
+ *
+ *  Example:
+ *
+ *  	Trace::instance().start();
+ *  	{
+ *  		TraceZone zone("parse", "iograph");
+ *  		// ...
+ *  	}
+ *  	Trace::instance().write("trace.json");
+ */
+class Trace {
+
+public:
+	/*! @brief Clock of the zones. */
+	typedef std::chrono::steady_clock Clock;
+
+	/*! @brief The trace of the process. */
+	static Trace & instance();
+
+	/*! @brief Start recording.
+	 *
+	 *  Discards any recorded zones;
+	 *  timestamps are relative to this call.
+	 */
+	void start();
+
+	/*! @brief Stop recording; keeps the recorded zones. */
+	void stop();
+
+	/*! @brief Whether zones are being recorded. */
+	bool enabled() const ;
+
+	/*! @brief Record a zone.
+	 *
+	 *  @param[in]	name	name of the zone; must outlive the trace
+	 *  @param[in]	category	category of the zone; must outlive the trace
+	 *  @param[in]	begin	start of the zone
+	 *  @param[in]	end	end of the zone
+	 */
+	void record( const char * name, const char * category,
+			Clock::time_point begin, Clock::time_point end );
+
+	/*! @brief Number of recorded zones. */
+	size_t size() const ;
+
+	/*! @brief Write the trace-event JSON.
+	 *
+	 *  @param[in]	os	the output stream
+	 */
+	void write( std::ostream & os ) const ;
+
+	/*! @brief Write the trace-event JSON to a file.
+	 *
+	 *  @param[in]	fn	the output file
+	 *  @throws	std::runtime_error if the file cannot be written
+	 */
+	void write( const std::string & fn ) const ;
+
+	/*! @brief Small id of the calling thread.
+	 *
+	 *  Threads are numbered from 1 in the order they first ask.
+	 */
+	static uint32_t threadId();
+
+private:
+	Trace() = default;
+	Trace( const Trace & ) = delete;
+	Trace & operator=( const Trace & ) = delete;
+
+	/*! @brief A recorded zone. */
+	struct Zone_t_ {
+		const char * name;
+		const char * category;
+		uint32_t tid;
+		int64_t begin_us;	/*!< since start() */
+		int64_t duration_us;
+	};
+
+	/*! @brief Whether zones are being recorded. */
+	std::atomic< bool > enabled_{ false };
+
+	/*! @brief Time of start(). */
+	Clock::time_point epoch_;
+
+	/*! @brief Recorded zones, guarded by mutex_. */
+	std::vector< Zone_t_ > zones_;
+	mutable std::mutex mutex_;
+};
+
+/*! @brief Records the enclosing scope as a zone.
+ *
+ *  Nothing is recorded if the Trace is not enabled
+ *  at construction.
+ *  Zones of the same thread nest if their scopes nest.
+ */
+class TraceZone {
+
+public:
+	/*! @brief Start the zone.
+	 *
+	 *  @param[in]	name	name of the zone; a string literal
+	 *  @param[in]	category	category of the zone; a string literal
+	 */
+	explicit TraceZone( const char * name, const char * category = "mathtrader" );
+
+	/*! @brief End the zone and record it, unless already ended. */
+	~TraceZone();
+
+	/*! @brief End the zone before the end of the scope.
+	 *
+	 *  For zones of code that declares objects used
+	 *  after the zone.
+	 */
+	void end();
+
+	TraceZone( const TraceZone & ) = delete;
+	TraceZone & operator=( const TraceZone & ) = delete;
+
+private:
+	const char * name_;
+	const char * category_;
+	bool enabled_;
+	Trace::Clock::time_point begin_;
+};
+
+#endif /* _MATHTRADER_MATHTRADER_IOGRAPH_INCLUDE_IOGRAPH_TRACE_HPP_ */
@@ -25,7 +25,13 @@
  *  to Lemon Graph Format.
  */
 
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iograph/arena.hpp>
+#include <iograph/diagnostic.hpp>
+#include <iograph/httpclient.hpp>
+#include <iograph/memory.hpp>
 #include <list>
 #include <map>
 #include <regex>
@@ -145,9 +151,12 @@ public:
 	 *  Reads a want-list from the given input stream
 	 *  and converts it to a graph.
 	 *  Opens the input file and calls @ref parseStream().
+	 *  gzip-compressed files, e.g., ``wants.txt.gz``, are detected
+	 *  by their magic number and decompressed while parsed.
 	 *
 	 *  @param[in]	fn	the input file to read the want-lists from
-	 *  @throws	std::runtime_error if file ``fn`` cannot be opened
+	 *  @throws	std::runtime_error if file ``fn`` cannot be opened,
+	 *  		or is compressed and corrupt
 	 */
 	void parseFile( const std::string & fn );
 
@@ -173,10 +182,185 @@ public:
 	 *
 	 *  	http://bgg.activityclub.org/olwlg/207635-officialwants.txt
 	 *
+	 *  The payload is parsed while it is being received,
+	 *  through @ref parseChunk(); it is never stored in full.
+	 *  A ``gzip``-encoded payload is requested
+	 *  and decompressed on the fly.
+	 *
 	 *  @param[in]	url	URL of input stream to fetch and read
+	 *  @throws	std::runtime_error if the download fails;
+	 *  		lines received until then have already been parsed
 	 */
 	void parseUrl( const std::string & url );
 
+	/*! @brief Convert want-lists from URL to graph.
+	 *
+	 *  As @ref parseUrl(const std::string &),
+	 *  but over the given client, so that its persistent connections
+	 *  and timeout are used.
+	 *
+	 *  @param[in]	url	URL of input stream to fetch and read
+	 *  @param[in]	client	HTTP client to retrieve the URL with
+	 *  @throws	std::runtime_error if the download fails;
+	 *  		lines received until then have already been parsed
+	 */
+	void parseUrl( const std::string & url, HttpClient & client );
+
+	/*! @brief Feed want-list data to be parsed.
+	 *
+	 *  Push-style counterpart of @ref parseStream().
+	 *  Every complete line in the given data is parsed immediately;
+	 *  an incomplete last line is kept until the next call
+	 *  or until @ref parseEnd() is called.
+	 *
+	 *  @param[in]	data	pointer to the received data
+	 *  @param[in]	length	number of bytes in ``data``
+	 *  @throws	Cancelled if a Cancellation has been requested;
+	 *  		checked once per call
+	 */
+	void parseChunk( const char * data, size_t length );
+
+	/*! @brief Finish parsing data fed by @ref parseChunk().
+	 *
+	 *  Parses any incomplete last line
+	 *  and resets the line numbering for the next input.
+	 */
+	void parseEnd();
+
+	/*! @} */ // end of group
+
+	/************************
+	 * 	COMBINED TRADES	*
+	 ************************/
+
+	/*! @name Combined trades
+	 *
+	 *  Regional trades may be combined into a single trade.
+	 *  Each want-list file is parsed on its own, with its own options,
+	 *  and its items and users are placed under a namespace,
+	 *  so that item IDs and usernames of different files do not clash.
+	 *  A namespaced item is given as ``NS:ITEM``, e.g., ``GR:0042-PUERTO``;
+	 *  for dummy items, the namespace follows the leading ``%``,
+	 *  e.g., ``%GR:PUERTO-(ALDIE)``.
+	 *  Usernames are given as ``NS:USERNAME``.
+	 *
+	 *  Example:
+	 *
+	 *  	WantParser want_parser;
+	 *  	want_parser.parseFiles({"greece.txt", "cyprus.txt"}, {"GR", "CY"});
+	 *  	want_parser.print("combined.lgf");
+	 */
+	/*! @{ */ // start of group
+
+	/*! @brief Convert several want-list files to a single graph.
+	 *
+	 *  Parses each file concurrently in its own WantParser,
+	 *  through @ref parseFile(),
+	 *  and merges them in the given order through @ref merge().
+	 *
+	 *  @param[in]	files	the input files to read the want-lists from
+	 *  @param[in]	namespaces	namespace of each file;
+	 *  		if empty, the file name up to its first ``.`` is used
+	 *  @throws	std::logic_error if the number of namespaces
+	 *  		does not match the number of files
+	 *  @throws	std::runtime_error if any file cannot be opened,
+	 *  		or the namespaces are invalid or not unique
+	 */
+	void parseFiles( const std::vector< std::string > & files,
+			const std::vector< std::string > & namespaces
+				= std::vector< std::string >() );
+
+	/*! @brief Merge a parsed want-list under a namespace.
+	 *
+	 *  Adds the items, want-lists and errors of ``other``,
+	 *  placed under the namespace ``ns``.
+	 *  Boolean options given in any file apply to the combined trade;
+	 *  all files must agree on the priority scheme, if given.
+	 *
+	 *  @param[in]	other	the parsed want-list to merge
+	 *  @param[in]	ns	the namespace of ``other``; non-empty,
+	 *  		without whitespace, ``:`` or ``%``
+	 *  @throws	std::runtime_error if ``ns`` is invalid,
+	 *  		an item of ``other`` has already been merged under ``ns``,
+	 *  		or the priority schemes conflict
+	 */
+	void merge( const WantParser & other, const std::string & ns );
+
+	/*! @} */ // end of group
+
+	/************************
+	 * 	LINE INDEX	*
+	 ************************/
+
+	/*! @name Incremental re-parsing
+	 *
+	 *  Between preliminary runs of a trade only a few want-list lines
+	 *  change. Tokenizing the official-name and want-list lines
+	 *  dominates the parsing time; the line index keeps the tokens
+	 *  of every such line, keyed by a 64-bit hash of the line,
+	 *  so that only new or changed lines are tokenized again.
+	 *  The node and arc tables are then rebuilt from the tokens;
+	 *  errors and line numbers are reported exactly as in a full parse.
+	 *
+	 *  Example:
+	 *
+	 *  	WantParser want_parser;
+	 *  	want_parser.loadIndex("wants.idx");
+	 *  	want_parser.parseFile("wants.txt");
+	 *  	want_parser.saveIndex("wants.idx");
+	 */
+	/*! @{ */ // start of group
+
+	/*! @brief Statistics of the line index. */
+	struct IndexStats {
+		unsigned reused = 0;	/*!< lines whose tokens were found in the index */
+		unsigned tokenized = 0;	/*!< lines tokenized anew; new or changed */
+		unsigned dropped = 0;	/*!< indexed lines no longer present */
+		std::vector< std::string >
+			changed_items;	/*!< items with a new or changed want-list;
+					  *  only if an index was loaded */
+	};
+
+	/*! @brief Load the line index of a previous parse.
+	 *
+	 *  Enables the line index; to be called before parsing.
+	 *  A missing file, or one written by an incompatible version,
+	 *  leaves the index empty and every line is tokenized.
+	 *
+	 *  @param[in]	fn	the index file written by @ref saveIndex()
+	 *  @returns	``true`` if the index has been loaded
+	 *  @throws	std::runtime_error if the index file is corrupt
+	 */
+	bool loadIndex( const std::string & fn );
+
+	/*! @brief Reuse the line index of a previous parse in memory.
+	 *
+	 *  As @ref loadIndex(), but copies the index of ``previous``,
+	 *  e.g., when re-parsing a changed file within the same process.
+	 *  The index of ``previous`` is left as is,
+	 *  to be reused again should this parse fail.
+	 *  If ``previous`` has no index, only enables the line index.
+	 *
+	 *  @param[in]	previous	parser of the previous parse
+	 *  @returns	``true`` if the index of ``previous`` has been copied
+	 */
+	bool reuseIndex( const WantParser & previous );
+
+	/*! @brief Save the line index of this parse.
+	 *
+	 *  Only the lines of this parse are saved.
+	 *  The file is written to a temporary file and renamed into place.
+	 *
+	 *  @param[in]	fn	the index file to write
+	 *  @throws	std::logic_error if the index has not been enabled
+	 *  		through @ref loadIndex()
+	 *  @throws	std::runtime_error if the file cannot be written
+	 */
+	void saveIndex( const std::string & fn ) const ;
+
+	/*! @brief Statistics of the line index. */
+	IndexStats getIndexStats() const ;
+
 	/*! @} */ // end of group
 
 	/************************
@@ -237,6 +421,13 @@ public:
 	 */
 	void printErrors( std::ostream & os = std::cout ) const ;
 
+	/*! @brief Errors generated during parsing.
+	 *
+	 *  @returns	the error records, formatted on demand
+	 *  		through Diagnostics::format()
+	 */
+	const Diagnostics & getErrors() const ;
+
 	/*! @} */ // end of group
 
 	/********************************
@@ -421,6 +612,16 @@ public:
 	 */
 	unsigned getNumTradingUsers() const ;
 
+	/*! @brief Estimate the memory of the parsed data.
+	 *
+	 *  Adds the estimated bytes of the items (``node_map_``),
+	 *  the want-lists (``arc_map_``) and the line index
+	 *  to the report.
+	 *
+	 *  @param[out]	report	the memory report
+	 */
+	void memoryUsage( MemoryReport & report ) const ;
+
 	/*! @} */ // end of group
 
 private:
@@ -540,11 +741,72 @@ private:
 
 	/*! @brief Generated errors.
 	 *
-	 *  Holds a list of errors that were generated during
+	 *  Holds the errors that were generated during
 	 *  the want-list file parsing,
-	 *  including the number of the line that generated the error.
+	 *  including the line and column that generated each error.
+	 *  Messages are only formatted by @ref printErrors().
+	 */
+	Diagnostics errors_;
+
+	/*! @brief The line being parsed; to locate error columns. */
+	const std::string * line_ = nullptr;
+
+	/*! @brief Incomplete line.
+	 *
+	 *  Holds the trailing part of the data fed by @ref parseChunk()
+	 *  that has not been terminated by a newline yet.
+	 */
+	std::string partial_line_;
+
+	/*! @brief Temporaries of the current line.
+	 *
+	 *  Holds the tokens and the pending arcs of a line;
+	 *  rewound after each line and released by @ref parseEnd().
+	 */
+	Arena arena_;
+
+	/*! @brief Number of the last parsed line.
+	 *
+	 *  Reported along with any generated error;
+	 *  reset by @ref parseEnd().
+	 */
+	uint64_t line_n_ = 0;
+
+	/****************************************
+	 *	LINE INDEX			*
+	 ****************************************/
+
+	/*! @brief An indexed line.
+	 *
+	 *  The line and its kind are kept along with its tokens,
+	 *  so that a hash collision is told apart from a hit.
 	 */
-	std::list< std::string > errors_;
+	struct IndexedLine_ {
+		char kind;				/*!< as given to @ref tokenize_() */
+		std::string line;			/*!< the line as read */
+		std::vector< std::string > tokens;	/*!< its tokens */
+	};
+
+	/*! @brief Indexed lines by line hash.
+	 *
+	 *  @ref index_ holds the lines of this parse;
+	 *  @ref index_prev_ holds the lines loaded by @ref loadIndex()
+	 *  that have not been encountered yet.
+	 */
+	std::unordered_map< uint64_t, IndexedLine_ >
+		index_, index_prev_;
+
+	/*! @brief Whether lines are indexed; set by @ref loadIndex(). */
+	bool index_enabled_ = false;
+
+	/*! @brief Whether a previous index has been loaded. */
+	bool index_loaded_ = false;
+
+	/*! @brief Whether the last line has been tokenized anew. */
+	bool line_fresh_ = true;
+
+	/*! @brief Statistics of the line index. */
+	IndexStats index_stats_;
 
 	/****************************************
 	 *	INTERNAL DATA STRUCTURES	*
@@ -590,6 +852,9 @@ private:
 
 	} Arc_t_;
 
+	/*! @brief Tokens of a line, allocated from @ref arena_. */
+	typedef ArenaVector< ArenaString > Tokens_;
+
 	/*! @brief Map of graph nodes.
 	 *
 	 *  Map of all graph nodes. The node ID (item name)
@@ -625,11 +890,31 @@ private:
 	 *  3. Otherwise, calls the respective method:
 	 *  @ref parseOption_(), @ref parseOfficialName_(), or @ref parseWantList_().
 	 *
+	 *  Errors are recorded through @ref error_().
+	 *
 	 *  @param[in]	line	the entire line to parse
-	 *  @throws	std::runtime_error if the line fails to parse
 	 */
 	void parseLine_( const std::string & line );
 
+	/*! @brief Parse the next input line.
+	 *
+	 *  Increases @ref line_n_ and calls @ref parseLine_().
+	 *  Any error is added to @ref errors_ along with the line number.
+	 *
+	 *  @param[in]	line	the entire line to parse
+	 */
+	void parseNextLine_( const std::string & line );
+
+	/*! @brief Convert a gzip-compressed want-lists stream to graph.
+	 *
+	 *  As @ref parseStream(), but decompresses the stream
+	 *  block by block before feeding it to @ref parseChunk().
+	 *
+	 *  @param[in]	is	the compressed stream, opened in binary mode
+	 *  @throws	std::runtime_error if the stream is not valid gzip
+	 */
+	void parseGzipStream_( std::istream & is );
+
 	/*! @brief Parse want-file option.
 	 *
 	 *  Parses line containing want-file options. Multiple options may be present
@@ -644,9 +929,10 @@ private:
 	 *  * ``OPTION=VALUE-ABC-123``
 	 *
 	 *  @param[in]	line to parse, without the leading ``#!``
-	 *  @throws	std::runtime_error if an unsupported ``option`` is given
+	 *  @returns	``false`` if an unsupported ``option`` is given;
+	 *  		preceding options on the line have been applied
 	 */
-	void parseOption_( const std::string & option );
+	bool parseOption_( const std::string & option );
 
 	/*! @brief Parse official item name.
 	 *
@@ -655,10 +941,10 @@ private:
 	 * and passes them to @ref addSourceItem_().
 	 *
 	 *  @param[in]	line to parse
-	 *  @throws	std::runtime_error if the line fails to parse, e.g., bad format
-	 *  @throws	std::runtime_error if the item ID has been already parsed
+	 *  @returns	``false`` if the line fails to parse, e.g., bad format,
+	 *  		or the item ID has been already parsed
 	 */
-	void parseOfficialName_( const std::string & line );
+	bool parseOfficialName_( const std::string & line );
 
 	/*! @brief Parse entire want-list line.
 	 *
@@ -692,13 +978,12 @@ private:
 	 *  3. @ref addTargetItems_() to add the target items for the extracted source item
 	 *
 	 *  @param[in]	line	line to extract and parse the want-list from
-	 *  @throws	std::runtime_error if bad line format is detected
-	 *  @throws	std::runtime_error if the username is absent
-	 *  		but @ref REQUIRE_USERNAMES has been given.
-	 *  @throws	std::runtime_error if a colon after the source item is absent
+	 *  @returns	``false`` if bad line format is detected,
+	 *  		the username is absent but @ref REQUIRE_USERNAMES has been given,
+	 *  		or a colon after the source item is absent
 	 *  		but @ref REQUIRE_COLONS has been given.
 	 */
-	void parseWantList_( const std::string & line );
+	bool parseWantList_( const std::string & line );
 
 	/*! @brief Extract username from token.
 	 *
@@ -710,7 +995,7 @@ private:
 	 *  @param[in]	token	token to parse and extract username
 	 *  @returns	extracted username; empty if ``token`` does not have a valid format
 	 */
-	static std::string extractUsername_( const std::string & token );
+	static std::string extractUsername_( const ArenaString & token );
 
 	/*! @brief Add source (offered) item.
 	 *
@@ -720,11 +1005,11 @@ private:
 	 *  @param[in]	item	new source item to register
 	 *  @param[in]	official_name	official name of the item
 	 *  @param[in]	username	username of the item's owner
-	 *  @throws conditionally a std::runtime_error if the item
-	 *  has been already registered, except if we are currently reading
-	 *  the want lists and already have the official names.
+	 *  @returns	``false`` if the item has been already registered,
+	 *  		except if we are currently reading the want lists
+	 *  		and already have the official names.
 	 */
-	void addSourceItem_( const std::string & item,
+	bool addSourceItem_( const std::string & item,
 			const std::string & official_name,
 			const std::string & username );
 
@@ -744,16 +1029,16 @@ private:
 	 *  Example: dummy item ``%Puerto`` from user ``Aldie``
 	 *  with no case-sensitive items will become ``%PUERTO-(ALDIE)``.
 	 *
-	 *  @param	item	the item name to be converted
-	 *  @param	username	username to append to ``item``, if dummy
-	 *  @returns	converted item name
-	 *
-	 *  @throws std::runtime_error if a dummy item is given,
-	 *  but @ref ALLOW_DUMMIES in @ref bool_options_ is ``false``.
-	 *  @throws std::runtime_error if ``item`` is dummy, but the ``username`` is empty.
+	 *  @param[in]	item	the item name to be converted
+	 *  @param[in]	username	username to append to ``item``, if dummy
+	 *  @param[out]	target	converted item name
+	 *  @returns	``false`` if a dummy item is given,
+	 *  		but @ref ALLOW_DUMMIES in @ref bool_options_ is ``false``,
+	 *  		or if ``item`` is dummy, but the ``username`` is empty.
 	 */
-	std::string convertItemName_( const std::string & item,
-			const std::string username = std::string() ) const;
+	bool convertItemName_( const ArenaString & item,
+			const std::string & username,
+			std::string & target );
 
 	/*! @brief Add target (wanted) items.
 	 *
@@ -761,15 +1046,32 @@ private:
 	 *  The wanted items are registered if and only if no errors are generated.
 	 *
 	 *  @param[in]	source	the source (offered) item
-	 *  @param[in]	wanted_items	vector of target (wanted) items
+	 *  @param[in]	first	the first target (wanted) item token
+	 *  @param[in]	last	past the last target item token
 	 *
-	 *  @throws	std::runtime_error if ``source`` item has already a want-list
-	 *  @throws	std::runtime_error if bad line format is detected
-	 *  @throws std::runtime_error if a dummy target item is detected,
-	 *  but @ref ALLOW_DUMMIES in @ref bool_options_ is ``false``.
+	 *  @returns	``false`` if ``source`` item has already a want-list,
+	 *  		bad line format is detected,
+	 *  		or a dummy target item is detected,
+	 *  		but @ref ALLOW_DUMMIES in @ref bool_options_ is ``false``.
 	 */
-	void addTargetItems_( const std::string & source,
-			const std::vector< std::string > & wanted_items );
+	bool addTargetItems_( const std::string & source,
+			Tokens_::const_iterator first,
+			Tokens_::const_iterator last );
+
+	/*! @brief Record an error of the current line.
+	 *
+	 *  Parse errors of malformed lines are recorded, not thrown;
+	 *  the line is then skipped.
+	 *
+	 *  @param[in]	code	what went wrong
+	 *  @param[in]	item	the offending item, if any
+	 *  @param[in]	token	the offending token as given in the line,
+	 *  		to locate its column; ``item`` if not given
+	 *  @returns	``false``, to be returned by the caller
+	 */
+	bool error_( Diagnostic::Code code,
+			const std::string & item = std::string(),
+			const std::string & token = std::string() );
 
 
 	/****************************************
@@ -786,16 +1088,52 @@ private:
 	 */
 	static bool isDummy_( const std::string & item );
 
+	/*! @brief Place an item name under a namespace.
+	 *
+	 *  Example: ``0042-PUERTO`` is placed under ``GR`` as ``GR:0042-PUERTO``,
+	 *  while ``%PUERTO-(ALDIE)`` becomes ``%GR:PUERTO-(ALDIE)``,
+	 *  so that it remains dummy.
+	 *
+	 *  @param[in]	ns	the namespace
+	 *  @param[in]	item	the item name
+	 *  @returns	the namespaced item name
+	 */
+	static std::string applyNamespace_( const std::string & ns,
+			const std::string & item );
+
+	/*! @brief Tokenize line through the line index.
+	 *
+	 *  Looks up the line in the line index;
+	 *  calls @ref split_() only if not found,
+	 *  or if the indexed line of the same hash differs.
+	 *  Without an index, calls @ref split_() directly.
+	 *  Sets @ref line_fresh_.
+	 *
+	 *  @param[in]	line	line to tokenize
+	 *  @param[in]	kind	identifies ``regex``, e.g., ``'N'`` for official names
+	 *  @param[in]	regex	regular expression to use
+	 *  @returns	vector with individual tokens
+	 */
+	Tokens_ tokenize_(
+			const std::string & line,
+			char kind,
+			const std::regex & regex );
+
+	/*! @brief Stable 64-bit FNV-1a hash of a line and its kind. */
+	static uint64_t hashLine_( const std::string & line, char kind );
+
 	/*! @brief Tokenize line.
 	 *
 	 *  Tokenizes a line based on a given regular expression.
 	 *  @param[in]	input	line to tokenize
 	 *  @param[in]	regex	regular expression to use
+	 *  @param[in]	arena	arena of the tokens
 	 *  @returns	vector with individual tokens
 	 */
-	static std::vector< std::string > split_(
+	static Tokens_ split_(
 			const std::string & input,
-			const std::regex & regex );
+			const std::regex & regex,
+			Arena & arena );
 
 	/*! @brief Tokenize line.
 	 *
@@ -803,24 +1141,31 @@ private:
 	 *  Converts input string to regex and calls @ref split_().
 	 *  @param[in]	input	line to tokenize
 	 *  @param[in]	str	string to convert to regular experssion
+	 *  @param[in]	arena	arena of the tokens
 	 *  @returns	vector with individual tokens
 	 */
-	static std::vector< std::string > split_(
+	static Tokens_ split_(
 			const std::string & input,
-			const std::string & str );
+			const std::string & str,
+			Arena & arena );
 
 	/*! @brief Retrieve payload from URL.
 	 *
-	 *  Accepts a URL, downloads the data and returns the payload.
+	 *  Accepts a URL, downloads the data and passes the payload
+	 *  to ``sink`` piece by piece, as it is received.
+	 *  Advertises ``Accept-Encoding: gzip``;
+	 *  the payload is passed decompressed.
+	 *  Only a fixed-size receive buffer is allocated.
 	 *
 	 *  @param[in]	url	the URL to fetch the data from
-	 *  @param[out]	data	stores the retrieved payload; existing data is overwritten
-	 *  @throw	SocketException		if a socket error occurs
-	 *  @throw	std::runtime_error	if malformed data is received
-	 *  @throw	std::logic_error	if the receive buffer is too short
+	 *  @param[in]	client	HTTP client to retrieve the URL with
+	 *  @param[in]	sink	called with each received piece of the payload
+	 *  @throw	std::runtime_error	if the retrieval fails,
+	 *  				or the response code is not ``200``
 	 */
 	static void getUrl_( const std::string & url,
-			std::string & data );
+			HttpClient & client,
+			const HttpClient::Sink & sink );
 };
 
 #endif /* _WANTPARSER_HPP_ */
@@ -26,6 +26,10 @@
   #include <winsock.h>         // For socket(), connect(), send(), and recv()
   typedef int socklen_t;
   typedef char raw_type;       // Type used for raw data on this platform
+  #ifndef POLLIN
+    #define POLLIN  0x0001     // Events for waitFor(); mapped to select()
+    #define POLLOUT 0x0004
+  #endif
 #else
   #include <sys/types.h>       // For data types
   #include <sys/socket.h>      // For socket(), connect(), send(), and recv()
@@ -33,6 +37,8 @@
   #include <arpa/inet.h>       // For inet_addr()
   #include <unistd.h>          // For close()
   #include <netinet/in.h>      // For sockaddr_in
+  #include <fcntl.h>           // For fcntl()
+  #include <poll.h>            // For poll()
   typedef void raw_type;       // Type used for raw data on this platform
 #endif
 
@@ -201,7 +207,14 @@ void CommunicatingSocket::connect(const string &foreignAddress,
 
 void CommunicatingSocket::send(const void *buffer, int bufferLen)
     throw(SocketException) {
-  if (::send(sockDesc, (raw_type *) buffer, bufferLen, 0) < 0) {
+  // Do not raise SIGPIPE if the peer has closed the connection;
+  // report it as an exception instead.
+  #ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+  #else
+    const int flags = 0;
+  #endif
+  if (::send(sockDesc, (raw_type *) buffer, bufferLen, flags) < 0) {
     throw SocketException("Send failed (send())", true);
   }
 }
@@ -216,6 +229,130 @@ int CommunicatingSocket::recv(void *buffer, int bufferLen)
   return rtn;
 }
 
+// Wait until the descriptor is ready for the given events;
+// returns false if the time runs out
+static bool waitFor(int sockDesc, short events, int timeoutMs)
+    throw(SocketException) {
+  #ifdef WIN32
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(sockDesc, &set);
+    timeval tv = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+    int rtn = (events == POLLOUT) ?
+      select(sockDesc + 1, NULL, &set, NULL, &tv) :
+      select(sockDesc + 1, &set, NULL, NULL, &tv);
+  #else
+    pollfd pfd;
+    pfd.fd = sockDesc;
+    pfd.events = events;
+    pfd.revents = 0;
+    int rtn;
+    do {
+      rtn = ::poll(&pfd, 1, timeoutMs);
+    } while (rtn < 0 && errno == EINTR);
+  #endif
+  if (rtn < 0) {
+    throw SocketException("Wait failed (poll())", true);
+  }
+  return rtn > 0;
+}
+
+void CommunicatingSocket::connect(const string &foreignAddress,
+    unsigned short foreignPort, int timeoutMs) throw(SocketException) {
+  // Get the address of the requested host
+  sockaddr_in destAddr;
+  fillAddr(foreignAddress, foreignPort, destAddr);
+
+  // Start connecting without blocking
+  setBlocking(false);
+  if (::connect(sockDesc, (sockaddr *) &destAddr, sizeof(destAddr)) == 0) {
+    return;
+  }
+  if (errno != EINPROGRESS && errno != EWOULDBLOCK) {
+    throw SocketException("Connect failed (connect())", true);
+  }
+
+  // Wait for the outcome
+  if (!waitFor(sockDesc, POLLOUT, timeoutMs)) {
+    throw SocketException("Connect timed out (connect())");
+  }
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (getsockopt(sockDesc, SOL_SOCKET, SO_ERROR, (char *) &error, &len) < 0) {
+    throw SocketException("Connect failed (getsockopt())", true);
+  }
+  if (error != 0) {
+    errno = error;
+    throw SocketException("Connect failed (connect())", true);
+  }
+}
+
+void CommunicatingSocket::send(const void *buffer, int bufferLen,
+    int timeoutMs) throw(SocketException) {
+  #ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+  #else
+    const int flags = 0;
+  #endif
+  const char *data = (const char *) buffer;
+  while (bufferLen > 0) {
+    int rtn = ::send(sockDesc, (raw_type *) data, bufferLen, flags);
+    if (rtn < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        throw SocketException("Send failed (send())", true);
+      }
+      if (!waitFor(sockDesc, POLLOUT, timeoutMs)) {
+        throw SocketException("Send timed out (send())");
+      }
+      continue;
+    }
+    data += rtn;
+    bufferLen -= rtn;
+  }
+}
+
+int CommunicatingSocket::recv(void *buffer, int bufferLen, int timeoutMs)
+    throw(SocketException) {
+  for (;;) {
+    int rtn = ::recv(sockDesc, (raw_type *) buffer, bufferLen, 0);
+    if (rtn >= 0) {
+      return rtn;
+    }
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      throw SocketException("Received failed (recv())", true);
+    }
+    if (!waitFor(sockDesc, POLLIN, timeoutMs)) {
+      throw SocketException("Receive timed out (recv())");
+    }
+  }
+}
+
+void CommunicatingSocket::setBlocking(bool blocking) throw(SocketException) {
+  #ifdef WIN32
+    u_long mode = blocking ? 0 : 1;
+    if (ioctlsocket(sockDesc, FIONBIO, &mode) != 0) {
+      throw SocketException("Set blocking mode failed (ioctlsocket())", true);
+    }
+  #else
+    int flags = fcntl(sockDesc, F_GETFL, 0);
+    if (flags < 0) {
+      throw SocketException("Get blocking mode failed (fcntl())", true);
+    }
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    if (fcntl(sockDesc, F_SETFL, flags) < 0) {
+      throw SocketException("Set blocking mode failed (fcntl())", true);
+    }
+  #endif
+}
+
+void CommunicatingSocket::shutdown() {
+  #ifdef WIN32
+    ::shutdown(sockDesc, SD_BOTH);
+  #else
+    ::shutdown(sockDesc, SHUT_RDWR);
+  #endif
+}
+
 string CommunicatingSocket::getForeignAddress()
     throw(SocketException) {
   sockaddr_in addr;
@@ -174,6 +174,56 @@ public:
    */
   int recv(void *buffer, int bufferLen) throw(SocketException);
 
+  /**
+   *   Establish a socket connection within the given time.  The socket
+   *   is left in non-blocking mode; use the timed send() and recv().
+   *   @param foreignAddress foreign address (IP address or name)
+   *   @param foreignPort foreign port
+   *   @param timeoutMs maximum time to wait, in milliseconds
+   *   @exception SocketException thrown if unable to establish connection
+   *              or if the time runs out
+   */
+  void connect(const std::string &foreignAddress, unsigned short foreignPort,
+      int timeoutMs) throw(SocketException);
+
+  /**
+   *   Write the whole buffer, waiting at most timeoutMs milliseconds
+   *   each time the socket is not writable
+   *   @param buffer buffer to be written
+   *   @param bufferLen number of bytes from buffer to be written
+   *   @param timeoutMs maximum time to wait, in milliseconds
+   *   @exception SocketException thrown if unable to send data
+   *              or if the time runs out
+   */
+  void send(const void *buffer, int bufferLen, int timeoutMs)
+      throw(SocketException);
+
+  /**
+   *   Read into the given buffer up to bufferLen bytes, waiting at most
+   *   timeoutMs milliseconds for data to arrive
+   *   @param buffer buffer to receive the data
+   *   @param bufferLen maximum number of bytes to read into buffer
+   *   @param timeoutMs maximum time to wait, in milliseconds
+   *   @return number of bytes read, 0 for EOF
+   *   @exception SocketException thrown if unable to receive data
+   *              or if the time runs out
+   */
+  int recv(void *buffer, int bufferLen, int timeoutMs) throw(SocketException);
+
+  /**
+   *   Switch the socket between blocking and non-blocking mode
+   *   @param blocking true for blocking mode
+   *   @exception SocketException thrown if the mode cannot be changed
+   */
+  void setBlocking(bool blocking) throw(SocketException);
+
+  /**
+   *   Shut down both directions of the connection.  Any thread blocked
+   *   in recv() on this socket returns with EOF.  The descriptor is
+   *   still closed by the destructor.
+   */
+  void shutdown();
+
   /**
    *   Get the foreign address.  Call connect() before calling recv()
    *   @return foreign address
@@ -0,0 +1,125 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/arena.hpp>
+
+#include <algorithm>
+#include <new>
+
+
+/**************************************
+ * 	PUBLIC METHODS - CONSTRUCTION
+ **************************************/
+
+Arena::Arena( size_t block_size ) :
+	block_size_( std::max< size_t >( block_size, 64 ))
+{
+}
+
+Arena::Arena( const Arena & other ) :
+	block_size_( other.block_size_ )
+{
+}
+
+Arena &
+Arena::operator=( const Arena & other ) {
+
+	if ( this != &other ) {
+		this->release();
+		this->block_size_ = other.block_size_;
+	}
+	return *this;
+}
+
+Arena::~Arena() {
+	release();
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - BLOCKS
+ **************************************/
+
+void
+Arena::reset() {
+
+	if ( blocks_.empty() ) {
+		return;
+	}
+
+	/* The last block is the largest. */
+	const Block_t_ last = blocks_.back();
+	blocks_.pop_back();
+	release();
+	blocks_.push_back( last );
+	next_ = last.data;
+	end_ = last.data + last.size;
+}
+
+void
+Arena::release() {
+
+	for ( auto const & block : blocks_ ) {
+		::operator delete( block.data );
+	}
+	blocks_.clear();
+	next_ = end_ = nullptr;
+}
+
+uint64_t
+Arena::allocations() const {
+	return allocations_;
+}
+
+size_t
+Arena::blocks() const {
+	return blocks_.size();
+}
+
+size_t
+Arena::bytes() const {
+
+	size_t bytes = 0;
+	for ( auto const & block : blocks_ ) {
+		bytes += block.size;
+	}
+	return bytes;
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS
+ **************************************/
+
+void *
+Arena::grow_( size_t bytes, size_t alignment ) {
+
+	/* Double the last block; large requests get a block of their own size. */
+	size_t size = blocks_.empty() ? block_size_ : 2 * blocks_.back().size;
+	size = std::max( size, bytes + alignment );
+
+	blocks_.reserve( blocks_.size() + 1 );
+	char * const data = static_cast< char * >( ::operator new(size) );
+	blocks_.push_back( Block_t_{ data, size } );
+	end_ = data + size;
+
+	const uintptr_t aligned =
+		( reinterpret_cast< uintptr_t >(data) + alignment - 1 )
+		& ~( alignment - 1 );
+	next_ = reinterpret_cast< char * >( aligned + bytes );
+	return reinterpret_cast< void * >(aligned);
+}
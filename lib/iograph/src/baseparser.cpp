@@ -50,10 +50,10 @@ BaseParser::parse( std::istream & is ) {
 	std::string buffer;
 	buffer.reserve(BUFSIZE);
 
-	uint64_t line_n = 0;
+	_line_n = 0;
 	while (std::getline( is, buffer )) {
 
-		++ line_n;
+		++ _line_n;
 		/**
 		 * Parse line by content:
 		 * - Empty lines
@@ -101,12 +101,12 @@ BaseParser::parse( std::istream & is ) {
 		} catch ( const std::runtime_error & e ) {
 
 			/**
+			 * Unexpected failure;
+			 * malformed lines are recorded through _error().
 			 * Add the exception text to the error list.
 			 * Continue with the next line.
 			 */
-			this->_errors.push_back( std::to_string(line_n)
-					+ ":"
-					+ e.what() );
+			_errors.add( _line_n, 0, Diagnostic::MESSAGE, e.what() );
 		}
 	}
 
@@ -148,13 +148,26 @@ BaseParser::showErrors( std::ostream & os ) const {
 
 	if ( ! _errors.empty() ) {
 		os << "ERRORS" << std::endl;
-		for ( auto const & err : _errors ) {
-			os << "**** " << err << std::endl;
-		}
+		_errors.print( os, "**** " );
 	}
 	return *this;
 }
 
+const Diagnostics &
+BaseParser::getErrors() const {
+	return _errors;
+}
+
+
+/************************************//*
+ * 	PROTECTED METHODS
+ **************************************/
+
+void
+BaseParser::_error( Diagnostic::Code code, const std::string & item ) {
+	_errors.add( _line_n, 0, code, item );
+}
+
 
 /************************************//*
  * 	PROTECTED STATIC METHODS
@@ -0,0 +1,181 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/diagnostic.hpp>
+
+#include <stdexcept>
+
+/* Message of each code, as the text before and after the item. */
+static const struct {
+	const char * before;
+	const char * after;
+} MESSAGES[ Diagnostic::MAX_CODES ] = {
+	{ "Options can only be given at the beginning of the file", "" },
+	{ "Official names are already being given", "" },
+	{ "Official names have already been given", "" },
+	{ "Official names can only be declared before the want lists", "" },
+	{ "Unrecognized directive: ", "" },
+	{ "Value for integer option ", " not found" },
+	{ "Unknown integer option ", "" },
+	{ "Unknown option ", "" },
+	{ "Bad format of official name line", "" },
+	{ "Out of range when parsing username: ", "" },
+	{ "Dummy item ", " detected, but dummy items not allowed" },
+	{ "Dummy item ", " detected, but username  not defined" },
+	{ "Bad format of want list", "" },
+	{ "Missing username from want list", "" },
+	{ "Missing offered item from want list", "" },
+	{ "Missing colon from want list", "" },
+	{ "Non-dummy item ", " has no official name. Hint: spelling error?" },
+	{ "Existing entry for item ", "" },
+	{ "Ignoring multiple wantlist for item ", "" },
+	{ "Multiple want lists for item ", ". Hint: check if an item want-list line"
+		" has been split over two lines." },
+	{ "Invalid colon occurence.", "" },
+	{ "Bad format of want list: ", "" },
+	{ "", "" },
+};
+
+const uint32_t Diagnostic::NO_ITEM;
+
+
+/**************************************
+ * 	PUBLIC METHODS
+ **************************************/
+
+void
+Diagnostics::add( uint64_t line, size_t column, Diagnostic::Code code,
+		const std::string & item ) {
+
+	Diagnostic diagnostic;
+	diagnostic.line = static_cast< uint32_t >( line );
+	diagnostic.column = static_cast< uint32_t >( column );
+	diagnostic.code = code;
+	diagnostic.source = 0;
+	diagnostic.item = intern_( item );
+	records_.push_back( diagnostic );
+}
+
+void
+Diagnostics::merge( const Diagnostics & other, const std::string & prefix ) {
+
+	/* Prefixes of other, nested under prefix. */
+	std::vector< uint16_t > sources;
+	sources.reserve( other.prefixes_.size() );
+	for ( auto const & nested : other.prefixes_ ) {
+		if ( prefixes_.size() > UINT16_MAX ) {
+			throw std::runtime_error("Too many diagnostic prefixes");
+		}
+		sources.push_back( static_cast< uint16_t >( prefixes_.size() ));
+		prefixes_.push_back( nested.empty() ? prefix : prefix + ":" + nested );
+	}
+
+	records_.reserve( records_.size() + other.records_.size() );
+	for ( auto diagnostic : other.records_ ) {
+		diagnostic.source = sources[ diagnostic.source ];
+		diagnostic.item = intern_( other.item(diagnostic) );
+		records_.push_back( diagnostic );
+	}
+}
+
+void
+Diagnostics::clear() {
+	records_.clear();
+	items_.clear();
+	item_ids_.clear();
+	prefixes_.resize( 1 );
+}
+
+bool
+Diagnostics::empty() const {
+	return records_.empty();
+}
+
+size_t
+Diagnostics::size() const {
+	return records_.size();
+}
+
+const std::vector< Diagnostic > &
+Diagnostics::records() const {
+	return records_;
+}
+
+const std::string &
+Diagnostics::item( const Diagnostic & diagnostic ) const {
+
+	static const std::string none;
+	if ( diagnostic.item == Diagnostic::NO_ITEM ) {
+		return none;
+	}
+	return items_.at( diagnostic.item );
+}
+
+std::string
+Diagnostics::format( const Diagnostic & diagnostic ) const {
+
+	if ( diagnostic.code >= Diagnostic::MAX_CODES ) {
+		throw std::logic_error("Unknown diagnostic code "
+				+ std::to_string( diagnostic.code ));
+	}
+	auto const & message = MESSAGES[ diagnostic.code ];
+
+	std::string text;
+	auto const & prefix = prefixes_.at( diagnostic.source );
+	if ( !prefix.empty() ) {
+		text.append( prefix );
+		text.push_back(':');
+	}
+	text.append( std::to_string( diagnostic.line ));
+	text.push_back(':');
+	if ( diagnostic.column > 0 ) {
+		text.append( std::to_string( diagnostic.column ));
+		text.push_back(':');
+	}
+	text.append( message.before );
+	text.append( item(diagnostic) );
+	text.append( message.after );
+	return text;
+}
+
+void
+Diagnostics::print( std::ostream & os, const std::string & lead ) const {
+
+	for ( auto const & diagnostic : records_ ) {
+		os << lead << format( diagnostic ) << std::endl;
+	}
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS
+ **************************************/
+
+uint32_t
+Diagnostics::intern_( const std::string & item ) {
+
+	if ( item.empty() ) {
+		return Diagnostic::NO_ITEM;
+	}
+
+	auto const pair = item_ids_.emplace( item,
+			static_cast< uint32_t >( items_.size() ));
+	if ( pair.second ) {
+		items_.push_back( item );
+	}
+	return pair.first->second;
+}
@@ -0,0 +1,178 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/filewatcher.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <sys/stat.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+/**************************************
+ * 	PUBLIC METHODS - CONSTRUCTORS
+ **************************************/
+
+FileWatcher::FileWatcher( const std::string & fn, int debounce_ms ) :
+	fn_( fn ),
+	debounce_ms_( debounce_ms ),
+	events_( [this]( int timeout_ms ) { return next_( timeout_ms ); } ),
+	now_( &Clock::now )
+{
+	/* Watch the directory, so that editors replacing the file
+	 * through a rename are detected too. */
+	const size_t slash = fn_.find_last_of('/');
+	const std::string dir = ( slash == std::string::npos ) ? "." :
+		( slash == 0 ) ? "/" : fn_.substr(0, slash);
+	name_ = ( slash == std::string::npos ) ? fn_ : fn_.substr(slash + 1);
+
+	#ifdef __linux__
+	fd_ = ::inotify_init1( IN_CLOEXEC | IN_NONBLOCK );
+	if ( fd_ < 0 ) {
+		throw std::runtime_error("Failed to initialize inotify");
+	}
+	if ( ::inotify_add_watch( fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO ) < 0 ) {
+		::close( fd_ );
+		throw std::runtime_error("Failed to watch directory " + dir);
+	}
+	#else
+	stamp_ = readStamp_();
+	#endif
+}
+
+FileWatcher::FileWatcher( Events events, Now now, int debounce_ms ) :
+	debounce_ms_( debounce_ms ),
+	events_( std::move(events) ),
+	now_( std::move(now) )
+{
+}
+
+FileWatcher::~FileWatcher() {
+	#ifdef __linux__
+	if ( fd_ >= 0 ) {
+		::close( fd_ );
+	}
+	#endif
+}
+
+const std::string &
+FileWatcher::file() const {
+	return fn_;
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - WAITING
+ **************************************/
+
+bool
+FileWatcher::wait( Clock::time_point & changed, int timeout_ms ) {
+
+	if ( !events_( timeout_ms ) ) {
+		return false;
+	}
+	changed = now_();
+
+	/* Debounce: wait until quiet. */
+	while ( events_( debounce_ms_ ) ) {
+		changed = now_();
+	}
+	return true;
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS - WAITING
+ **************************************/
+
+bool
+FileWatcher::next_( int timeout_ms ) {
+
+	const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+
+	#ifdef __linux__
+	/* Room for a few events with long names. */
+	alignas(struct inotify_event) char buffer[16 * (sizeof(struct inotify_event) + 256)];
+
+	for ( ;; ) {
+		int wait_ms = -1;
+		if ( timeout_ms >= 0 ) {
+			wait_ms = std::max< int >( 0, std::chrono::duration_cast<
+					std::chrono::milliseconds >( deadline - Clock::now() ).count() );
+		}
+
+		struct pollfd pfd = { fd_, POLLIN, 0 };
+		const int rtn = ::poll( &pfd, 1, wait_ms );
+		if ( rtn < 0 ) {
+			if ( errno == EINTR ) {
+				return false;
+			}
+			throw std::runtime_error("Failed to wait for changes of " + fn_);
+		} else if ( rtn == 0 ) {
+			return false;
+		}
+
+		/* Drain the events; look for the watched file. */
+		bool found = false;
+		ssize_t n;
+		while (( n = ::read( fd_, buffer, sizeof(buffer) )) > 0 ) {
+			for ( char * p = buffer; p < buffer + n; ) {
+				auto const event = reinterpret_cast< struct inotify_event * >(p);
+				if (( event->len > 0 ) && ( name_ == event->name )) {
+					found = true;
+				}
+				p += sizeof(struct inotify_event) + event->len;
+			}
+		}
+		if ( found ) {
+			return true;
+		}
+	}
+	#else
+	/* Poll the modification time. */
+	const auto period = std::chrono::milliseconds( std::max(10, debounce_ms_ / 4) );
+	for ( ;; ) {
+		const std::string stamp = readStamp_();
+		if ( stamp != stamp_ ) {
+			stamp_ = stamp;
+			return true;
+		}
+		if (( timeout_ms >= 0 ) && ( Clock::now() >= deadline )) {
+			return false;
+		}
+		std::this_thread::sleep_for( period );
+	}
+	#endif
+}
+
+std::string
+FileWatcher::readStamp_() const {
+
+	struct stat st;
+	if ( ::stat( fn_.c_str(), &st ) != 0 ) {
+		return "";
+	}
+	return std::to_string( st.st_mtime ) + ":" + std::to_string( st.st_size );
+}
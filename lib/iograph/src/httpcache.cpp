@@ -0,0 +1,262 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/httpcache.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#ifdef WIN32
+#include <direct.h>
+#endif
+
+
+/**************************************
+ * 	PUBLIC METHODS - CONSTRUCTORS
+ **************************************/
+
+HttpCache::HttpCache( const std::string & directory ) :
+	directory_( directory )
+{
+	#ifdef WIN32
+	const int rtn = ::_mkdir( directory_.c_str() );
+	#else
+	const int rtn = ::mkdir( directory_.c_str(), 0755 );
+	#endif
+	if (( rtn != 0 ) && ( errno != EEXIST )) {
+		throw std::runtime_error("Failed to create cache directory "
+				+ directory_);
+	}
+}
+
+HttpCache::~HttpCache() {
+	abort();
+}
+
+const std::string &
+HttpCache::directory() const {
+	return directory_;
+}
+
+const HttpCache::Stats &
+HttpCache::stats() const {
+	return stats_;
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - LOOKUP
+ **************************************/
+
+bool
+HttpCache::lookup( const std::string & url, Entry & entry ) const {
+
+	const std::string path = path_(url);
+
+	/* Metadata: one "key value" pair per line. */
+	std::ifstream meta( path + ".meta" );
+	if ( !meta ) {
+		return false;
+	}
+
+	entry = Entry();
+	bool has_length = false;
+	std::string line;
+	while ( std::getline(meta, line) ) {
+		const size_t space = line.find(' ');
+		const std::string key = line.substr(0, space);
+		const std::string value = ( space == std::string::npos ) ?
+			"" : line.substr(space + 1);
+		if ( key == "url" ) {
+			entry.url = value;
+		} else if ( key == "etag" ) {
+			entry.etag = value;
+		} else if ( key == "last-modified" ) {
+			entry.last_modified = value;
+		} else if ( key == "length" ) {
+			entry.length = std::stoull(value);
+			has_length = true;
+		}
+	}
+
+	/* Guard against hash collisions and incomplete payloads. */
+	if (( entry.url != url ) || !has_length ) {
+		return false;
+	}
+	struct stat st;
+	if (( ::stat( (path + ".body").c_str(), &st ) != 0 )
+			|| ( static_cast< uint64_t >(st.st_size) != entry.length )) {
+		return false;
+	}
+	return true;
+}
+
+std::map< std::string, std::string >
+HttpCache::validators( const std::string & url ) {
+
+	++ stats_.requests;
+
+	std::map< std::string, std::string > headers;
+	Entry entry;
+	if ( lookup(url, entry) ) {
+		if ( !entry.etag.empty() ) {
+			headers["If-None-Match"] = entry.etag;
+		}
+		if ( !entry.last_modified.empty() ) {
+			headers["If-Modified-Since"] = entry.last_modified;
+		}
+	}
+	return headers;
+}
+
+uint64_t
+HttpCache::replay( const std::string & url,
+		const std::function< void(const char *, size_t) > & sink ) {
+
+	Entry entry;
+	std::ifstream body;
+	if ( lookup(url, entry) ) {
+		body.open( path_(url) + ".body", std::ios::binary );
+	}
+	if ( !body ) {
+		throw std::runtime_error("Received 'Not Modified' for "
+				+ url + "; no cached copy");
+	}
+
+	const size_t BUFSIZE = (1 << 16);
+	auto buffer = std::make_unique< char[] >(BUFSIZE);
+	uint64_t length = 0;
+	while ( body ) {
+		body.read( buffer.get(), BUFSIZE );
+		if ( body.gcount() > 0 ) {
+			if ( sink ) {
+				sink( buffer.get(), body.gcount() );
+			}
+			length += body.gcount();
+		}
+	}
+
+	++ stats_.hits;
+	stats_.bytes_reused += length;
+	return length;
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - STORAGE
+ **************************************/
+
+void
+HttpCache::begin( const std::string & url ) {
+
+	abort();
+	pending_url_ = url;
+	pending_.open( path_(url) + ".body.tmp",
+			std::ios::binary | std::ios::trunc );
+}
+
+void
+HttpCache::append( const char * data, size_t length ) {
+	pending_.write( data, length );
+}
+
+void
+HttpCache::commit( const std::map< std::string, std::string > & headers,
+		uint64_t length ) {
+
+	++ stats_.misses;
+	stats_.bytes_downloaded += length;
+
+	const std::string url = pending_url_;
+	const std::string path = path_(url);
+	const bool ok = pending_.is_open() && pending_.good();
+	pending_.close();
+	pending_url_.clear();
+
+	auto const etag = headers.find("etag");
+	auto const last_modified = headers.find("last-modified");
+	if ( !ok || (( etag == headers.end() )
+				&& ( last_modified == headers.end() ))) {
+		std::remove( (path + ".body.tmp").c_str() );
+		return;
+	}
+
+	/* Metadata; written after the payload is in place. */
+	bool stored = false;
+	{
+		std::ofstream meta( path + ".meta.tmp", std::ios::trunc );
+		meta << "url " << url << std::endl;
+		if ( etag != headers.end() ) {
+			meta << "etag " << etag->second << std::endl;
+		}
+		if ( last_modified != headers.end() ) {
+			meta << "last-modified " << last_modified->second << std::endl;
+		}
+		meta << "length " << length << std::endl;
+		stored = !meta.fail();
+	}
+
+	stored = stored
+		&& ( std::rename( (path + ".body.tmp").c_str(), (path + ".body").c_str() ) == 0 )
+		&& ( std::rename( (path + ".meta.tmp").c_str(), (path + ".meta").c_str() ) == 0 );
+	if ( !stored ) {
+		std::remove( (path + ".body.tmp").c_str() );
+		std::remove( (path + ".meta.tmp").c_str() );
+		throw std::runtime_error("Failed to store "
+				+ url + " in " + directory_);
+	}
+	++ stats_.stores;
+}
+
+void
+HttpCache::abort() {
+
+	if ( pending_url_.empty() ) {
+		return;
+	}
+	if ( pending_.is_open() ) {
+		pending_.close();
+	}
+	std::remove( (path_(pending_url_) + ".body.tmp").c_str() );
+	pending_url_.clear();
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS - UTILS
+ **************************************/
+
+std::string
+HttpCache::path_( const std::string & url ) const {
+
+	/* 64-bit FNV-1a hash of the URL. */
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for ( const unsigned char c : url ) {
+		hash ^= c;
+		hash *= 0x100000001b3ULL;
+	}
+
+	std::stringstream ss;
+	ss << directory_ << "/"
+		<< std::hex << std::setw(16) << std::setfill('0') << hash;
+	return ss.str();
+}
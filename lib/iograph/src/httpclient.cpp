@@ -0,0 +1,491 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/httpclient.hpp>
+#include <iograph/httpcache.hpp>
+#include <iograph/inflater.hpp>
+#include <iograph/trace.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include "PracticalSocket.hpp"
+
+
+/**************************************
+ * 	CONNECTIONS
+ **************************************/
+
+/* Open connection and its receive buffer.
+ * Data in [begin, end) has been received but not consumed yet. */
+struct HttpClient::Connection_ {
+
+	static const size_t BUFSIZE = (1 << 16);
+
+	socket_utils::TCPSocket sock;
+	std::unique_ptr< char[] > buffer;
+	size_t begin = 0;
+	size_t end = 0;
+	int timeout_ms;
+	bool keep_alive = true;
+
+	Connection_( const std::string & host, unsigned short port, int timeout ) :
+		buffer( new char[BUFSIZE] ),
+		timeout_ms( timeout )
+	{
+		sock.connect( host, port, timeout_ms );
+	}
+
+	size_t available() const {
+		return end - begin;
+	}
+
+	/* Receive more data; returns false on end of stream. */
+	bool fill() {
+
+		/* Move unconsumed data to the front. */
+		if ( begin == end ) {
+			begin = end = 0;
+		} else if ( end == BUFSIZE ) {
+			std::memmove( buffer.get(), buffer.get() + begin, end - begin );
+			end -= begin;
+			begin = 0;
+		}
+		if ( end == BUFSIZE ) {
+			throw std::runtime_error("Malformed HTTP "
+					"response; header line is too long");
+		}
+
+		const int n = sock.recv( buffer.get() + end, BUFSIZE - end, timeout_ms );
+		end += n;
+		return ( n > 0 );
+	}
+
+	/* Read a line, without the line terminator. */
+	std::string line() {
+
+		for (;;) {
+			const char * first = buffer.get() + begin;
+			const char * eol = static_cast< const char * >(
+					std::memchr( first, '\n', available() ));
+			if ( eol != NULL ) {
+				std::string result( first, eol );
+				if ( !result.empty() && ( result.back() == '\r' ) ) {
+					result.pop_back();
+				}
+				begin += ( eol - first ) + 1;
+				return result;
+			}
+			if ( !fill() ) {
+				throw std::runtime_error("Connection closed "
+						"before the end of the HTTP header");
+			}
+		}
+	}
+
+	/* Pass the next length bytes to the sink. */
+	uint64_t pass( uint64_t length, const Sink & sink ) {
+
+		const uint64_t total = length;
+		while ( length > 0 ) {
+			if (( available() == 0 ) && !fill() ) {
+				throw std::runtime_error("Expected payload of "
+						+ std::to_string(total)
+						+ " bytes; received "
+						+ std::to_string(total - length)
+						+ " bytes");
+			}
+			const size_t n = static_cast< size_t >(
+					std::min< uint64_t >( length, available() ));
+			if ( sink ) {
+				sink( buffer.get() + begin, n );
+			}
+			begin += n;
+			length -= n;
+		}
+		return total;
+	}
+};
+
+
+/**************************************
+ * 	PUBLIC METHODS - CONSTRUCTORS
+ **************************************/
+
+HttpClient::HttpClient( int timeout_ms ) :
+	timeout_ms_( timeout_ms )
+{
+}
+
+HttpClient::~HttpClient() = default;
+
+
+/**************************************
+ * 	PUBLIC METHODS - RETRIEVAL
+ **************************************/
+
+HttpClient::Response
+HttpClient::get( const std::string & url,
+		const Sink & sink,
+		const std::map< std::string, std::string > & headers ) {
+
+	const Url_ u = parseUrl_( url );
+	const std::string key = u.host + ":" + std::to_string(u.port);
+
+	/* Make the request conditional on any cached copy. */
+	std::map< std::string, std::string > fields = headers;
+	Sink deliver = sink;
+	if ( cache_ ) {
+		for ( auto const & field : cache_->validators( url ) ) {
+			fields.insert( field );
+		}
+	}
+
+	/* A payload being stored is discarded unless committed,
+	 * whichever way this method is left. */
+	HttpCache::Guard guard( cache_ );
+
+	/* Craft request. */
+	std::string request = "GET " + u.target + " HTTP/1.1\r\n"
+		+ "Host: " + u.authority + "\r\n";
+	for ( auto const & field : fields ) {
+		request += field.first + ": " + field.second + "\r\n";
+	}
+	request += "\r\n";
+
+	Response response;
+	std::unique_ptr< Connection_ > connection;
+
+	try {
+		/* An idle connection may have been closed by the server meanwhile;
+		 * if nothing is received over it, retry once over a new one. */
+		for ( bool retry = true; ; retry = false ) {
+
+			auto const it = idle_.find( key );
+			response.reused = ( it != idle_.end() );
+			if ( response.reused ) {
+				connection = std::move( it->second );
+				connection->timeout_ms = timeout_ms_;
+				idle_.erase( it );
+			} else {
+				connection.reset( new Connection_( u.host, u.port, timeout_ms_ ) );
+				++ connections_;
+			}
+
+			try {
+				connection->sock.send( request.data(), request.length(), timeout_ms_ );
+				if (( connection->available() == 0 ) && !connection->fill() ) {
+					throw std::runtime_error("No data received");
+				}
+			} catch ( const std::exception & ) {
+				if ( response.reused && retry ) {
+					continue;
+				}
+				throw;
+			}
+			break;
+		}
+
+		readHeader_( *connection, response );
+
+		/* Deliver the payload of successful responses only;
+		 * store it as it arrives if it is a full 200 payload. */
+		const bool success = ( response.status >= 200 )
+			&& ( response.status < 300 );
+		const bool store = cache_ && ( response.status == 200 );
+		if ( store ) {
+			cache_->begin( url );
+			deliver = [this, &sink]( const char * data, size_t length ) {
+				cache_->append( data, length );
+				if ( sink ) {
+					sink( data, length );
+				}
+			};
+		}
+		Sink body = success ? deliver : Sink();
+
+		/* Decompress a gzip payload as it arrives. */
+		std::unique_ptr< Inflater > inflater;
+		auto const encoding = response.headers.find("content-encoding");
+		if ( success && ( encoding != response.headers.end() )
+				&& ( encoding->second != "identity" )) {
+			if (( encoding->second != "gzip" ) && ( encoding->second != "x-gzip" )) {
+				throw std::runtime_error("Unsupported content encoding: "
+						+ encoding->second);
+			}
+			inflater.reset( new Inflater() );
+			body = [&inflater, &deliver]( const char * data, size_t length ) {
+				inflater->feed( data, length, deliver );
+			};
+		}
+
+		if ( readBody_( *connection, response, body ) ) {
+			idle_[key] = std::move( connection );
+		}
+		response.transferred = response.length;
+		if ( inflater ) {
+			inflater->finish();
+			response.length = inflater->produced();
+		}
+
+		/* Replay the cached copy if not modified. */
+		if ( cache_ ) {
+			if ( response.status == 304 ) {
+				response.length = cache_->replay( url, sink );
+				response.status = 200;
+				response.reason = "OK";
+				response.cached = true;
+			} else if ( store ) {
+				cache_->commit( response.headers, response.length );
+			}
+		}
+
+	} catch ( const socket_utils::SocketException & error ) {
+		throw std::runtime_error("Socket Exception: "
+				+ std::string(error.what()));
+	}
+
+	return response;
+}
+
+std::vector< HttpClient::Response >
+HttpClient::getAll( const std::vector< std::string > & urls,
+		const std::vector< Sink > & sinks,
+		int timeout_ms ) {
+
+	if ( urls.size() != sinks.size() ) {
+		throw std::logic_error("Expected one sink per URL");
+	}
+
+	std::vector< Response > responses( urls.size() );
+	std::vector< std::exception_ptr > errors( urls.size() );
+	std::vector< std::thread > threads;
+	threads.reserve( urls.size() );
+
+	for ( size_t i = 0; i < urls.size(); ++ i ) {
+		threads.emplace_back( [&, i]() {
+			TraceZone zone("fetch", "iograph");
+			try {
+				HttpClient client( timeout_ms );
+				responses[i] = client.get( urls[i], sinks[i] );
+			} catch ( ... ) {
+				errors[i] = std::current_exception();
+			}
+		});
+	}
+	for ( auto & thread : threads ) {
+		thread.join();
+	}
+
+	for ( auto const & error : errors ) {
+		if ( error ) {
+			std::rethrow_exception( error );
+		}
+	}
+	return responses;
+}
+
+int
+HttpClient::timeout() const {
+	return timeout_ms_;
+}
+
+void
+HttpClient::setTimeout( int timeout_ms ) {
+	timeout_ms_ = timeout_ms;
+}
+
+unsigned
+HttpClient::connections() const {
+	return connections_;
+}
+
+void
+HttpClient::setCache( HttpCache * cache ) {
+	cache_ = cache;
+}
+
+
+/************************************************
+ * 	STATIC PRIVATE METHODS - PROTOCOL	*
+ ************************************************/
+
+HttpClient::Url_
+HttpClient::parseUrl_( const std::string & url ) {
+
+	/* Sanity check: url beginning with 'http://' */
+	if ( url.compare(0,7,"http://") != 0 ) {
+		throw std::runtime_error("Provided url "
+				"is not HTTP; "
+				"expected url beginning "
+				"with 'http://'");
+	}
+
+	Url_ u;
+	const size_t path_pos = url.find("/",7);
+	u.authority = url.substr(7, path_pos - 7);
+	u.target = ( path_pos == std::string::npos ) ?
+		"/" : url.substr(path_pos);
+
+	/* Split an optional port from the host name. */
+	u.host = u.authority;
+	u.port = 80;
+	const size_t colon = u.authority.rfind(':');
+	if ( colon != std::string::npos ) {
+		u.host = u.authority.substr(0, colon);
+		const std::string digits = u.authority.substr(colon + 1);
+		if ( digits.empty()
+				|| ( digits.find_first_not_of("0123456789") != std::string::npos )
+				|| ( digits.length() > 5 )
+				|| ( std::stoul(digits) > 65535 )) {
+			throw std::runtime_error("Invalid port in url: "
+					+ u.authority);
+		}
+		u.port = static_cast< unsigned short >( std::stoul(digits) );
+	}
+	if ( u.host.empty() ) {
+		throw std::runtime_error("No host in url: "
+				+ url);
+	}
+	return u;
+}
+
+void
+HttpClient::readHeader_( Connection_ & connection,
+		Response & response ) {
+
+	do {
+		/* Status line, e.g., "HTTP/1.1 200 OK". */
+		const std::string status = connection.line();
+		if (( status.compare(0, 5, "HTTP/") != 0 )
+				|| ( status.length() < 12 )
+				|| ( status[8] != ' ' )
+				|| !std::isdigit( status[9] )
+				|| !std::isdigit( status[10] )
+				|| !std::isdigit( status[11] )) {
+			throw std::runtime_error("Malformed HTTP "
+					"status line: " + status);
+		}
+		const bool http10 = ( status.compare(5, 3, "1.0") == 0 );
+		response.status = std::stoi( status.substr(9, 3) );
+		response.reason = ( status.length() > 13 ) ? status.substr(13) : "";
+
+		/* Header fields, until an empty line. */
+		response.headers.clear();
+		for ( std::string line = connection.line(); !line.empty();
+				line = connection.line() ) {
+			const size_t colon = line.find(':');
+			if ( colon == std::string::npos ) {
+				throw std::runtime_error("Malformed HTTP "
+						"header field: " + line);
+			}
+			std::string name = line.substr(0, colon);
+			std::transform( name.begin(), name.end(), name.begin(), ::tolower );
+			const size_t value = line.find_first_not_of(" \t", colon + 1);
+			const size_t value_end = line.find_last_not_of(" \t");
+			response.headers[name] = ( value == std::string::npos ) ?
+				"" : line.substr(value, value_end - value + 1);
+		}
+
+		/* HTTP/1.1 connections persist by default; HTTP/1.0 ones do not. */
+		std::string connection_field;
+		auto const it = response.headers.find("connection");
+		if ( it != response.headers.end() ) {
+			connection_field = it->second;
+			std::transform( connection_field.begin(), connection_field.end(),
+					connection_field.begin(), ::tolower );
+		}
+		connection.keep_alive = http10 ?
+			( connection_field == "keep-alive" ) :
+			( connection_field != "close" );
+
+	} while (( response.status >= 100 ) && ( response.status < 200 ));
+}
+
+bool
+HttpClient::readBody_( Connection_ & connection,
+		Response & response,
+		const Sink & sink ) {
+
+	response.length = 0;
+
+	/* Responses without payload. */
+	if (( response.status == 204 ) || ( response.status == 304 )) {
+		return connection.keep_alive;
+	}
+
+	/* Chunked payload: size line, data, CRLF; ends with a zero size. */
+	auto const te = response.headers.find("transfer-encoding");
+	if (( te != response.headers.end() )
+			&& ( te->second.find("chunked") != std::string::npos )) {
+
+		for (;;) {
+			const std::string size_line = connection.line();
+			const std::string size = size_line.substr(0, size_line.find(';'));
+			if ( size.empty()
+					|| ( size.find_first_not_of("0123456789abcdefABCDEF \t")
+						!= std::string::npos )) {
+				throw std::runtime_error("Malformed HTTP "
+						"chunk size: " + size_line);
+			}
+			const uint64_t length = std::stoull( size, nullptr, 16 );
+			if ( length == 0 ) {
+				break;
+			}
+			response.length += connection.pass( length, sink );
+			if ( !connection.line().empty() ) {
+				throw std::runtime_error("Malformed HTTP "
+						"chunk; expected line end");
+			}
+		}
+
+		/* Trailer fields, until an empty line. */
+		while ( !connection.line().empty() ) {
+		}
+		return connection.keep_alive;
+	}
+
+	/* Payload of known length. */
+	auto const cl = response.headers.find("content-length");
+	if ( cl != response.headers.end() ) {
+		if ( cl->second.empty()
+				|| ( cl->second.find_first_not_of("0123456789")
+					!= std::string::npos )) {
+			throw std::runtime_error("Malformed HTTP "
+					"header; invalid 'Content-Length': "
+					+ cl->second);
+		}
+		response.length = connection.pass( std::stoull(cl->second), sink );
+		return connection.keep_alive;
+	}
+
+	/* Otherwise, the payload ends when the connection closes. */
+	do {
+		const size_t n = connection.available();
+		if (( n > 0 ) && sink ) {
+			sink( connection.buffer.get() + connection.begin, n );
+		}
+		connection.begin += n;
+		response.length += n;
+	} while ( connection.fill() );
+
+	return false;
+}
@@ -0,0 +1,249 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/inflater.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <stdexcept>
+
+#include <zlib.h>
+
+
+/**************************************
+ * 	ZLIB STATE
+ **************************************/
+
+struct Inflater::State_ {
+
+	static const size_t BUFSIZE = (1 << 16);
+
+	z_stream strm;
+
+	/* A gzip member has been started but not finished. */
+	bool in_member = false;
+
+	/* A member has been finished; the next byte starts a new one. */
+	bool member_ended = false;
+
+	/* The output buffer was filled;
+	 * zlib may hold more output without any further input. */
+	bool pending = false;
+
+	uint64_t consumed = 0;
+	uint64_t produced = 0;
+
+	/* Output buffer of feed(). */
+	std::unique_ptr< char[] > buffer;
+};
+
+
+/**************************************
+ * 	PUBLIC METHODS - CONSTRUCTORS
+ **************************************/
+
+Inflater::Inflater() :
+	state_( new State_() )
+{
+	z_stream & strm = state_->strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	strm.next_in = Z_NULL;
+	strm.avail_in = 0;
+
+	/* 15 bits of window; +16 for the gzip wrapper only. */
+	if ( inflateInit2( &strm, 15 + 16 ) != Z_OK ) {
+		throw std::runtime_error("Failed to initialize zlib");
+	}
+}
+
+Inflater::~Inflater() {
+	inflateEnd( &state_->strm );
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - DETECTION
+ **************************************/
+
+bool
+Inflater::isGzip( const char * data, size_t length ) {
+	return ( length >= 2 )
+		&& ( static_cast< unsigned char >(data[0]) == 0x1f )
+		&& ( static_cast< unsigned char >(data[1]) == 0x8b );
+}
+
+bool
+Inflater::isGzipFile( const std::string & fn ) {
+
+	std::ifstream ifs( fn, std::ios::in | std::ios::binary );
+	char magic[2];
+	ifs.read( magic, sizeof(magic) );
+	return isGzip( magic, ifs.gcount() );
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - DECOMPRESSION
+ **************************************/
+
+void
+Inflater::feed( const char * data, size_t length, const Sink & sink ) {
+
+	if ( !state_->buffer ) {
+		state_->buffer.reset( new char[State_::BUFSIZE] );
+	}
+	char * const out = state_->buffer.get();
+
+	/* Repeat until the input is consumed
+	 * and no output is pending. */
+	while (( length > 0 ) || state_->pending ) {
+		const size_t n = this->inflate( data, length, out, State_::BUFSIZE );
+		if ( n == 0 ) {
+			break;
+		}
+		if ( sink ) {
+			sink( out, n );
+		}
+	}
+}
+
+size_t
+Inflater::inflate( const char * & data, size_t & length,
+		char * out, size_t capacity ) {
+
+	State_ & s = *state_;
+	z_stream & strm = s.strm;
+	size_t n = 0;
+
+	while (( n < capacity ) && (( length > 0 ) || s.pending )) {
+
+		/* Concatenated members; start over with the next one. */
+		if ( s.member_ended ) {
+			if ( length == 0 ) {
+				break;
+			}
+			inflateReset( &strm );
+			s.member_ended = false;
+		}
+
+		const uInt avail_in = static_cast< uInt >(
+				std::min< size_t >( length, UINT_MAX ));
+		const uInt avail_out = static_cast< uInt >(
+				std::min< size_t >( capacity - n, UINT_MAX ));
+		strm.next_in = reinterpret_cast< Bytef * >( const_cast< char * >(data) );
+		strm.avail_in = avail_in;
+		strm.next_out = reinterpret_cast< Bytef * >( out + n );
+		strm.avail_out = avail_out;
+
+		const int rtn = ::inflate( &strm, Z_NO_FLUSH );
+
+		const size_t used = avail_in - strm.avail_in;
+		const size_t made = avail_out - strm.avail_out;
+		data += used;
+		length -= used;
+		n += made;
+		s.consumed += used;
+		s.produced += made;
+		s.pending = ( strm.avail_out == 0 );
+
+		if ( rtn == Z_STREAM_END ) {
+			s.in_member = false;
+			s.member_ended = true;
+			s.pending = false;
+		} else if ( rtn == Z_OK ) {
+			s.in_member = true;
+		} else if ( rtn == Z_BUF_ERROR ) {
+			/* No progress possible; more input is needed. */
+			s.pending = false;
+			break;
+		} else {
+			throw std::runtime_error("Invalid gzip data"
+					+ std::string( strm.msg ? ": " : "" )
+					+ std::string( strm.msg ? strm.msg : "" ));
+		}
+
+		if (( used == 0 ) && ( made == 0 )) {
+			break;
+		}
+	}
+
+	return n;
+}
+
+void
+Inflater::finish() const {
+
+	if ( state_->in_member ) {
+		throw std::runtime_error("Unexpected end of gzip data");
+	}
+}
+
+uint64_t
+Inflater::consumed() const {
+	return state_->consumed;
+}
+
+uint64_t
+Inflater::produced() const {
+	return state_->produced;
+}
+
+
+/**************************************
+ * 	INFLATESTREAMBUF
+ **************************************/
+
+InflateStreambuf::InflateStreambuf( std::streambuf * source ) :
+	source_( source ),
+	in_( new char[BUFSIZE] ),
+	in_next_( in_.get() ),
+	out_( new char[BUFSIZE] )
+{
+	setg( out_.get(), out_.get(), out_.get() );
+}
+
+InflateStreambuf::int_type
+InflateStreambuf::underflow() {
+
+	if ( gptr() < egptr() ) {
+		return traits_type::to_int_type( *gptr() );
+	}
+
+	for ( ;; ) {
+		/* Refill the compressed data, once consumed. */
+		bool eof = false;
+		if ( in_length_ == 0 ) {
+			in_next_ = in_.get();
+			in_length_ = source_->sgetn( in_.get(), BUFSIZE );
+			eof = ( in_length_ == 0 );
+		}
+
+		const size_t n = inflater_.inflate( in_next_, in_length_,
+				out_.get(), BUFSIZE );
+		if ( n > 0 ) {
+			setg( out_.get(), out_.get(), out_.get() + n );
+			return traits_type::to_int_type( *gptr() );
+		}
+		if ( eof ) {
+			inflater_.finish();
+			return traits_type::eof();
+		}
+	}
+}
@@ -0,0 +1,300 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/memory.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+namespace {
+
+std::atomic< bool > enabled_{ false };
+std::atomic< int64_t > current_{ 0 };
+std::atomic< int64_t > peak_{ 0 };
+std::atomic< uint64_t > allocations_{ 0 };
+
+std::atomic< int > huge_scopes_{ 0 };
+std::atomic< uint64_t > huge_blocks_{ 0 };
+std::atomic< uint64_t > huge_bytes_{ 0 };
+
+/* Value of a "Key:  1234 kB" line of a /proc file. */
+long procValue( const char * fn, const std::string & key ) {
+
+	std::ifstream ifs(fn);
+	std::string line;
+	while ( std::getline( ifs, line )) {
+		if ( line.compare( 0, key.size(), key ) == 0 ) {
+			return std::atol( line.c_str() + key.size() );
+		}
+	}
+	return 0;
+}
+
+/* Value of a "Vm...:  1234 kB" line of /proc/self/status. */
+long procStatus( const std::string & key ) {
+	return procValue( "/proc/self/status", key );
+}
+
+}
+
+constexpr size_t HugePages::SIZE;
+constexpr size_t MemoryReport::NODE_OVERHEAD;
+
+
+/**************************************
+ * 	PUBLIC METHODS - MEMORY ACCOUNT
+ **************************************/
+
+void
+MemoryAccount::enable() {
+	enabled_.store( true, std::memory_order_relaxed );
+}
+
+bool
+MemoryAccount::enabled() {
+	return enabled_.load( std::memory_order_relaxed );
+}
+
+void
+MemoryAccount::allocated( size_t bytes ) {
+
+	if ( !enabled() ) {
+		return;
+	}
+	allocations_.fetch_add( 1, std::memory_order_relaxed );
+	const int64_t current = current_.fetch_add( bytes,
+			std::memory_order_relaxed ) + bytes;
+
+	int64_t peak = peak_.load( std::memory_order_relaxed );
+	while (( current > peak ) && !peak_.compare_exchange_weak( peak, current,
+				std::memory_order_relaxed )) {
+	}
+}
+
+void
+MemoryAccount::freed( size_t bytes ) {
+
+	if ( enabled() ) {
+		current_.fetch_sub( bytes, std::memory_order_relaxed );
+	}
+}
+
+int64_t
+MemoryAccount::current() {
+	return current_.load( std::memory_order_relaxed );
+}
+
+int64_t
+MemoryAccount::peak() {
+	return peak_.load( std::memory_order_relaxed );
+}
+
+uint64_t
+MemoryAccount::allocations() {
+	return allocations_.load( std::memory_order_relaxed );
+}
+
+void
+MemoryAccount::resetPeak() {
+	peak_.store( current(), std::memory_order_relaxed );
+}
+
+long
+MemoryAccount::currentRss() {
+	return procStatus("VmRSS:");
+}
+
+long
+MemoryAccount::peakRss() {
+
+	const long peak = procStatus("VmHWM:");
+	if ( peak > 0 ) {
+		return peak;
+	}
+
+	/* ru_maxrss is given in KiB on Linux. */
+	struct rusage usage;
+	if ( getrusage( RUSAGE_SELF, &usage ) != 0 ) {
+		return 0;
+	}
+	return usage.ru_maxrss;
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - HUGE PAGES
+ **************************************/
+
+HugePages::Scope::Scope( bool enable ) :
+	enable_( enable ),
+	blocks_( HugePages::blocks() ),
+	bytes_( HugePages::bytes() )
+{
+	if ( enable_ ) {
+		huge_scopes_.fetch_add( 1, std::memory_order_relaxed );
+	}
+}
+
+HugePages::Scope::~Scope() {
+
+	if ( enable_ ) {
+		huge_scopes_.fetch_sub( 1, std::memory_order_relaxed );
+	}
+}
+
+uint64_t
+HugePages::Scope::blocks() const {
+	return HugePages::blocks() - blocks_;
+}
+
+uint64_t
+HugePages::Scope::bytes() const {
+	return HugePages::bytes() - bytes_;
+}
+
+bool
+HugePages::wanted( size_t bytes ) {
+	return ( bytes >= SIZE )
+		&& ( huge_scopes_.load( std::memory_order_relaxed ) > 0 );
+}
+
+void *
+HugePages::allocate( size_t bytes ) {
+
+	/* Whole huge pages, so that the tail is advised too. */
+	const size_t size = ( bytes + SIZE - 1 ) / SIZE * SIZE;
+	void * ptr = nullptr;
+	if ( posix_memalign( &ptr, SIZE, size ) != 0 ) {
+		return nullptr;
+	}
+
+#ifdef MADV_HUGEPAGE
+	if ( madvise( ptr, size, MADV_HUGEPAGE ) == 0 ) {
+		huge_blocks_.fetch_add( 1, std::memory_order_relaxed );
+		huge_bytes_.fetch_add( size, std::memory_order_relaxed );
+	}
+#endif
+	return ptr;
+}
+
+uint64_t
+HugePages::blocks() {
+	return huge_blocks_.load( std::memory_order_relaxed );
+}
+
+uint64_t
+HugePages::bytes() {
+	return huge_bytes_.load( std::memory_order_relaxed );
+}
+
+long
+HugePages::residentKb() {
+	return procValue( "/proc/self/smaps_rollup", "AnonHugePages:" );
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - MEMORY REPORT
+ **************************************/
+
+MemoryReport::Phase::Phase( MemoryReport & report, const std::string & name ) :
+	report_( report ),
+	name_( name ),
+	current_( MemoryAccount::current() ),
+	allocations_( MemoryAccount::allocations() )
+{
+	MemoryAccount::resetPeak();
+}
+
+MemoryReport::Phase::~Phase() {
+
+	report_.phases_.push_back({ name_,
+			MemoryAccount::peak() - current_,
+			MemoryAccount::current() - current_,
+			MemoryAccount::allocations() - allocations_,
+			MemoryAccount::peakRss() });
+}
+
+void
+MemoryReport::add( const std::string & subsystem, size_t bytes ) {
+	subsystems_.push_back({ subsystem, bytes });
+}
+
+void
+MemoryReport::print( std::ostream & os ) const {
+
+#define TABWIDTH 40
+
+	const double KiB = 1024;
+
+	os << std::endl << "MEMORY" << std::endl;
+	os << std::left << std::setw(TABWIDTH) << "Peak RSS:"
+		<< MemoryAccount::peakRss() << " KiB" << std::endl;
+	os << std::left << std::setw(TABWIDTH) << "Current RSS:"
+		<< MemoryAccount::currentRss() << " KiB" << std::endl;
+
+	if ( MemoryAccount::enabled() ) {
+		os << std::endl
+			<< std::left << std::setw(TABWIDTH) << "PHASE"
+			<< std::setw(16) << "PEAK (KiB)"
+			<< std::setw(16) << "RETAINED (KiB)"
+			<< std::setw(16) << "ALLOCATIONS"
+			<< "PEAK RSS (KiB)"
+			<< std::endl;
+		for ( auto const & phase : phases_ ) {
+			os << std::left << std::setw(TABWIDTH) << phase.name
+				<< std::setw(16) << static_cast< int64_t >( phase.peak / KiB )
+				<< std::setw(16) << static_cast< int64_t >( phase.retained / KiB )
+				<< std::setw(16) << phase.allocations
+				<< phase.peak_rss
+				<< std::endl;
+		}
+	}
+
+	size_t total = 0;
+	os << std::endl
+		<< std::left << std::setw(TABWIDTH) << "SUBSYSTEM"
+		<< "ESTIMATED (KiB)"
+		<< std::endl;
+	for ( auto const & subsystem : subsystems_ ) {
+		os << std::left << std::setw(TABWIDTH) << subsystem.name
+			<< static_cast< uint64_t >( subsystem.bytes / KiB )
+			<< std::endl;
+		total += subsystem.bytes;
+	}
+	os << std::left << std::setw(TABWIDTH) << "Total:"
+		<< static_cast< uint64_t >( total / KiB )
+		<< std::endl;
+
+#undef TABWIDTH
+}
+
+size_t
+MemoryReport::heapBytes( const std::string & str ) {
+
+	/* Short strings are stored within the object. */
+	const char * const object = reinterpret_cast< const char * >( &str );
+	if (( str.data() >= object ) && ( str.data() < object + sizeof(str) )) {
+		return 0;
+	}
+	return str.capacity() + 1;
+}
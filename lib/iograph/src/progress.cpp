@@ -0,0 +1,56 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/progress.hpp>
+
+#include <atomic>
+
+namespace {
+
+/* Lock-free on all supported platforms;
+ * thus safe to set from a signal handler. */
+std::atomic< bool > requested_{ false };
+
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - CANCELLATION
+ **************************************/
+
+void
+Cancellation::request() {
+	requested_.store( true, std::memory_order_relaxed );
+}
+
+bool
+Cancellation::requested() {
+	return requested_.load( std::memory_order_relaxed );
+}
+
+void
+Cancellation::reset() {
+	requested_.store( false, std::memory_order_relaxed );
+}
+
+void
+Cancellation::check() {
+
+	if ( requested() ) {
+		throw Cancelled();
+	}
+}
@@ -0,0 +1,338 @@
+/* This file is part of MathTrader++, a C++ utility
+ * for finding, on a directed graph whose arcs have costs,
+ * a set of vertex-disjoint cycles that maximizes the number
+ * of covered vertices as a first priority
+ * and minimizes the total cost as a second priority.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/resultdiff.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <stdexcept>
+
+
+const uint32_t ResultDiff::NONE;
+
+
+/************************************//*
+ * 	PUBLIC METHODS - CONSTRUCTORS
+ **************************************/
+
+ResultDiff::ResultDiff() :
+	_n_split( 0 ),
+	_n_merged( 0 )
+{
+}
+
+ResultDiff::~ResultDiff() {
+}
+
+
+/************************************//*
+ * 	PUBLIC METHODS - INPUT
+ **************************************/
+
+ResultDiff &
+ResultDiff::setPrevious( const std::vector< std::string > & items,
+		const std::vector< std::string > & users,
+		const std::vector< uint32_t > & loops ) {
+
+	_load( _previous, items, users, loops );
+	return *this;
+}
+
+ResultDiff &
+ResultDiff::setCurrent( const std::vector< std::string > & items,
+		const std::vector< std::string > & users,
+		const std::vector< uint32_t > & loops ) {
+
+	_load( _current, items, users, loops );
+	return *this;
+}
+
+
+/************************************//*
+ * 	PUBLIC METHODS - RUNNABLE
+ **************************************/
+
+void
+ResultDiff::run() {
+
+	_changed.clear();
+	_lost.clear();
+	_gained.clear();
+	_lost_users.clear();
+
+	/**
+	 * Items of the other results do not trade.
+	 */
+	for ( auto * results : { &_previous, &_current } ) {
+		results->receive.resize( _items.size(), NONE );
+		results->loop.resize( _items.size(), NONE );
+	}
+
+	/**
+	 * Item by item: what it received, what it receives.
+	 * Count the trading items of each user.
+	 */
+	std::unordered_map< std::string, std::pair< unsigned, unsigned > > trading;
+	std::vector< std::string > users;
+
+	for ( uint32_t id = 0; id < _items.size(); ++ id ) {
+
+		const uint32_t previous = _previous.receive[id],
+		      current = _current.receive[id];
+
+		if (( previous != NONE ) && ( current == NONE )) {
+			_lost.push_back( id );
+		} else if (( previous == NONE ) && ( current != NONE )) {
+			_gained.push_back( id );
+		} else if ( previous != current ) {
+			_changed.push_back( id );
+		}
+
+		/* Dummy items do not count for their users. */
+		if ( !_items[id].empty() && ( _items[id].front() == '%' )) {
+			continue;
+		}
+		auto const pair = trading.emplace( _users[id],
+				std::make_pair( 0u, 0u ));
+		if ( pair.second ) {
+			users.push_back( _users[id] );
+		}
+		pair.first->second.first += ( previous != NONE );
+		pair.first->second.second += ( current != NONE );
+	}
+
+	for ( auto const & user : users ) {
+		auto const & count = trading.at( user );
+		if (( count.first > 0 ) && ( count.second == 0 )) {
+			_lost_users.push_back( user );
+		}
+	}
+
+	/**
+	 * Loop by loop: previous loops now split
+	 * and current loops merged from previous ones.
+	 */
+	_n_split = _countSplit( _previous, _current );
+	_n_merged = _countSplit( _current, _previous );
+}
+
+
+/************************************//*
+ * 	PUBLIC METHODS - OUTPUT
+ **************************************/
+
+const ResultDiff &
+ResultDiff::print( std::ostream & os ) const {
+
+#define TABWIDTH 32
+
+	os << std::left
+		<< std::setw(TABWIDTH) << "Items receiving another item:"
+		<< _changed.size() << std::endl
+		<< std::setw(TABWIDTH) << "Items no longer trading:"
+		<< _lost.size() << std::endl
+		<< std::setw(TABWIDTH) << "Items newly trading:"
+		<< _gained.size() << std::endl
+		<< std::setw(TABWIDTH) << "Loops split:"
+		<< _n_split << std::endl
+		<< std::setw(TABWIDTH) << "Loops merged:"
+		<< _n_merged << std::endl
+		<< std::setw(TABWIDTH) << "Users no longer trading:"
+		<< _lost_users.size() << std::endl;
+
+#undef TABWIDTH
+
+	/**
+	 * Changed items, in order of their ids.
+	 */
+	std::vector< uint32_t > ids;
+	ids.reserve( _changed.size() + _lost.size() + _gained.size() );
+	ids.insert( ids.end(), _changed.begin(), _changed.end() );
+	ids.insert( ids.end(), _lost.begin(), _lost.end() );
+	ids.insert( ids.end(), _gained.begin(), _gained.end() );
+	std::sort( ids.begin(), ids.end() );
+
+	if ( !ids.empty() ) {
+		os << std::endl;
+	}
+	for ( auto const id : ids ) {
+
+		const uint32_t previous = _previous.receive[id],
+		      current = _current.receive[id];
+
+		os << _label(id);
+		if ( current == NONE ) {
+			os << " no longer trades; received "
+				<< _label(previous);
+		} else if ( previous == NONE ) {
+			os << " now receives "
+				<< _label(current);
+		} else {
+			os << " receives "
+				<< _label(current)
+				<< " instead of "
+				<< _label(previous);
+		}
+		os << std::endl;
+	}
+
+	if ( !_lost_users.empty() ) {
+		os << std::endl << "USERS NO LONGER TRADING" << std::endl;
+		for ( auto const & user : _lost_users ) {
+			os << user << std::endl;
+		}
+	}
+
+	return *this;
+}
+
+
+/************************************//*
+ * 	PUBLIC METHODS - STATS
+ **************************************/
+
+unsigned
+ResultDiff::getNumChanged() const {
+	return _changed.size();
+}
+
+unsigned
+ResultDiff::getNumLost() const {
+	return _lost.size();
+}
+
+unsigned
+ResultDiff::getNumGained() const {
+	return _gained.size();
+}
+
+unsigned
+ResultDiff::getNumSplit() const {
+	return _n_split;
+}
+
+unsigned
+ResultDiff::getNumMerged() const {
+	return _n_merged;
+}
+
+const std::vector< std::string > &
+ResultDiff::getLostUsers() const {
+	return _lost_users;
+}
+
+
+/************************************//*
+ * 	PRIVATE METHODS
+ **************************************/
+
+void
+ResultDiff::_load( Results_t_ & results,
+		const std::vector< std::string > & items,
+		const std::vector< std::string > & users,
+		const std::vector< uint32_t > & loops ) {
+
+	/**
+	 * Common ids of the items;
+	 * names are compared in uppercase.
+	 */
+	std::vector< uint32_t > ids( items.size() );
+	for ( size_t i = 0; i < items.size(); ++ i ) {
+
+		std::string item( items[i] );
+		std::transform( item.begin(), item.end(), item.begin(), ::toupper );
+
+		auto const pair = _item_ids.emplace( item,
+				static_cast< uint32_t >( _items.size() ));
+		if ( pair.second ) {
+			_items.push_back( item );
+			_users.push_back( ( i < users.size() ) ? users[i] : "" );
+		}
+		ids[i] = pair.first->second;
+	}
+
+	results = Results_t_();
+	results.receive.resize( _items.size(), NONE );
+	results.loop.resize( _items.size(), NONE );
+
+	/**
+	 * Each item receives the next one;
+	 * a loop ends with its first item.
+	 */
+	bool new_loop = true;
+	uint32_t start = NONE, prev = NONE;
+
+	for ( auto const i : loops ) {
+
+		if ( i >= ids.size() ) {
+			throw std::logic_error("Item id "
+					+ std::to_string(i)
+					+ " out of range");
+		}
+		const uint32_t id = ids[i];
+
+		if ( new_loop ) {
+			new_loop = false;
+			start = id;
+			++ results.n_loops;
+		} else {
+			results.receive[prev] = id;
+			if ( id == start ) {
+				new_loop = true;
+			}
+		}
+		results.loop[id] = results.n_loops - 1;
+		results.sequence.push_back( id );
+		prev = id;
+	}
+}
+
+unsigned
+ResultDiff::_countSplit( const Results_t_ & from, const Results_t_ & to ) const {
+
+	/**
+	 * Loops of @to seen last by each loop of @from;
+	 * the items of a loop of @from are contiguous in its sequence.
+	 */
+	std::vector< uint32_t > seen( to.n_loops, NONE );
+	std::vector< unsigned > parts( from.n_loops, 0 );
+
+	for ( auto const id : from.sequence ) {
+
+		const uint32_t l_from = from.loop[id], l_to = to.loop[id];
+		if ( l_to == NONE ) {
+			continue;
+		}
+		if ( seen[l_to] != l_from ) {
+			seen[l_to] = l_from;
+			++ parts[l_from];
+		}
+	}
+
+	return std::count_if( parts.begin(), parts.end(),
+			[]( unsigned n ) { return n > 1; });
+}
+
+std::string
+ResultDiff::_label( uint32_t id ) const {
+	return "(" + _users[id] + ") " + _items[id];
+}
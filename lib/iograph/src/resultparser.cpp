@@ -21,7 +21,8 @@
  */
 #include <iograph/resultparser.hpp>
 
-#include <regex>
+#include <algorithm>
+#include <cctype>
 #include <stdexcept>
 
 
@@ -32,7 +33,8 @@
 ResultParser::ResultParser() :
 	BaseParser(),
 	_status( BEGIN ),
-	_new_loop( true )
+	_new_loop( true ),
+	_first_item( 0 )
 {
 }
 
@@ -47,9 +49,10 @@ ResultParser::~ResultParser() {
 const ResultParser &
 ResultParser::print( std::ostream &os ) const {
 
-	for ( auto const & item : _item_list ) {
-		os << item << std::endl;
+	for ( auto const id : _loops ) {
+		os << '"' << _items[id] << '"' << '\n';
 	}
+	os.flush();
 
 	return *this;
 }
@@ -65,6 +68,21 @@ ResultParser::print( const std::string & fn ) const {
 	return *this;
 }
 
+const std::vector< std::string > &
+ResultParser::getItems() const {
+	return _items;
+}
+
+const std::vector< std::string > &
+ResultParser::getUsers() const {
+	return _users;
+}
+
+const std::vector< uint32_t > &
+ResultParser::getLoops() const {
+	return _loops;
+}
+
 
 /************************************//*
  * 	PRIVATE METHODS - PARSING
@@ -144,94 +162,137 @@ ResultParser::_postParse() {
 ResultParser &
 ResultParser::_parseLoop( const std::string & line ) {
 
-	static const std::regex FPAT_loop(
-		R"(\([^\)]+\))"		// Group 1: parentheses
-		"|"
-		R"(\S+(-\([^\)]+\))?)"	// Group 2: any non-whitespace
-	);
-
 	/**
-	 * Tokenize the line
+	 * Tokenize the line:
+	 * - a parenthesized group, which may contain spaces,
+	 * - else, any non-whitespace run.
+	 * At most 9 fields are used; keep the offsets only.
 	 */
-	auto const match = _split( line, FPAT_loop );
-	if ( match.empty() ) {
-		throw std::runtime_error("Bad format of want list: "
-				+ line);
+	const size_t MAX_FIELDS = 9;
+	size_t begin[ MAX_FIELDS ], end[ MAX_FIELDS ];
+	size_t n_fields = 0;
+
+	const size_t len = line.length();
+	size_t i = 0;
+	while ( n_fields < MAX_FIELDS ) {
+
+		while (( i < len ) && std::isspace( static_cast< unsigned char >( line[i] ))) {
+			++ i;
+		}
+		if ( i == len ) {
+			break;
+		}
+
+		size_t j = std::string::npos;
+		if ( line[i] == '(' ) {
+			j = line.find( ')', i + 1 );
+			if (( j != std::string::npos ) && ( j > i + 1 )) {
+				++ j;
+			} else {
+				j = std::string::npos;
+			}
+		}
+		if ( j == std::string::npos ) {
+			j = i;
+			while (( j < len ) && !std::isspace( static_cast< unsigned char >( line[j] ))) {
+				++ j;
+			}
+		}
+
+		begin[ n_fields ] = i;
+		end[ n_fields ] = j;
+		++ n_fields;
+		i = j;
+	}
+
+	if ( n_fields == 0 ) {
+		_error( Diagnostic::BAD_LOOP, line );
+		return *this;
 	}
 
 	/**
-	 * TODO check if match[0]
+	 * TODO check if the first field
 	 * is username.
 	 */
 
 	/**
-	 * Regexes to check if source and/or targets are dummies.
-	 * TradeMaximizer prints "%NAME for user (USER)" in this case
+	 * Check if source and/or targets are dummies.
+	 * TradeMaximizer prints "%NAME for user (USER)" in this case:
+	 * the source is dummy if "for user" precedes "receives",
+	 * the target is dummy if "receives" precedes "for user".
 	 */
-	static const std::regex
-		dummy_regex_src("^(.)*for user(.)*receives(.)*$"),
-		dummy_regex_dst("^(.)*receives(.)*for user(.)*$");
+	static const std::string FOR_USER("for user"), RECEIVES("receives");
+
+	const size_t first_for = line.find( FOR_USER ),
+	      last_for = line.rfind( FOR_USER ),
+	      first_rcv = line.find( RECEIVES ),
+	      last_rcv = line.rfind( RECEIVES );
+
+	const bool dummy_src = ( first_for != std::string::npos )
+		&& ( last_rcv != std::string::npos )
+		&& ( last_rcv >= first_for + FOR_USER.length() ),
+	      dummy_dst = ( first_rcv != std::string::npos )
+		&& ( last_for != std::string::npos )
+		&& ( last_for >= first_rcv + RECEIVES.length() );
 
 	/**
-	 * See if source/target match.
+	 * Enough fields for the source and the target?
 	 */
-	const bool dummy_src = std::regex_match( line, dummy_regex_src ),
-	      dummy_dst = std::regex_match( line, dummy_regex_dst );
+	const size_t fields = ( dummy_dst ? 7 : 5 ) + ( dummy_src ? 2 : 0 );
+	if ( n_fields < fields ) {
+		_error( Diagnostic::BAD_LOOP, line );
+		return *this;
+	}
+
+	auto const field = [&]( size_t k ) {
+		return line.substr( begin[k], end[k] - begin[k] );
+	};
 
 	/**
 	 * The source and target items.
 	 * If dummy, the username will be appended.
+	 * The target is offset if the source is dummy.
 	 */
-	std::string source, target;
-
-	/**
-	 * The target offset, in case the source is dummy.
-	 */
-	int dst_offset = 0;
+	std::string source, target, source_user, target_user;
+	size_t dst_offset = 0;
 
-	/**
-	 * Check if source is dummy
-	 */
 	if ( !dummy_src ) {
-		source = match[1];
+		source_user = field(0);
+		source = field(1);
 	} else {
 		dst_offset = 2;
-		source = match[0] + "-" + match[3];
+		source_user = field(3);
+		source = field(0) + "-" + source_user;
 	}
 
-	/**
-	 * Check if target is dummy
-	 */
 	if ( !dummy_dst ) {
-		target = match[4 + dst_offset];
+		target_user = field(3 + dst_offset);
+		target = field(4 + dst_offset);
 	} else {
-		target = match[3 + dst_offset]
+		target_user = field(6 + dst_offset);
+		target = field(3 + dst_offset)
 			+ "-"
-			+ match[6 + dst_offset];
+			+ target_user;
 	}
 
 	/**
 	 * New loop has started?
-	 * Print the source item.
+	 * Add the source item.
 	 */
 	if ( _new_loop ) {
 
 		/* New cycle */
-		_toUpper(source);
-		_quotationMarks(source);
-		_item_list.push_back( source );
-		_first_item = source;
+		_first_item = _itemId( source, source_user );
+		_loops.push_back( _first_item );
 		_new_loop = false;
-
 	}
 
 	/* Always add the target */
 	//TODO making uppercase? Check with options @ WantParser.
-	_toUpper( target );
-	_quotationMarks( target );
-	_item_list.push_back( target );
+	const uint32_t target_id = _itemId( target, target_user );
+	_loops.push_back( target_id );
 
-	if ( target.compare(_first_item) == 0 ) {
+	if ( target_id == _first_item ) {
 
 		/* Cycle end */
 		_new_loop = true;
@@ -239,3 +300,30 @@ ResultParser::_parseLoop( const std::string & line ) {
 
 	return *this;
 }
+
+uint32_t
+ResultParser::_itemId( std::string & item, const std::string & user ) {
+
+	/**
+	 * Uppercase, without the leading quotation mark;
+	 * print() adds the quotation marks.
+	 */
+	_toUpper( item );
+	if ( !item.empty() && ( item.front() == '"' )) {
+		item.erase( 0, 1 );
+	}
+
+	auto const pair = _item_ids.emplace( item,
+			static_cast< uint32_t >( _items.size() ));
+	if ( pair.second ) {
+		_items.push_back( item );
+
+		/* Strip the parentheses of "(USERNAME)". */
+		const bool parenthesized = ( user.length() >= 2 )
+			&& ( user.front() == '(' ) && ( user.back() == ')' );
+		_users.push_back( parenthesized
+				? user.substr( 1, user.length() - 2 )
+				: user );
+	}
+	return pair.first->second;
+}
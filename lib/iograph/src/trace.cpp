@@ -0,0 +1,153 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/trace.hpp>
+
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+
+/**************************************
+ * 	PUBLIC METHODS - TRACE
+ **************************************/
+
+Trace &
+Trace::instance() {
+
+	static Trace trace;
+	return trace;
+}
+
+void
+Trace::start() {
+
+	std::lock_guard< std::mutex > lock( mutex_ );
+	zones_.clear();
+	epoch_ = Clock::now();
+	enabled_.store( true, std::memory_order_release );
+}
+
+void
+Trace::stop() {
+	enabled_.store( false, std::memory_order_release );
+}
+
+bool
+Trace::enabled() const {
+	return enabled_.load( std::memory_order_acquire );
+}
+
+void
+Trace::record( const char * name, const char * category,
+		Clock::time_point begin, Clock::time_point end ) {
+
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+
+	const uint32_t tid = threadId();
+
+	std::lock_guard< std::mutex > lock( mutex_ );
+	if ( !enabled() ) {
+		return;
+	}
+	zones_.push_back({ name, category, tid,
+			duration_cast< microseconds >( begin - epoch_ ).count(),
+			duration_cast< microseconds >( end - begin ).count() });
+}
+
+size_t
+Trace::size() const {
+
+	std::lock_guard< std::mutex > lock( mutex_ );
+	return zones_.size();
+}
+
+void
+Trace::write( std::ostream & os ) const {
+
+	std::lock_guard< std::mutex > lock( mutex_ );
+	const long pid = static_cast< long >( ::getpid() );
+
+	/* Names and categories are string literals without quotes
+	 * or backslashes; they need no escaping. */
+	os << "{\"traceEvents\":[";
+	for ( size_t i = 0; i < zones_.size(); ++ i ) {
+		auto const & zone = zones_[i];
+		os << ( i ? ",\n" : "\n" )
+			<< "{\"name\":\"" << zone.name << "\""
+			<< ",\"cat\":\"" << zone.category << "\""
+			<< ",\"ph\":\"X\""
+			<< ",\"ts\":" << zone.begin_us
+			<< ",\"dur\":" << zone.duration_us
+			<< ",\"pid\":" << pid
+			<< ",\"tid\":" << zone.tid
+			<< "}";
+	}
+	os << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+}
+
+void
+Trace::write( const std::string & fn ) const {
+
+	std::ofstream ofs( fn );
+	if ( !ofs ) {
+		throw std::runtime_error("Failed to open " + fn);
+	}
+	write( ofs );
+	if ( !ofs ) {
+		throw std::runtime_error("Failed to write " + fn);
+	}
+}
+
+uint32_t
+Trace::threadId() {
+
+	static std::atomic< uint32_t > next{ 1 };
+	thread_local const uint32_t tid = next.fetch_add( 1 );
+	return tid;
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - TRACE ZONE
+ **************************************/
+
+TraceZone::TraceZone( const char * name, const char * category ) :
+	name_( name ),
+	category_( category ),
+	enabled_( Trace::instance().enabled() )
+{
+	if ( enabled_ ) {
+		begin_ = Trace::Clock::now();
+	}
+}
+
+TraceZone::~TraceZone() {
+	end();
+}
+
+void
+TraceZone::end() {
+
+	if ( enabled_ ) {
+		enabled_ = false;
+		Trace::instance().record( name_, category_,
+				begin_, Trace::Clock::now() );
+	}
+}
@@ -16,6 +16,7 @@
  * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <iograph/wantparser.hpp>
+#include <stdexcept>
 
 
 /**************************************
@@ -63,9 +64,7 @@ WantParser::parseLine_( const std::string & buffer ) {
 				break;
 			}
 			default: {
-				throw std::runtime_error("Options can only"
-						" be given at the beginning"
-						" of the file");
+				error_( Diagnostic::OPTION_NOT_AT_BEGINNING );
 				break;
 			}
 		}
@@ -92,21 +91,17 @@ WantParser::parseLine_( const std::string & buffer ) {
 				}
 
 				case PARSE_NAMES: {
-					throw std::runtime_error("Official names"
-							" are already being given");
+					error_( Diagnostic::NAMES_BEING_GIVEN );
 					break;
 				}
 
 				case PARSE_WANTS_WITHNAMES: {
-					throw std::runtime_error("Official names"
-							" have already been given");
+					error_( Diagnostic::NAMES_ALREADY_GIVEN );
 					break;
 				}
 
 				default: {
-					throw std::runtime_error("Official names"
-							" can only be declared"
-							" before the want lists");
+					error_( Diagnostic::NAMES_AFTER_WANTS );
 					break;
 				}
 			}
@@ -118,8 +113,7 @@ WantParser::parseLine_( const std::string & buffer ) {
 			this->status_ = PARSE_WANTS_WITHNAMES;
 
 		} else {
-			throw std::runtime_error("Unrecognized directive: "
-					+ buffer);
+			error_( Diagnostic::UNKNOWN_DIRECTIVE, buffer );
 		}
 	} else {
 		/* This line contains something else to be parsed.
@@ -156,20 +150,22 @@ WantParser::parseLine_( const std::string & buffer ) {
 	}
 }
 
-void
+bool
 WantParser::parseOption_( const std::string & option_line ) {
 
 	/* Tokenize line via regex: ignore whitespaces.
 	 * Multiple options may be present in the same line. */
 	static const std::regex e(R"(\S+)");
-	auto tokens = split_( option_line, e );
+	auto const tokens = split_( option_line, e, arena_ );
 
 	/* Handle option according to type in order:
 	 * - Integer
 	 * - Priorities
 	 * - String
 	 */
-	for ( auto const & option : tokens ) {
+	for ( auto const & token : tokens ) {
+
+		const std::string option( token.begin(), token.end() );
 
 		/* Add to given options list. */
 		this->given_options_.push_back( option );
@@ -193,7 +189,7 @@ WantParser::parseOption_( const std::string & option_line ) {
 			/* Tokenize around '='.
 			 * Isolate the variable name and any integer values. */
 			static const std::regex digits(R"(([-+]?\d+)|(\b([^=])+))");
-			auto const int_elems = split_( option, digits );
+			auto const int_elems = split_( option, digits, arena_ );
 
 			/* Int option; tokenize to retrieve name value.
 			 * Check whether the option has been tokenized
@@ -201,20 +197,22 @@ WantParser::parseOption_( const std::string & option_line ) {
 			if ( int_elems.empty() ) {
 				throw std::logic_error("Regex to tokenize integer-value option has failed.");
 			} else if ( int_elems.size() < 2 ) {
-				throw std::runtime_error("Value for integer option "
-						+ int_elems.at(0) + " not found");
+				return error_( Diagnostic::MISSING_OPTION_VALUE,
+						std::string( int_elems.at(0).begin(),
+							int_elems.at(0).end() ));
 			}
 
 			/* First element: name of int option.
 			 * Second element: value of int option. */
-			const std::string int_option_name = int_elems.at(0);
-			const std::string &value = int_elems.at(1);
+			const std::string
+				int_option_name( int_elems.at(0).begin(), int_elems.at(0).end() ),
+				value( int_elems.at(1).begin(), int_elems.at(1).end() );
 
 			/* Get int option from map, if supported. */
 			auto const it = int_option_map_.find( int_option_name );
 			if ( it == int_option_map_.end() ) {
-				throw std::runtime_error("Unknown integer option "
-						+ int_option_name);
+				return error_( Diagnostic::UNKNOWN_INT_OPTION,
+						int_option_name );
 			}
 
 			/* Set the value of the int option. */
@@ -243,13 +241,14 @@ WantParser::parseOption_( const std::string & option_line ) {
 
 			} else {
 				/* Option not supported. */
-				throw std::runtime_error("Unknown option " + option);
+				return error_( Diagnostic::UNKNOWN_OPTION, option );
 			}
 		}
 	}
+	return true;
 }
 
-void
+bool
 WantParser::parseOfficialName_( const std::string & line ) {
 
 	/* Regular expression to separate fields of official name.
@@ -286,16 +285,16 @@ WantParser::parseOfficialName_( const std::string & line ) {
 	);
 
 	/* Tokenize the line. */
-	auto match = split_( line, FPAT_names );
+	auto match = tokenize_( line, 'N', FPAT_names );
 
 	/* Sanity check for minimum number of matches
 	 * TODO the description (4th item) is optional. */
 	if ( match.size() < 4 ) {
-		throw std::runtime_error("Bad format of official name line");
+		return error_( Diagnostic::BAD_NAME_LINE );
 	}
 
 	/* Item name: to be used as a hash key. */
-	const std::string
+	const ArenaString
 		&orig_item = match[0],
 		&orig_official_name = match[2],
 		&from_username = match[3];
@@ -303,7 +302,10 @@ WantParser::parseOfficialName_( const std::string & line ) {
 	/* Parse item name (quotation marks, uppercase).
 	 * As we're not providing a username,
 	 * it will raise an error if it's dummy. */
-	const std::string item = convertItemName_( orig_item );
+	std::string item;
+	if ( !convertItemName_( orig_item, std::string(), item ) ) {
+		return false;
+	}
 
 	/* Replace nested quotation marks in official_name with "'".
 	 * Replace backslashes with forward slashes;
@@ -311,7 +313,8 @@ WantParser::parseOfficialName_( const std::string & line ) {
 	 * Ignore the first and the last position of the string.
 	 * TODO create static private method.
 	 */
-	std::string official_name( orig_official_name );
+	std::string official_name( orig_official_name.begin(),
+			orig_official_name.end() );
 
 	/* Remove quotations.
 	 * std::remove pushes all quotes to the end
@@ -337,15 +340,13 @@ WantParser::parseOfficialName_( const std::string & line ) {
 	 * TODO it might not be a username;
 	 * match with "(from xxx)" and ignore otherwise.
 	 */
+	const std::string token( from_username.begin(), from_username.end() );
 	std::string username;
 	try {
-		username = from_username.substr(6, std::string::npos); /* remove "(from " */
+		username = token.substr( 6 ); /* remove "(from " */
 	} catch ( const std::out_of_range & e ) {
-		throw std::runtime_error("Out of range when parsing username: "
-			+ from_username
-			+ ": "
-			+ e.what()
-			);
+		return error_( Diagnostic::BAD_NAME_USERNAME,
+				token + ": " + e.what(), token );
 	}
 
 	/* Remove last ')' from username, if not empty. */
@@ -354,7 +355,7 @@ WantParser::parseOfficialName_( const std::string & line ) {
 	}
 
 	/* Add the item to node_map_. */
-	this->addSourceItem_( item, official_name, username );
+	return this->addSourceItem_( item, official_name, username );
 }
 
 /**************************************
@@ -362,7 +363,7 @@ WantParser::parseOfficialName_( const std::string & line ) {
  **************************************/
 
 std::string
-WantParser::extractUsername_( const std::string & token ) {
+WantParser::extractUsername_( const ArenaString & token ) {
 
 	/* Username to extract; empty if nothing is extracted. */
 	std::string username;
@@ -376,37 +377,32 @@ WantParser::extractUsername_( const std::string & token ) {
 				&& ( token.back() == ')' ));
 
 		if ( is_username ) {
-			username = token.substr(1, token.size()-2);
+			username.assign( token.begin() + 1, token.end() - 1 );
 		}
 	}
 	return username;
 }
 
-std::string
-WantParser::convertItemName_( const std::string & item,
-		const std::string username ) const {
+bool
+WantParser::convertItemName_( const ArenaString & item,
+		const std::string & username,
+		std::string & target ) {
 
 	/* Target item name */
-	std::string target(item);
+	target.assign( item.begin(), item.end() );
 
 	/* Handle cases where item is dummy */
-	if ( this->isDummy_(item) ) {
+	if ( this->isDummy_(target) ) {
 
 		/* Only proceed if dummy names are allowed. */
 		if ( !this->bool_options_[ALLOW_DUMMIES] ) {
 
-			throw std::runtime_error("Dummy item "
-					+ item
-					+ " detected, but dummy items"
-					" not allowed");
+			return error_( Diagnostic::DUMMY_NOT_ALLOWED, target );
 
 		} else if ( username.empty() ) {
 
 			/* Usernames MUST be present when giving a dummy item. */
-			throw std::runtime_error("Dummy item "
-					+ item
-					+ " detected, but username "
-					" not defined");
+			return error_( Diagnostic::DUMMY_WITHOUT_USERNAME, target );
 		}
 
 		/* Append username to dummy name. */
@@ -421,7 +417,26 @@ WantParser::convertItemName_( const std::string & item,
 		std::transform(target.begin(), target.end(), target.begin(), ::toupper);
 	}
 
-	return target;
+	return true;
+}
+
+bool
+WantParser::error_( Diagnostic::Code code,
+		const std::string & item,
+		const std::string & token ) {
+
+	/* Locate the offending token in the current line. */
+	size_t column = 0;
+	const std::string & find = token.empty() ? item : token;
+	if ( line_ && !find.empty() ) {
+		const auto pos = line_->find( find );
+		if ( pos != std::string::npos ) {
+			column = pos + 1;
+		}
+	}
+
+	this->errors_.add( line_n_, column, code, item );
+	return false;
 }
 
 /***************************************
@@ -440,18 +455,24 @@ WantParser::isDummy_( const std::string & item ) {
 	return ( item.front() == '%' );
 }
 
-std::vector<std::string>
-WantParser::split_( const std::string & input, const std::string & str ) {
+WantParser::Tokens_
+WantParser::split_( const std::string & input, const std::string & str,
+		Arena & arena ) {
 	std::regex regex(str);
-	return split_( input, regex );
+	return split_( input, regex, arena );
 }
 
-std::vector< std::string >
-WantParser::split_( const std::string & input, const std::regex & regex ) {
+WantParser::Tokens_
+WantParser::split_( const std::string & input, const std::regex & regex,
+		Arena & arena ) {
 	std::sregex_token_iterator
 		first{input.begin(), input.end(), regex, 0},
 		last;
-	return {first, last};
+	Tokens_ tokens( arena );
+	for ( ; first != last; ++ first ) {
+		tokens.emplace_back( first->first, first->second, arena );
+	}
+	return tokens;
 }
 
 
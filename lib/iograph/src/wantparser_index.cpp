@@ -0,0 +1,229 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/wantparser.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+/* Index file format:
+ *
+ * 	mathtrader-wantparser-index 2
+ * 	HASH KIND LEN:LINE NTOKENS LEN:TOKEN LEN:TOKEN ...
+ * 	...
+ *
+ * One line per indexed want-file line:
+ * its hash, its kind, the line itself and its tokens.
+ * The line and the tokens are length-prefixed;
+ * they may contain whitespace.
+ */
+static const std::string INDEX_HEADER = "mathtrader-wantparser-index 2";
+
+/* A length-prefixed string of the index file. */
+static bool readIndexString( std::istream & is, std::string & str ) {
+
+	size_t length;
+	if ( !( is >> length ) || ( is.get() != ':' )) {
+		return false;
+	}
+	str.resize( length );
+	is.read( &str[0], length );
+	return static_cast< bool >( is );
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - LINE INDEX
+ **************************************/
+
+bool
+WantParser::loadIndex( const std::string & fn ) {
+
+	index_enabled_ = true;
+
+	std::ifstream ifs( fn, std::ios::in | std::ios::binary );
+	std::string header;
+	if ( !ifs || !std::getline(ifs, header) || ( header != INDEX_HEADER )) {
+		return false;
+	}
+
+	std::unordered_map< uint64_t, IndexedLine_ > index;
+	uint64_t hash;
+	while ( ifs >> hash ) {
+
+		IndexedLine_ entry;
+		size_t n_tokens;
+		if ( !( ifs >> entry.kind ) || !readIndexString( ifs, entry.line )
+				|| !( ifs >> n_tokens )) {
+			throw std::runtime_error("Corrupt index file "
+					+ fn);
+		}
+		entry.tokens.resize( n_tokens );
+		for ( auto & token : entry.tokens ) {
+			if ( !readIndexString( ifs, token )) {
+				throw std::runtime_error("Corrupt index file "
+						+ fn);
+			}
+		}
+		index.emplace( hash, std::move(entry) );
+	}
+	if ( !ifs.eof() ) {
+		throw std::runtime_error("Corrupt index file "
+				+ fn);
+	}
+
+	index_prev_.swap( index );
+	index_loaded_ = true;
+	return true;
+}
+
+bool
+WantParser::reuseIndex( const WantParser & previous ) {
+
+	index_enabled_ = true;
+	if ( !previous.index_enabled_ ) {
+		return false;
+	}
+	index_prev_ = previous.index_;
+	index_loaded_ = true;
+	return true;
+}
+
+void
+WantParser::saveIndex( const std::string & fn ) const {
+
+	if ( !index_enabled_ ) {
+		throw std::logic_error("The line index has not been enabled");
+	}
+
+	/* Write to a temporary file; rename into place. */
+	const std::string tmp = fn + ".tmp";
+	{
+		std::ofstream ofs( tmp, std::ios::out | std::ios::binary | std::ios::trunc );
+		ofs << INDEX_HEADER << '\n';
+		for ( auto const & entry : index_ ) {
+			auto const & indexed = entry.second;
+			ofs << entry.first << ' ' << indexed.kind << ' '
+				<< indexed.line.size() << ':' << indexed.line << ' '
+				<< indexed.tokens.size();
+			for ( auto const & token : indexed.tokens ) {
+				ofs << ' ' << token.size() << ':' << token;
+			}
+			ofs << '\n';
+		}
+		if ( !ofs ) {
+			throw std::runtime_error("Failed to write "
+					+ tmp);
+		}
+	}
+
+	if ( std::rename( tmp.c_str(), fn.c_str() ) != 0 ) {
+		throw std::runtime_error("Failed to write "
+				+ fn);
+	}
+}
+
+WantParser::IndexStats
+WantParser::getIndexStats() const {
+
+	IndexStats stats = index_stats_;
+	stats.dropped = index_prev_.size();
+	return stats;
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS - LINE INDEX
+ **************************************/
+
+WantParser::Tokens_
+WantParser::tokenize_( const std::string & line,
+		char kind,
+		const std::regex & regex ) {
+
+	line_fresh_ = true;
+	if ( !index_enabled_ ) {
+		return split_( line, regex, arena_ );
+	}
+
+	/* The index outlives the arena; copy the tokens in and out. */
+	auto const fromIndex = [this]( const IndexedLine_ & indexed ) {
+		Tokens_ tokens( arena_ );
+		tokens.reserve( indexed.tokens.size() );
+		for ( auto const & token : indexed.tokens ) {
+			tokens.emplace_back( token.begin(), token.end(), arena_ );
+		}
+		return tokens;
+	};
+
+	/* A hit only if the very same line; not merely the same hash. */
+	auto const same = [&]( const IndexedLine_ & indexed ) {
+		return ( indexed.kind == kind ) && ( indexed.line == line );
+	};
+
+	const uint64_t hash = hashLine_( line, kind );
+
+	/* Repeated within this parse. */
+	auto it = index_.find( hash );
+	if (( it != index_.end() ) && same( it->second )) {
+		line_fresh_ = false;
+		++ index_stats_.reused;
+		return fromIndex( it->second );
+	}
+
+	/* Unchanged since the previous parse. */
+	auto prev = index_prev_.find( hash );
+	if (( it == index_.end() ) && ( prev != index_prev_.end() )
+			&& same( prev->second )) {
+		line_fresh_ = false;
+		++ index_stats_.reused;
+		it = index_.emplace( hash, std::move(prev->second) ).first;
+		index_prev_.erase( prev );
+		return fromIndex( it->second );
+	}
+
+	/* New or changed, or a collision;
+	 * the first line of each hash is kept. */
+	++ index_stats_.tokenized;
+	auto tokens = split_( line, regex, arena_ );
+	if ( it == index_.end() ) {
+		IndexedLine_ indexed;
+		indexed.kind = kind;
+		indexed.line = line;
+		indexed.tokens.reserve( tokens.size() );
+		for ( auto const & token : tokens ) {
+			indexed.tokens.emplace_back( token.begin(), token.end() );
+		}
+		index_.emplace( hash, std::move(indexed) );
+	}
+	return tokens;
+}
+
+uint64_t
+WantParser::hashLine_( const std::string & line, char kind ) {
+
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto const mix = [&hash]( unsigned char c ) {
+		hash ^= c;
+		hash *= 0x100000001b3ULL;
+	};
+	mix( kind );
+	for ( const unsigned char c : line ) {
+		mix( c );
+	}
+	return hash;
+}
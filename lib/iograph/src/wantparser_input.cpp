@@ -16,11 +16,16 @@
  * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <iograph/wantparser.hpp>
+#include <iograph/inflater.hpp>
+#include <iograph/progress.hpp>
+#include <iograph/trace.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <memory>
 #include <sstream>
 
-#include "PracticalSocket.hpp"
 
 /**************************************
  * 	PUBLIC METHODS - PARSING
@@ -29,36 +34,43 @@
 void
 WantParser::parseUrl( const std::string & url ) {
 
-	/* Payload data. */
-	std::string data;
+	HttpClient client;
+	this->parseUrl( url, client );
+}
 
-	/* Retrieve the remote file. */
-	try {
-		getUrl_( url, data );
+void
+WantParser::parseUrl( const std::string & url, HttpClient & client ) {
 
-	} catch ( const socket_utils::SocketException & error ) {
-		throw std::runtime_error("Socket Exception: "
-				+ std::string(error.what()));
+	TraceZone zone("parse-url", "iograph");
+
+	/* Retrieve the remote file;
+	 * parse the payload as it arrives. */
+	try {
+		getUrl_( url, client, [this]( const char * data, size_t length ) {
+			this->parseChunk( data, length );
+		});
 
 	} catch ( const std::exception & error ) {
 		throw std::runtime_error("Error during retrieving data: "
 				+ std::string(error.what()));
 	}
 
-	/* Append data to input buffer. */
-	std::stringstream input_buffer;
-	input_buffer << data;
-
-	/* Parse the want-file buffer. */
-	this->parseStream(input_buffer);
+	/* Parse the last line, if not terminated. */
+	this->parseEnd();
 }
 
 void
 WantParser::parseFile( const std::string & fn ) {
 
+	TraceZone zone("parse-file", "iograph");
+
+	/* gzip-compressed files are decompressed while parsed. */
+	const bool gzip = Inflater::isGzipFile(fn);
+
 	/* Open the file. */
 	std::filebuf fb;
-	auto fb_ptr = fb.open(fn, std::ios::in);
+	auto fb_ptr = fb.open(fn, gzip ?
+			( std::ios::in | std::ios::binary ) : std::ios::in);
 
 	/* Check if failed */
 	if ( fb_ptr == NULL ) {
@@ -69,7 +81,11 @@ WantParser::parseFile( const std::string & fn ) {
 	/* Parse the want-file. */
 	std::istream is(&fb);
 	try {
-		this->parseStream(is);
+		if ( gzip ) {
+			this->parseGzipStream_(is);
+		} else {
+			this->parseStream(is);
+		}
 	} catch ( const std::exception & e ) {
 		/* If any exception is caught, close the file first.
 		 * Then re-throw. */
@@ -84,175 +100,141 @@ WantParser::parseFile( const std::string & fn ) {
 void
 WantParser::parseStream( std::istream & is ) {
 
-	/* We will read line-by-line.
-	 * Allocate a buffer to read. */
-	const size_t BUFSIZE = (1<<10);
-	std::string buffer;
-	buffer.reserve(BUFSIZE);
+	TraceZone zone("parse", "iograph");
 
-	/* The line number. */
-	uint64_t line_n = 0;
+	/* Read in blocks and feed them to the parser. */
+	const size_t BUFSIZE = (1<<16);
+	auto buffer = std::make_unique<char[]>(BUFSIZE);
 
-	/* Repeat for every line
+	/* Repeat for every block
 	 * until the end of the stream. */
-	while (std::getline( is, buffer )) {
-
-		/* Increase line number;
-		 * useful to document the line number if it throws an error. */
-		++ line_n;
-		try {
-			/* Parse the individual line. */
-			this->parseLine_( buffer );
-
-		} catch ( const std::runtime_error & e ) {
-
-			/* Add the exception text to the error list.
-			 * Continue with the next line. */
-			this->errors_.push_back( std::to_string(line_n)
-					+ ":"
-					+ e.what() );
-		}
+	while ( is ) {
+		is.read( buffer.get(), BUFSIZE );
+		this->parseChunk( buffer.get(), is.gcount() );
 	}
-}
 
-/************************************************
- * 	STATIC PRIVATE METHODS - INPUT UTILS	*
- ************************************************/
+	/* Parse the last line, if not terminated. */
+	this->parseEnd();
+}
 
 void
-WantParser::getUrl_( const std::string & url,
-		std::string & data ) {
+WantParser::parseChunk( const char * data, size_t length ) {
 
-	/* Clear the input data. */
-	data.clear();
+	Cancellation::check();
 
-	/* Sanity check: url beginning with 'http://' */
-	if ( url.compare(0,7,"http://") != 0 ) {
-		throw std::runtime_error("Provided url "
-				"is not HTTP; "
-				"expected url beginning "
-				"with 'http://'");
-	}
+	const char * const end = data + length;
+	std::string line;
 
-	size_t prot_pos = url.find("/",7);
-	if ( prot_pos == std::string::npos ) {
-		throw std::logic_error("Could not find '/'"
-				" in well-formed HTTP header.");
-	}
+	/* Repeat for every complete line. */
+	while ( data < end ) {
 
-	/* Craft server url. Craft request url. */
-	const std::string
-		server  = url.substr(7,prot_pos-7), /* strip 'http://' */
-		request = "GET "
-			+ url.substr(prot_pos,std::string::npos)
-			+ " HTTP/1.1\r\n"
-			+ "Host: " + server + "\r\n"
-			+ "\r\n";
-
-	/* Open the socket;
-	 * socket destructor will close it.
-	 * Throws exception on failure. */
-	socket_utils::TCPSocket sock(server, 80);
-
-	/* Send the HTTP request. */
-	sock.send(request.c_str(), request.length());
-
-	/* Receive buffer. */
-	const int BUFSIZE = (10 * (1 << 20));
-	auto buffer = std::make_unique<char[]>(BUFSIZE);
+		const char * eol = static_cast< const char * >(
+				std::memchr( data, '\n', end - data ));
 
-	/* Fetch the HTTP header. */
-	int message_size = sock.recv(buffer.get(), BUFSIZE);
-	if ( message_size <= 0 ) {
-		throw std::runtime_error("No data received");
+		/* Incomplete line; keep it for the next chunk. */
+		if ( eol == NULL ) {
+			partial_line_.append( data, end );
+			break;
+		}
+
+		/* Complete the line started in a previous chunk. */
+		if ( partial_line_.empty() ) {
+			line.assign( data, eol );
+		} else {
+			partial_line_.append( data, eol );
+			line.swap( partial_line_ );
+			partial_line_.clear();
+		}
+
+		this->parseNextLine_( line );
+		data = eol + 1;
 	}
+}
 
-	int payload  = 0;	/* total payload size */
-	int received = 0;	/* data retrieved so far */
+void
+WantParser::parseEnd() {
 
-	/* Open scope to calculate
-	 * content length and remove header. */
-	{
-		std::string header(buffer.get(), message_size);
+	if ( !partial_line_.empty() ) {
+		std::string line;
+		line.swap( partial_line_ );
+		this->parseNextLine_( line );
+	}
 
-		/* Get the response code. */
-		size_t i = header.find("HTTP/1.1 ");
-		if ( i == std::string::npos ) {
-			throw std::runtime_error("Malformed HTTP "
-					"header; could not find "
-					" 'HTTP/1.1'");
-		}
-		size_t code_start = i + 9;
+	/* Next input starts from line 1. */
+	line_n_ = 0;
 
-		i = header.find_first_of("\n\r", code_start);
-		size_t code_end = i;
+	/* Free the temporaries of the whole parse at once. */
+	arena_.release();
+}
 
-		const std::string & response_code =
-			header.substr(code_start, code_end-code_start);
+/**************************************
+ * 	PRIVATE METHODS - PARSING
+ **************************************/
 
-		if ( response_code.compare("200 OK") != 0 ) {
-			throw std::runtime_error("Unexpected response code; "
-					"received " + response_code);
-		}
+void
+WantParser::parseGzipStream_( std::istream & is ) {
 
-		/* Get the content length. */
-		i = header.find("Content-Length: ");
-		if ( i == std::string::npos ) {
-			throw std::runtime_error("Malformed HTTP "
-					"header; could not find "
-					" 'Content-Length'");
-		}
-		size_t content_start = i + 16;
+	/* Read compressed blocks; feed the parser
+	 * as soon as they are decompressed. */
+	const size_t BUFSIZE = (1<<16);
+	auto buffer = std::make_unique<char[]>(BUFSIZE);
+	Inflater inflater;
+	auto const sink = [this]( const char * data, size_t length ) {
+		this->parseChunk( data, length );
+	};
+
+	while ( is ) {
+		is.read( buffer.get(), BUFSIZE );
+		inflater.feed( buffer.get(), is.gcount(), sink );
+	}
+	inflater.finish();
 
-		i = header.find_first_of("\n\r ", content_start);
-		if ( i == std::string::npos ) {
-			throw std::logic_error("Receive buffer "
-					"is too short");
-		}
-		size_t content_end = i;
-
-		/* Get the payload substring.
-		 * Convert to integer. */
-		const std::string & content =
-			header.substr(content_start, content_end-content_start);
-		payload = std::stoi(content);
-
-		/* HTTP headers end with an empty line,
-		 * as the protocol specifies. */
-		i = header.find("\r\n\r\n");
-		if ( i == std::string::npos ) {
-			throw std::runtime_error("Malformed HTTP "
-					"header; could not determine "
-					" header end");
-		}
+	/* Parse the last line, if not terminated. */
+	this->parseEnd();
+}
+
+void
+WantParser::parseNextLine_( const std::string & line ) {
 
-		size_t payload_pos = i + 4;
+	/* Increase line number;
+	 * useful to document the line number of any error.
+	 * Malformed lines are recorded by error_(), without throwing. */
+	++ line_n_;
+	line_ = &line;
+	try {
+		/* Parse the individual line. */
+		this->parseLine_( line );
 
-		const std::string & payload =
-			header.substr(payload_pos, std::string::npos);
+	} catch ( const std::runtime_error & e ) {
 
-		data.append(payload);
-		received += payload.length();
+		/* Unexpected failure, e.g., of the tokenizer.
+		 * Add the exception text to the error list.
+		 * Continue with the next line. */
+		this->errors_.add( line_n_, 0, Diagnostic::MESSAGE, e.what() );
 	}
+	line_ = nullptr;
 
-	/* Receive response until
-	 * no further bytes are received. */
-	while ((message_size = sock.recv(buffer.get(), BUFSIZE)) > 0 ) {
-		data.append(buffer.get(), message_size);
-		received += message_size;
+	/* The tokens of the line are no longer referenced. */
+	arena_.reset();
+}
 
-		if ( received >= payload ) {
-			break;
-		}
-	}
+/************************************************
+ * 	STATIC PRIVATE METHODS - INPUT UTILS	*
+ ************************************************/
 
-	/* Sanity check if we have received the expected
-	 * number of bytes. */
-	if ( received != payload ) {
-		throw std::logic_error("Expected payload of "
-				+ std::to_string(payload)
-				+ " bytes; received "
-				+ std::to_string(received)
-				+ " bytes");
+void
+WantParser::getUrl_( const std::string & url,
+		HttpClient & client,
+		const HttpClient::Sink & sink ) {
+
+	/* Want-lists are plain text and compress well;
+	 * the client decompresses the payload as it arrives. */
+	const HttpClient::Response response = client.get( url, sink,
+			{{ "Accept-Encoding", "gzip" }} );
+
+	if ( response.status != 200 ) {
+		throw std::runtime_error("Unexpected response code; "
+				"received " + std::to_string(response.status)
+				+ " " + response.reason);
 	}
 }
@@ -0,0 +1,179 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iograph/wantparser.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <set>
+#include <thread>
+
+
+/**************************************
+ * 	PUBLIC METHODS - COMBINED TRADES
+ **************************************/
+
+void
+WantParser::parseFiles( const std::vector< std::string > & files,
+		const std::vector< std::string > & namespaces ) {
+
+	if ( !namespaces.empty() && ( namespaces.size() != files.size() )) {
+		throw std::logic_error("Expected one namespace per file");
+	}
+
+	/* Default namespace: the file name up to its first '.'. */
+	std::vector< std::string > ns( files.size() );
+	std::set< std::string > given;
+	for ( size_t i = 0; i < files.size(); ++ i ) {
+
+		if ( !namespaces.empty() && !namespaces[i].empty() ) {
+			ns[i] = namespaces[i];
+		} else {
+			const auto & fn = files[i];
+			const auto slash = fn.find_last_of('/');
+			const auto base = ( slash == std::string::npos ) ? 0 : slash + 1;
+			ns[i] = fn.substr( base, fn.find('.', base) - base );
+		}
+
+		if ( !given.insert( ns[i] ).second ) {
+			throw std::runtime_error("Namespace " + ns[i]
+					+ " given for more than one file");
+		}
+	}
+
+	/* Parse each file on its own thread. */
+	std::vector< WantParser > parsers( files.size() );
+	std::vector< std::exception_ptr > errors( files.size() );
+	std::vector< std::thread > threads;
+	threads.reserve( files.size() );
+
+	for ( size_t i = 0; i < files.size(); ++ i ) {
+		threads.emplace_back( [&, i]() {
+			try {
+				parsers[i].parseFile( files[i] );
+			} catch ( ... ) {
+				errors[i] = std::current_exception();
+			}
+		});
+	}
+	for ( auto & thread : threads ) {
+		thread.join();
+	}
+
+	for ( auto const & error : errors ) {
+		if ( error ) {
+			std::rethrow_exception( error );
+		}
+	}
+
+	/* Merge in the given order. */
+	for ( size_t i = 0; i < files.size(); ++ i ) {
+		this->merge( parsers[i], ns[i] );
+	}
+}
+
+void
+WantParser::merge( const WantParser & other, const std::string & ns ) {
+
+	/* The namespace is separated by ':', which may not appear
+	 * in want-list items; '%' would turn items into dummies. */
+	const bool valid = !ns.empty()
+		&& std::none_of( ns.begin(), ns.end(), []( unsigned char c ) {
+				return std::isspace(c) || ( c == ':' ) || ( c == '%' );
+			});
+	if ( !valid ) {
+		throw std::runtime_error("Invalid namespace \"" + ns + "\"");
+	}
+
+	/* The priority scheme re-ranks the entire graph. */
+	if ( !other.priority_scheme_.empty() ) {
+		if ( this->priority_scheme_.empty() ) {
+			this->priority_scheme_ = other.priority_scheme_;
+		} else if ( this->priority_scheme_ != other.priority_scheme_ ) {
+			throw std::runtime_error("Conflicting priority schemes "
+					+ this->priority_scheme_
+					+ " and "
+					+ other.priority_scheme_
+					+ " in namespace "
+					+ ns);
+		}
+	}
+
+	/* Options given in any file. */
+	for ( size_t i = 0; i < bool_options_.size(); ++ i ) {
+		if ( other.bool_options_[i] ) {
+			this->bool_options_[i] = true;
+		}
+	}
+	for ( auto const & option : other.given_options_ ) {
+		auto const & options = this->given_options_;
+		if ( std::find( options.begin(), options.end(), option )
+				== options.end() ) {
+			this->given_options_.push_back( option );
+		}
+	}
+
+	/* Items and their owners. */
+	for ( auto const & node_pair : other.node_map_ ) {
+
+		auto const & node = node_pair.second;
+		const std::string item = applyNamespace_( ns, node.item );
+
+		const bool inserted = this->node_map_.emplace( item,
+				Node_t_( item,
+					node.official_name,
+					ns + ":" + node.username )).second;
+		if ( !inserted ) {
+			throw std::runtime_error("Item " + item
+					+ " has already been merged");
+		}
+	}
+
+	/* Want-lists. */
+	for ( auto const & arc_pair : other.arc_map_ ) {
+
+		auto & arcs = this->arc_map_[ applyNamespace_( ns, arc_pair.first ) ];
+		arcs.reserve( arcs.size() + arc_pair.second.size() );
+		for ( auto const & arc : arc_pair.second ) {
+			arcs.emplace_back( applyNamespace_( ns, arc.item_s ),
+					applyNamespace_( ns, arc.item_t ),
+					arc.rank );
+		}
+	}
+
+	/* Errors, reported as NS:LINE:ERROR. */
+	this->errors_.merge( other.errors_, ns );
+
+	/* No more options may be given. */
+	this->status_ = std::max( this->status_, other.status_ );
+}
+
+
+/***************************************
+ * 	PRIVATE STATIC METHODS - NAMESPACES
+ **************************************/
+
+std::string
+WantParser::applyNamespace_( const std::string & ns,
+		const std::string & item ) {
+
+	if ( isDummy_(item) ) {
+		return "%" + ns + ":" + item.substr(1);
+	}
+	return ns + ":" + item;
+}
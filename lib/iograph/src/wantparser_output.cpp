@@ -16,6 +16,7 @@
  * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <iograph/wantparser.hpp>
+#include <iograph/trace.hpp>
 
 #include <fstream>
 #include <unordered_set>
@@ -56,6 +57,8 @@ WantParser::print( const std::string & fn ) const {
 void
 WantParser::print( std::ostream &os ) const {
 
+	TraceZone zone("print-lgf", "iograph");
+
 	// Print Nodes in LGF file
 	os << "@nodes"
 		<< std::endl
@@ -183,12 +186,15 @@ WantParser::printErrors( std::ostream & os ) const {
 	 * only if there are any actual errors to report. */
 	if ( ! this->errors_.empty() ) {
 		os << "ERRORS" << std::endl;
-		for ( auto const & err : this->errors_ ) {
-			os << "**** " << err << std::endl;
-		}
+		this->errors_.print( os, "**** " );
 	}
 }
 
+const Diagnostics &
+WantParser::getErrors() const {
+	return errors_;
+}
+
 /********************************************************
  *	PUBLIC METHODS - EXTERNAL OPTIONS OUTPUT	*
  ********************************************************/
@@ -325,3 +331,46 @@ WantParser::getNumTradingUsers() const {
 	}
 	return username_set.size();
 }
+
+void
+WantParser::memoryUsage( MemoryReport & report ) const {
+
+	size_t bytes = 0;
+	for ( auto const & pair : this->node_map_ ) {
+		auto const & node = pair.second;
+		bytes += MemoryReport::NODE_OVERHEAD + sizeof(pair)
+			+ MemoryReport::heapBytes( pair.first )
+			+ MemoryReport::heapBytes( node.item )
+			+ MemoryReport::heapBytes( node.official_name )
+			+ MemoryReport::heapBytes( node.username );
+	}
+	report.add( "WantParser::node_map_", bytes );
+
+	bytes = 0;
+	for ( auto const & pair : this->arc_map_ ) {
+		auto const & arcs = pair.second;
+		bytes += MemoryReport::NODE_OVERHEAD + sizeof(pair)
+			+ MemoryReport::heapBytes( pair.first )
+			+ arcs.capacity() * sizeof( Arc_t_ );
+		for ( auto const & arc : arcs ) {
+			bytes += MemoryReport::heapBytes( arc.item_s )
+				+ MemoryReport::heapBytes( arc.item_t );
+		}
+	}
+	report.add( "WantParser::arc_map_", bytes );
+
+	/* Buckets, then a node per line. */
+	bytes = 0;
+	for ( auto const * index : { &this->index_, &this->index_prev_ } ) {
+		bytes += index->bucket_count() * sizeof(void *);
+		for ( auto const & pair : *index ) {
+			bytes += sizeof(void *) + sizeof(pair)
+				+ MemoryReport::heapBytes( pair.second.line )
+				+ pair.second.tokens.capacity() * sizeof( std::string );
+			for ( auto const & token : pair.second.tokens ) {
+				bytes += MemoryReport::heapBytes( token );
+			}
+		}
+	}
+	report.add( "WantParser line index", bytes );
+}
@@ -17,7 +17,7 @@
  */
 #include <iograph/wantparser.hpp>
 
-void
+bool
 WantParser::parseWantList_( const std::string & line ) {
 
 	static const std::regex FPAT_want(
@@ -47,9 +47,9 @@ WantParser::parseWantList_( const std::string & line ) {
 	 */
 
 	/* Tokenize the line. */
-	auto const match = split_( line, FPAT_want );
+	auto const match = tokenize_( line, 'W', FPAT_want );
 	if ( match.empty() ) {
-		throw std::runtime_error("Bad format of want list");
+		return error_( Diagnostic::BAD_WANT_LIST );
 	}
 
 	/********************************
@@ -65,7 +65,7 @@ WantParser::parseWantList_( const std::string & line ) {
 	if ( !username.empty() ) {
 		++ n_pos ;
 	} else if (  this->bool_options_[ REQUIRE_USERNAMES ] ) {
-		throw std::runtime_error("Missing username from want list");
+		return error_( Diagnostic::MISSING_USERNAME );
 	}
 
 	/****************************************
@@ -75,17 +75,27 @@ WantParser::parseWantList_( const std::string & line ) {
 	/* Check whether we have reached the end of the line.
 	 * If so, the wanted item name is missing. */
 	if ( n_pos >= match.size() ) {
-		throw std::runtime_error("Missing offered item from want list");
+		return error_( Diagnostic::MISSING_SOURCE );
 	}
-	const std::string & original_source = match.at(n_pos);
+	const ArenaString & original_source = match.at(n_pos);
 
 	/* Convert item name. */
-	const std::string source = convertItemName_( original_source, username );
+	std::string source;
+	if ( !convertItemName_( original_source, username, source ) ) {
+		return false;
+	}
 
 	/* Add source item.
 	 * Item name is also used as the 'official' name
 	 */
-	this->addSourceItem_( source, source, username );
+	if ( !this->addSourceItem_( source, source, username ) ) {
+		return false;
+	}
+
+	/* Report new or changed want-lists against a loaded index. */
+	if ( index_loaded_ && line_fresh_ ) {
+		index_stats_.changed_items.push_back( source );
+	}
 
 	/* Finally, advance n_pos.
 	 * We should always have an offering item. */
@@ -105,7 +115,7 @@ WantParser::parseWantList_( const std::string & line ) {
 		if ( has_colon ) {
 			++ n_pos;
 		} else if ( this->bool_options_[REQUIRE_COLONS] ) {
-			throw std::runtime_error("Missing colon from want list");
+			return error_( Diagnostic::MISSING_COLON );
 		}
 	}
 
@@ -114,15 +124,11 @@ WantParser::parseWantList_( const std::string & line ) {
 	 *	WANTED ITEMS (targets)	*
 	 ********************************/
 
-	/* Copy wanted items; first begins at n_pos */
-	const auto wanted_items = std::vector< std::string >(
-			match.begin() + n_pos,
-			match.end());
-
-	this->addTargetItems_( source, wanted_items );
+	/* Wanted items; first begins at n_pos */
+	return this->addTargetItems_( source, match.begin() + n_pos, match.end() );
 }
 
-void
+bool
 WantParser::addSourceItem_( const std::string & source,
 		const std::string & official_name,
 		const std::string & username_orig) {
@@ -165,11 +171,7 @@ WantParser::addSourceItem_( const std::string & source,
 				 * Otherwise, proceed to add.
 				 */
 				if ( !isDummy_(source) ) {
-
-					throw std::runtime_error("Non-dummy item "
-							+ source
-							+ " has no official name."
-							" Hint: spelling error?");
+					return error_( Diagnostic::NO_OFFICIAL_NAME, source );
 				}
 				break;
 			}
@@ -200,9 +202,7 @@ WantParser::addSourceItem_( const std::string & source,
 				/* We are currently reading official names.
 				 * Ignore any item attempted to be inserted twice.
 				 */
-				throw std::runtime_error("Existing entry for item "
-						+ source);
-				break;
+				return error_( Diagnostic::EXISTING_ENTRY, source );
 			}
 			case PARSE_WANTS_WITHNAMES:
 			case PARSE_WANTS_NONAMES: {
@@ -222,8 +222,7 @@ WantParser::addSourceItem_( const std::string & source,
 
 				if ( source_has_wantlist ) {
 					/* Condition must be true. */
-					throw std::runtime_error("Ignoring multiple wantlist for item "
-							+ source);
+					return error_( Diagnostic::REPEATED_WANT_LIST, source );
 				} else if ( this->status_ == PARSE_WANTS_NONAMES ) {
 					/* Sanity check. If no official names are being read
 					 * an existing item MUST have a want-list. */
@@ -241,20 +240,20 @@ WantParser::addSourceItem_( const std::string & source,
 			}
 		}
 	}
+	return true;
 }
 
-void
-WantParser::addTargetItems_( const std::string & source, const std::vector< std::string > & wanted_items ) {
+bool
+WantParser::addTargetItems_( const std::string & source,
+		Tokens_::const_iterator first,
+		Tokens_::const_iterator last ) {
 
 	/* Check if want list already exists.
 	 * This may happen if a user has defined multiple want lists
 	 * or another line was split over two lines.
 	 */
 	if ( arc_map_.find(source) != arc_map_.end() ) {
-		throw std::runtime_error("Multiple want lists for item "
-				+ source
-				+ ". Hint: check if an item want-list line has been split"
-				+ " over two lines.");
+		return error_( Diagnostic::MULTIPLE_WANT_LISTS, source );
 	}
 
 	/* Initialize rank. */
@@ -266,14 +265,18 @@ WantParser::addTargetItems_( const std::string & source, const std::vector< std:
 	 * to the official graph
 	 * if *no errors* whatsoever are detected.
 	 * On errors, the whole line is discarded.
+	 * Allocated from the arena of the line.
 	 */
-	std::list< Arc_t_ > arcs_to_add;
+	ArenaVector< Arc_t_ > arcs_to_add( arena_ );
+	arcs_to_add.reserve( last - first );
 
 	/********************************
 	 *	WANTED ITEMS ITERATOR	*
 	 ********************************/
 
-	for ( const auto & target : wanted_items ) {
+	for ( ; first != last; ++ first ) {
+
+		const ArenaString & target = *first;
 
 		/* Small and big steps. */
 		const auto register & small_step = int_options_[SMALL_STEP];
@@ -289,12 +292,15 @@ WantParser::addTargetItems_( const std::string & source, const std::vector< std:
 		if ( target.compare(";") == 0 ) {
 			rank += big_step;
 		} else if ( target.compare(":") == 0 ) {
-			throw std::runtime_error("Invalid colon occurence.");
+			return error_( Diagnostic::INVALID_COLON );
 		} else {
 
 			/* Parse the item name (dummy, uppercase, etc). */
 			const auto & username = this->node_map_.at( source ).username;
-			const auto converted_target_name = convertItemName_( target, username );
+			std::string converted_target_name;
+			if ( !convertItemName_( target, username, converted_target_name ) ) {
+				return false;
+			}
 
 			/* Push (item-target) arc to map. */
 			arcs_to_add.push_back(Arc_t_( source, converted_target_name, rank ));
@@ -305,7 +311,7 @@ WantParser::addTargetItems_( const std::string & source, const std::vector< std:
 	}
 
 	/* Create ArcMap entry for item;
-	 * in C++11 we can directly move the items from the original list
+	 * in C++11 we can directly move the items from the arena
 	 * to the vector; we don't have to copy them!
 	 */
 	auto pair = arc_map_.emplace(
@@ -319,4 +325,5 @@ WantParser::addTargetItems_( const std::string & source, const std::vector< std:
 	if ( !pair.second ) {
 		throw std::logic_error("Could not insert arcs in arc_map_.");
 	}
+	return true;
 }
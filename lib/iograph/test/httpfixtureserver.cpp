@@ -0,0 +1,370 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "httpfixtureserver.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <zlib.h>
+
+#include "PracticalSocket.hpp"
+
+
+/**************************************
+ * 	PUBLIC METHODS - CONSTRUCTORS
+ **************************************/
+
+HttpFixtureServer::HttpFixtureServer() :
+	listener_( new socket_utils::TCPServerSocket("127.0.0.1", 0, 64) )
+{
+	port_ = listener_->getLocalPort();
+	acceptor_ = std::thread( &HttpFixtureServer::acceptLoop_, this );
+}
+
+HttpFixtureServer::~HttpFixtureServer() {
+
+	/* Wake up the acceptor with a dummy connection. */
+	stopping_ = true;
+	try {
+		socket_utils::TCPSocket wake("127.0.0.1", port_);
+	} catch ( const socket_utils::SocketException & ) {
+	}
+	acceptor_.join();
+
+	/* Unblock connections still waiting for requests. */
+	std::vector< std::thread > threads;
+	{
+		std::lock_guard< std::mutex > lock(mutex_);
+		for ( auto & sock : open_ ) {
+			sock->shutdown();
+		}
+		threads.swap( threads_ );
+	}
+	for ( auto & thread : threads ) {
+		thread.join();
+	}
+}
+
+
+/**************************************
+ * 	PUBLIC METHODS - RESOURCES
+ **************************************/
+
+void
+HttpFixtureServer::serve( const std::string & path,
+		const std::string & body,
+		const Response & response ) {
+
+	auto resource = std::make_shared< Resource_ >();
+	resource->body = body;
+	resource->response = response;
+	if ( response.gzip ) {
+		resource->gzip_body = gzip_( body );
+	}
+
+	std::lock_guard< std::mutex > lock(mutex_);
+	resources_[path] = resource;
+}
+
+void
+HttpFixtureServer::serve( const std::string & path,
+		const std::string & body ) {
+	serve( path, body, Response() );
+}
+
+void
+HttpFixtureServer::serveFile( const std::string & path,
+		const std::string & fn,
+		const Response & response ) {
+
+	std::ifstream ifs(fn, std::ios::binary);
+	if ( !ifs ) {
+		throw std::runtime_error("Failed to open "
+				+ fn);
+	}
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	serve( path, ss.str(), response );
+}
+
+void
+HttpFixtureServer::serveFile( const std::string & path,
+		const std::string & fn ) {
+	serveFile( path, fn, Response() );
+}
+
+std::string
+HttpFixtureServer::url( const std::string & path ) const {
+	return "http://127.0.0.1:" + std::to_string(port_) + path;
+}
+
+unsigned short
+HttpFixtureServer::port() const {
+	return port_;
+}
+
+unsigned
+HttpFixtureServer::connections() const {
+	return connections_;
+}
+
+unsigned
+HttpFixtureServer::requests() const {
+	return requests_;
+}
+
+HttpFixtureServer::Request
+HttpFixtureServer::lastRequest() const {
+	std::lock_guard< std::mutex > lock(mutex_);
+	return last_request_;
+}
+
+
+/**************************************
+ * 	PRIVATE METHODS - SERVING
+ **************************************/
+
+std::string
+HttpFixtureServer::gzip_( const std::string & data ) {
+
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+
+	/* 15 bits of window; +16 for the gzip wrapper. */
+	if ( deflateInit2( &strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK ) {
+		throw std::runtime_error("Failed to initialize zlib");
+	}
+
+	std::string out( deflateBound( &strm, data.size() ), '\0' );
+	strm.next_in = reinterpret_cast< Bytef * >( const_cast< char * >(data.data()) );
+	strm.avail_in = data.size();
+	strm.next_out = reinterpret_cast< Bytef * >( &out[0] );
+	strm.avail_out = out.size();
+
+	const int rtn = deflate( &strm, Z_FINISH );
+	out.resize( strm.total_out );
+	deflateEnd( &strm );
+
+	if ( rtn != Z_STREAM_END ) {
+		throw std::runtime_error("Failed to compress");
+	}
+	return out;
+}
+
+void
+HttpFixtureServer::acceptLoop_() {
+
+	while ( !stopping_ ) {
+
+		std::shared_ptr< socket_utils::TCPSocket > sock;
+		try {
+			sock.reset( listener_->accept() );
+		} catch ( const socket_utils::SocketException & ) {
+			continue;
+		}
+
+		if ( stopping_ ) {
+			break;
+		}
+		++ connections_;
+
+		std::lock_guard< std::mutex > lock(mutex_);
+		open_.push_back( sock );
+		threads_.emplace_back( &HttpFixtureServer::serveConnection_, this, sock );
+	}
+}
+
+void
+HttpFixtureServer::serveConnection_( std::shared_ptr< socket_utils::TCPSocket > sock ) {
+
+	/* Bytes received but not parsed yet. */
+	std::string pending;
+	char buffer[4096];
+
+	try {
+		while ( !stopping_ ) {
+
+			/* Read until the end of the request header. */
+			size_t end;
+			while (( end = pending.find("\r\n\r\n") ) == std::string::npos ) {
+				const int n = sock->recv( buffer, sizeof(buffer) );
+				if ( n <= 0 ) {
+					break;
+				}
+				pending.append( buffer, n );
+			}
+			if ( end == std::string::npos ) {
+				break;
+			}
+
+			/* Request line and header fields. */
+			std::stringstream ss( pending.substr(0, end) );
+			pending.erase( 0, end + 4 );
+
+			Request request;
+			std::string line, version;
+			std::getline( ss, line );
+			std::stringstream( line ) >> request.method >> request.target >> version;
+
+			while ( std::getline(ss, line) ) {
+				if ( !line.empty() && ( line.back() == '\r' ) ) {
+					line.pop_back();
+				}
+				const size_t colon = line.find(':');
+				if ( colon == std::string::npos ) {
+					continue;
+				}
+				std::string name = line.substr(0, colon);
+				std::transform( name.begin(), name.end(), name.begin(), ::tolower );
+				const size_t value = line.find_first_not_of(" \t", colon + 1);
+				request.headers[name] = ( value == std::string::npos ) ?
+					"" : line.substr(value);
+			}
+
+			{
+				std::lock_guard< std::mutex > lock(mutex_);
+				last_request_ = request;
+			}
+			++ requests_;
+
+			if ( !respond_( *sock, request ) ) {
+				break;
+			}
+		}
+	} catch ( const socket_utils::SocketException & ) {
+		/* Peer has gone away. */
+	}
+
+	/* Signal the end of the stream to the client;
+	 * the descriptor is closed with the server. */
+	sock->shutdown();
+}
+
+bool
+HttpFixtureServer::respond_( socket_utils::TCPSocket & sock,
+		const Request & request ) {
+
+	/* Look up the resource; ignore any query string. */
+	std::shared_ptr< const Resource_ > resource;
+	{
+		const std::string path = request.target.substr(0, request.target.find('?'));
+		std::lock_guard< std::mutex > lock(mutex_);
+		auto const it = resources_.find( path );
+		if ( it != resources_.end() ) {
+			resource = it->second;
+		}
+	}
+
+	if ( !resource ) {
+		const std::string msg = "HTTP/1.1 404 Not Found\r\n"
+			"Content-Length: 0\r\n"
+			"\r\n";
+		sock.send( msg.data(), msg.size() );
+		return true;
+	}
+
+	const Response & response = resource->response;
+
+	/* Compressed body, if accepted. */
+	auto const accept = request.headers.find("accept-encoding");
+	const bool gzip = response.gzip && ( accept != request.headers.end() )
+		&& ( accept->second.find("gzip") != std::string::npos );
+	const std::string & body = gzip ? resource->gzip_body : resource->body;
+
+	/* Conditional request on a matching validator. */
+	for ( auto const & field : response.headers ) {
+		std::string name = field.first;
+		std::transform( name.begin(), name.end(), name.begin(), ::tolower );
+		const std::string condition = ( name == "etag" ) ? "if-none-match" :
+			( name == "last-modified" ) ? "if-modified-since" : "";
+		auto const it = request.headers.find( condition );
+		if (( it != request.headers.end() ) && ( it->second == field.second )) {
+			const std::string msg = "HTTP/1.1 304 Not Modified\r\n"
+				+ field.first + ": " + field.second + "\r\n"
+				"\r\n";
+			sock.send( msg.data(), msg.size() );
+			return true;
+		}
+	}
+
+	/* Close-delimited bodies and explicit requests close the connection. */
+	auto const it = request.headers.find("connection");
+	const bool client_close = ( it != request.headers.end() )
+		&& ( it->second == "close" );
+	const bool keep_alive = response.keep_alive && !client_close
+		&& ( response.chunked || response.content_length );
+
+	/* Header. */
+	std::stringstream header;
+	header << "HTTP/1.1 " << response.status << " "
+		<< (( response.status == 200 ) ? "OK" : "Status")
+		<< "\r\n";
+	if ( response.chunked ) {
+		header << "Transfer-Encoding: chunked\r\n";
+	} else if ( response.content_length ) {
+		header << "Content-Length: " << body.size() << "\r\n";
+	}
+	if ( gzip ) {
+		header << "Content-Encoding: gzip\r\n";
+	}
+	for ( auto const & field : response.headers ) {
+		header << field.first << ": " << field.second << "\r\n";
+	}
+	header << "Connection: " << (keep_alive ? "keep-alive" : "close") << "\r\n"
+		<< "\r\n";
+
+	const std::string head = header.str();
+	sock.send( head.data(), head.size() );
+
+	/* Body, in pieces. */
+	const size_t limit = std::min( body.size(), response.drop_after );
+	const size_t piece = std::max< size_t >( 1, response.piece );
+
+	for ( size_t pos = 0; pos < limit; pos += piece ) {
+
+		if ( response.delay.count() > 0 ) {
+			std::this_thread::sleep_for( response.delay );
+		}
+		const size_t n = std::min( piece, limit - pos );
+
+		if ( response.chunked ) {
+			std::stringstream size;
+			size << std::hex << n << "\r\n";
+			const std::string chunk = size.str() + body.substr(pos, n) + "\r\n";
+			sock.send( chunk.data(), chunk.size() );
+		} else {
+			sock.send( body.data() + pos, n );
+		}
+	}
+
+	/* Drop the connection before the end of the body. */
+	if ( limit < body.size() ) {
+		return false;
+	}
+
+	if ( response.chunked ) {
+		const std::string last = "0\r\n\r\n";
+		sock.send( last.data(), last.size() );
+	}
+	return keep_alive;
+}
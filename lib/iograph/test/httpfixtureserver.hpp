@@ -0,0 +1,199 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _MATHTRADER_LIB_IOGRAPH_TEST_HTTPFIXTURESERVER_HPP_
+#define _MATHTRADER_LIB_IOGRAPH_TEST_HTTPFIXTURESERVER_HPP_
+
+/*! @file httpfixtureserver.hpp
+ *  @brief Loopback HTTP/1.1 server for tests and benchmarks
+ *
+ *  Serves want-list fixtures over the loopback interface,
+ *  so that WantParser::parseUrl() can be tested and benchmarked offline.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace socket_utils {
+	class TCPServerSocket;
+	class TCPSocket;
+}
+
+/*! @brief In-process HTTP/1.1 stand-in server.
+ *
+ *  Listens on an ephemeral port of ``127.0.0.1``
+ *  and serves registered resources from a background thread.
+ *  Each connection is served by its own thread;
+ *  connections are kept alive unless the client
+ *  or the resource requests otherwise.
+ *
+ *  Requests carrying ``If-None-Match`` or ``If-Modified-Since``
+ *  that match an ``ETag`` or ``Last-Modified`` header of the resource
+ *  are answered with ``304 Not Modified``.
+ *
+ *  Every resource carries a @ref Response describing
+ *  how its body is delivered: with or without ``Content-Length``,
+ *  chunked, gzip-compressed, trickled in small pieces with delays
+ *  or dropped after a number of bytes.
+ *
+ *  Example:
+ *
+ *  	HttpFixtureServer server;
+ *  	server.serveFile("/207635-officialwants.txt", fn);
+ *  	want_parser.parseUrl( server.url("/207635-officialwants.txt") );
+ */
+class HttpFixtureServer {
+
+public:
+	/*! @brief Delivery of a response.
+	 */
+	struct Response {
+		int status = 200;		/*!< HTTP status code */
+		bool content_length = true;	/*!< send ``Content-Length``;
+						  *  if ``false`` and not chunked,
+						  *  the body ends when the connection closes */
+		bool chunked = false;		/*!< use chunked transfer encoding */
+		size_t piece = (1 << 16);	/*!< bytes per write (and per chunk) */
+		std::chrono::milliseconds delay{0};	/*!< delay before each write */
+		size_t drop_after = std::string::npos;	/*!< close the connection
+							  *  after this many body bytes */
+		bool keep_alive = true;		/*!< keep the connection open afterwards */
+		bool gzip = false;		/*!< send the body gzip-compressed
+						  *  if the request accepts it */
+		std::vector< std::pair< std::string, std::string > >
+			headers;		/*!< additional response headers */
+	};
+
+	/*! @brief Received request.
+	 */
+	struct Request {
+		std::string method;	/*!< e.g., ``GET`` */
+		std::string target;	/*!< e.g., ``/207635-officialwants.txt`` */
+		std::map< std::string, std::string >
+			headers;	/*!< header fields; names in lowercase */
+	};
+
+	/*! @brief Start listening on an ephemeral loopback port.
+	 *
+	 *  @throws	socket_utils::SocketException if the socket cannot be bound
+	 */
+	HttpFixtureServer();
+
+	/*! @brief Stop the server and join all threads.
+	 */
+	~HttpFixtureServer();
+
+	HttpFixtureServer( const HttpFixtureServer & ) = delete;
+	HttpFixtureServer & operator=( const HttpFixtureServer & ) = delete;
+
+	/*! @brief Register a resource.
+	 *
+	 *  @param[in]	path	request path, e.g., ``/wants.txt``
+	 *  @param[in]	body	response payload
+	 *  @param[in]	response	delivery of the response
+	 */
+	void serve( const std::string & path,
+			const std::string & body,
+			const Response & response );
+
+	/*! @brief Register a resource with the default @ref Response. */
+	void serve( const std::string & path,
+			const std::string & body );
+
+	/*! @brief Register a file as a resource.
+	 *
+	 *  @param[in]	path	request path, e.g., ``/wants.txt``
+	 *  @param[in]	fn	file whose contents are served
+	 *  @param[in]	response	delivery of the response
+	 *  @throws	std::runtime_error if file ``fn`` cannot be opened
+	 */
+	void serveFile( const std::string & path,
+			const std::string & fn,
+			const Response & response );
+
+	/*! @brief Register a file with the default @ref Response. */
+	void serveFile( const std::string & path,
+			const std::string & fn );
+
+	/*! @brief URL of a resource.
+	 *
+	 *  @param[in]	path	request path, e.g., ``/wants.txt``
+	 *  @returns	the full URL, e.g., ``http://127.0.0.1:34567/wants.txt``
+	 */
+	std::string url( const std::string & path ) const ;
+
+	/*! @brief Listening port. */
+	unsigned short port() const ;
+
+	/*! @brief Number of accepted connections. */
+	unsigned connections() const ;
+
+	/*! @brief Number of served requests. */
+	unsigned requests() const ;
+
+	/*! @brief Most recently received request. */
+	Request lastRequest() const ;
+
+private:
+	/*! @brief Registered resource. */
+	struct Resource_ {
+		std::string body;
+		std::string gzip_body;	/*!< compressed once, if Response::gzip */
+		Response response;
+	};
+
+	std::unique_ptr< socket_utils::TCPServerSocket > listener_;
+	unsigned short port_ = 0;
+
+	std::atomic< bool > stopping_{false};
+	std::atomic< unsigned > connections_{0};
+	std::atomic< unsigned > requests_{0};
+
+	/*! @brief Guards @ref resources_, @ref open_, @ref threads_
+	 *  and @ref last_request_. */
+	mutable std::mutex mutex_;
+	std::map< std::string, std::shared_ptr< const Resource_ > > resources_;
+	std::vector< std::shared_ptr< socket_utils::TCPSocket > > open_;
+	std::vector< std::thread > threads_;
+	Request last_request_;
+
+	std::thread acceptor_;
+
+	/*! @brief Compress data in the gzip format. */
+	static std::string gzip_( const std::string & data );
+
+	/*! @brief Accept connections until stopped. */
+	void acceptLoop_();
+
+	/*! @brief Serve requests of a connection until it closes. */
+	void serveConnection_( std::shared_ptr< socket_utils::TCPSocket > sock );
+
+	/*! @brief Write a response.
+	 *  @returns	``false`` if the connection must be closed afterwards
+	 */
+	bool respond_( socket_utils::TCPSocket & sock,
+			const Request & request );
+};
+
+#endif /* _MATHTRADER_LIB_IOGRAPH_TEST_HTTPFIXTURESERVER_HPP_ */
@@ -17,10 +17,26 @@
  */
 
 #include <thread>	// Google Test runs on threads
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <unistd.h>
+#include <zlib.h>
 
 #include <gtest/gtest.h>
+#include <iograph/arena.hpp>
+#include <iograph/filewatcher.hpp>
+#include <iograph/httpcache.hpp>
+#include <iograph/httpclient.hpp>
+#include <iograph/memory.hpp>
+#include <iograph/progress.hpp>
+#include <iograph/resultdiff.hpp>
+#include <iograph/resultparser.hpp>
+#include <iograph/trace.hpp>
 #include <iograph/wantparser.hpp>
 #include "config.hpp"
+#include "httpfixtureserver.hpp"
 
 TEST( CornerTests, SimpleTest ) {
 	const std::string input =
@@ -36,7 +52,938 @@ TEST( CornerTests, SimpleTest ) {
 	EXPECT_EQ(3, want_parser.getNumTradingUsers());
 }
 
-TEST( WantParserTest, 2016_April_GR_url ) {
+/* Malformed lines are recorded as compact diagnostics. */
+TEST( CornerTests, Diagnostics ) {
+	std::stringstream is(
+		"#! ALLOW-DUMMIES REQUIRE-USERNAMES\n"
+		"#! FOO-BAR\n"
+		"!BEGIN-OFFICIAL-NAMES\n"
+		"0001-A ==> \"A\" (from alice)\n"
+		"0001-A ==> \"A\" (from alice)\n"
+		"!END-OFFICIAL-NAMES\n"
+		"(alice) 0001-A : %X\n"
+		"0001-A : %X\n"
+		"(bob) 0009-Z : 0001-A\n" );
+
+	WantParser want_parser;
+	want_parser.parseStream(is);
+
+	auto const & errors = want_parser.getErrors();
+	ASSERT_EQ( 4, errors.size() );
+	auto const & records = errors.records();
+
+	EXPECT_EQ( Diagnostic::UNKNOWN_OPTION, records[0].code );
+	EXPECT_EQ( 2, records[0].line );
+	EXPECT_EQ( 4, records[0].column );
+	EXPECT_EQ( "FOO-BAR", errors.item(records[0]) );
+
+	EXPECT_EQ( Diagnostic::EXISTING_ENTRY, records[1].code );
+	EXPECT_EQ( 5, records[1].line );
+	EXPECT_EQ( 1, records[1].column );
+
+	EXPECT_EQ( Diagnostic::MISSING_USERNAME, records[2].code );
+	EXPECT_EQ( 0, records[2].column );
+	EXPECT_EQ( Diagnostic::NO_ITEM, records[2].item );
+
+	EXPECT_EQ( Diagnostic::NO_OFFICIAL_NAME, records[3].code );
+	EXPECT_EQ( 7, records[3].column );
+	EXPECT_EQ( "9:7:Non-dummy item 0009-Z has no official name."
+			" Hint: spelling error?", errors.format(records[3]) );
+
+	std::stringstream printed;
+	want_parser.printErrors(printed);
+	EXPECT_EQ( "ERRORS\n"
+			"**** 2:4:Unknown option FOO-BAR\n"
+			"**** 5:1:Existing entry for item 0001-A\n"
+			"**** 8:Missing username from want list\n"
+			"**** 9:7:Non-dummy item 0009-Z has no official name."
+			" Hint: spelling error?\n", printed.str() );
+}
+
+TEST( CornerTests, DiagnosticUsername ) {
+	std::stringstream is(
+		"!BEGIN-OFFICIAL-NAMES\n"
+		"0001-A ==> \"A\" (fro\n"
+		"!END-OFFICIAL-NAMES\n" );
+
+	WantParser want_parser;
+	want_parser.parseStream(is);
+
+	auto const & errors = want_parser.getErrors();
+	ASSERT_EQ( 1, errors.size() );
+	auto const & record = errors.records()[0];
+	EXPECT_EQ( Diagnostic::BAD_NAME_USERNAME, record.code );
+	EXPECT_EQ( 2, record.line );
+	EXPECT_EQ( 16, record.column );
+	EXPECT_EQ( 0, errors.format(record).find(
+			"2:16:Out of range when parsing username: (fro: " ));
+}
+
+TEST( CornerTests, ResultLoops ) {
+	std::stringstream is(
+		"TRADE LOOPS (4 total trades):\n"
+		"\n"
+		"(alice) 0001-a          receives %x for user (bob)\n"
+		"%x for user (bob)       receives (carol jr) 0003-C\n"
+		"(carol jr) 0003-C       receives (alice) 0001-A\n"
+		"\n"
+		"(dave) 0004-D\n"
+		"(dave) 0004-D           receives (erin) 0005-E\n"
+		"(erin) 0005-E           receives (dave) 0004-D\n"
+		"\n"
+		"ITEM SUMMARY (4 total trades):\n"
+		"\n"
+		"(alice) 0001-A          receives (bob) %x\n" );
+
+	ResultParser result_parser;
+	result_parser.parse(is);
+
+	const std::vector< std::string > items = {
+		"0001-A", "%X-(BOB)", "0003-C", "0004-D", "0005-E" };
+	const std::vector< uint32_t > loops = { 0, 1, 2, 0, 3, 4, 3 };
+	EXPECT_EQ( items, result_parser.getItems() );
+	EXPECT_EQ( loops, result_parser.getLoops() );
+
+	auto const & errors = result_parser.getErrors();
+	ASSERT_EQ( 1, errors.size() );
+	EXPECT_EQ( Diagnostic::BAD_LOOP, errors.records()[0].code );
+	EXPECT_EQ( 7, errors.records()[0].line );
+
+	std::stringstream printed;
+	result_parser.print(printed);
+	EXPECT_EQ( "\"0001-A\"\n\"%X-(BOB)\"\n\"0003-C\"\n\"0001-A\"\n"
+			"\"0004-D\"\n\"0005-E\"\n\"0004-D\"\n", printed.str() );
+	EXPECT_EQ( "carol jr", result_parser.getUsers()[2] );
+}
+
+TEST( CornerTests, ResultDiff ) {
+	std::stringstream previous_is(
+		"TRADE LOOPS (5 total trades):\n"
+		"(alice) 0001-A receives (bob) 0002-B\n"
+		"(bob) 0002-B receives (carol) 0003-C\n"
+		"(carol) 0003-C receives (dave) 0004-D\n"
+		"(dave) 0004-D receives (alice) 0001-A\n"
+		"\n"
+		"(erin) 0005-E receives (frank) 0006-F\n"
+		"(frank) 0006-F receives (erin) 0005-E\n" );
+	std::stringstream current_is(
+		"TRADE LOOPS (5 total trades):\n"
+		"(alice) 0001-A receives (bob) 0002-B\n"
+		"(bob) 0002-B receives (alice) 0001-A\n"
+		"\n"
+		"(carol) 0003-C receives (dave) 0004-D\n"
+		"(dave) 0004-D receives (erin) 0005-E\n"
+		"(erin) 0005-E receives (carol) 0003-C\n" );
+
+	ResultParser previous, current;
+	previous.parse(previous_is);
+	current.parse(current_is);
+
+	ResultDiff result_diff;
+	result_diff.setPrevious( previous.getItems(), previous.getUsers(),
+			previous.getLoops() );
+	result_diff.setCurrent( current.getItems(), current.getUsers(),
+			current.getLoops() );
+	result_diff.run();
+
+	EXPECT_EQ( 3, result_diff.getNumChanged() );	// B, D, E
+	EXPECT_EQ( 1, result_diff.getNumLost() );	// F
+	EXPECT_EQ( 0, result_diff.getNumGained() );
+	EXPECT_EQ( 1, result_diff.getNumSplit() );	// A-B-C-D
+	EXPECT_EQ( 1, result_diff.getNumMerged() );	// C-D-E
+	ASSERT_EQ( 1, result_diff.getLostUsers().size() );
+	EXPECT_EQ( "frank", result_diff.getLostUsers()[0] );
+
+	std::stringstream printed;
+	result_diff.print(printed);
+	EXPECT_NE( std::string::npos, printed.str().find(
+			"(bob) 0002-B receives (alice) 0001-A"
+			" instead of (carol) 0003-C\n" ));
+	EXPECT_NE( std::string::npos, printed.str().find(
+			"(frank) 0006-F no longer trades; received (erin) 0005-E\n" ));
+}
+
+TEST( CornerTests, Trace ) {
+	const std::string wants(
+		"(alice) 0001-A : 0002-B\n"
+		"(bob) 0002-B : 0001-A\n" );
+
+	/* Nothing is recorded unless started. */
+	Trace & trace = Trace::instance();
+	trace.stop();
+	{
+		std::stringstream is(wants);
+		WantParser want_parser;
+		want_parser.parseStream(is);
+	}
+	trace.start();
+	EXPECT_EQ( 0, trace.size() );
+
+	/* Zones of two threads. */
+	{
+		TraceZone zone("test", "test");
+		std::stringstream is(wants);
+		WantParser want_parser;
+		want_parser.parseStream(is);
+	}
+	std::thread thread([&wants]() {
+		std::stringstream is(wants);
+		WantParser want_parser;
+		want_parser.parseStream(is);
+	});
+	thread.join();
+	trace.stop();
+
+	/* Zones end in order: inner first. */
+	ASSERT_EQ( 3, trace.size() );
+	std::stringstream os;
+	trace.write(os);
+
+	/* One event per line. */
+	std::vector< std::string > events;
+	std::stringstream json(os.str());
+	for ( std::string line; std::getline( json, line ); ) {
+		events.push_back( line );
+	}
+	ASSERT_EQ( 5, events.size() );
+	EXPECT_EQ( "{\"traceEvents\":[", events[0] );
+	EXPECT_EQ( "],\"displayTimeUnit\":\"ms\"}", events[4] );
+	EXPECT_EQ( 0, events[1].find("{\"name\":\"parse\",\"cat\":\"iograph\",\"ph\":\"X\",") );
+	EXPECT_EQ( 0, events[2].find("{\"name\":\"test\",\"cat\":\"test\",\"ph\":\"X\",") );
+	EXPECT_EQ( 0, events[3].find("{\"name\":\"parse\",") );
+
+	/* The other thread has its own id. */
+	const std::string tid = ",\"tid\":" + std::to_string( Trace::threadId() ) + "}";
+	EXPECT_NE( std::string::npos, events[1].find( tid ));
+	EXPECT_NE( std::string::npos, events[2].find( tid ));
+	EXPECT_EQ( std::string::npos, events[3].find( tid ));
+
+	/* Starting again discards the zones. */
+	trace.start();
+	EXPECT_EQ( 0, trace.size() );
+	trace.stop();
+}
+
+TEST( CornerTests, MemoryReport ) {
+	EXPECT_EQ( 0, MemoryReport::heapBytes("0001-A") );
+	EXPECT_LE( 101, MemoryReport::heapBytes( std::string( 100, 'x' )));
+
+	std::stringstream is(
+		"(alice) 0001-A : 0002-B\n"
+		"(bob) 0002-B : 0001-A\n" );
+	WantParser want_parser;
+	want_parser.parseStream(is);
+
+	MemoryReport report;
+	want_parser.memoryUsage( report );
+
+	std::stringstream os;
+	report.print(os);
+	const std::string printed = os.str();
+	EXPECT_NE( std::string::npos, printed.find("Peak RSS:") );
+	EXPECT_NE( std::string::npos, printed.find("WantParser::node_map_") );
+	EXPECT_NE( std::string::npos, printed.find("WantParser::arc_map_") );
+	EXPECT_NE( std::string::npos, printed.find("WantParser line index") );
+	EXPECT_GT( MemoryAccount::peakRss(), 0 );
+}
+
+TEST( CornerTests, Arena ) {
+	Arena arena( 256 );
+	{
+		ArenaVector< ArenaString > tokens( arena );
+		for ( int i = 0; i < 100; ++ i ) {
+			const std::string name = "0" + std::to_string(i)
+				+ "-LONG-ITEM-NAME-BEYOND-SSO";
+			tokens.emplace_back( name.begin(), name.end(), arena );
+		}
+		ArenaMultimap< int, int > multimap( arena );
+		multimap.emplace( 1, 2 );
+		multimap.emplace( 1, 3 );
+		EXPECT_EQ( "042-LONG-ITEM-NAME-BEYOND-SSO", tokens[42] );
+		EXPECT_EQ( 2, multimap.count(1) );
+		EXPECT_EQ( 0, reinterpret_cast< uintptr_t >( &multimap.begin()->second )
+				% alignof(int) );
+	}
+	EXPECT_LT( 1, arena.blocks() );
+	EXPECT_LT( 100, arena.allocations() );
+
+	/* Rewinding keeps only the largest block. */
+	const size_t bytes = arena.bytes();
+	arena.reset();
+	EXPECT_EQ( 1, arena.blocks() );
+	EXPECT_GT( bytes, arena.bytes() );
+	arena.allocate( 16, 8 );
+	EXPECT_EQ( 1, arena.blocks() );
+
+	arena.release();
+	EXPECT_EQ( 0, arena.blocks() );
+	EXPECT_EQ( 0, arena.bytes() );
+}
+
+TEST( CornerTests, HugePages ) {
+	EXPECT_FALSE( HugePages::wanted( 2 * HugePages::SIZE ) );
+	{
+		HugePages::Scope scope;
+		EXPECT_TRUE( HugePages::wanted( 2 * HugePages::SIZE ) );
+		EXPECT_FALSE( HugePages::wanted( HugePages::SIZE - 1 ) );
+		{
+			HugePages::Scope disabled( false );
+			EXPECT_TRUE( HugePages::wanted( HugePages::SIZE ) );
+		}
+
+		/* Advised only where the kernel supports it. */
+		void * ptr = HugePages::allocate( HugePages::SIZE + 1 );
+		ASSERT_NE( nullptr, ptr );
+		EXPECT_EQ( 0, reinterpret_cast< uintptr_t >(ptr) % HugePages::SIZE );
+		EXPECT_LE( scope.blocks(), 1u );
+		if ( scope.blocks() == 1 ) {
+			EXPECT_EQ( 2 * HugePages::SIZE, scope.bytes() );
+		}
+		std::free( ptr );
+	}
+	EXPECT_FALSE( HugePages::wanted( 2 * HugePages::SIZE ) );
+}
+
+/* Generated fixtures, shaped after the online trades below.
+ * Extracted under the build directory by cmake. */
+void testFixture( const std::string & fixture,
+		unsigned items, unsigned missing,
+		unsigned users, unsigned trading_users ) {
+
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/" + fixture + "-officialwants.txt";
+
+	WantParser want_parser;
+	want_parser.parseFile(input);
+
+	EXPECT_EQ(items, want_parser.getNumItems());
+	EXPECT_EQ(missing, want_parser.getNumMissingItems());
+	EXPECT_EQ(users, want_parser.getNumUsers());
+	EXPECT_EQ(trading_users, want_parser.getNumTradingUsers());
+}
+
+TEST( FixtureTest, GeneratedSmall ) {
+	testFixture( "generated-small", 1153, 38, 74, 74 );
+}
+
+TEST( FixtureTest, GeneratedMedium ) {
+	testFixture( "generated-medium", 2251, 68, 168, 167 );
+}
+
+TEST( FixtureTest, GeneratedLarge ) {
+	testFixture( "generated-large", 4074, 105, 205, 205 );
+}
+
+TEST( FixtureTest, GeneratedXLarge ) {
+	testFixture( "generated-xlarge", 8000, 215, 400, 400 );
+}
+
+/* Push-style parsing must not depend on chunk boundaries. */
+TEST( FixtureTest, ParseChunks ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+
+	std::ifstream ifs(input, std::ios::binary);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	const std::string data = ss.str();
+
+	for ( size_t chunk : { 1, 7, 4096 } ) {
+		WantParser want_parser;
+		for ( size_t pos = 0; pos < data.length(); pos += chunk ) {
+			want_parser.parseChunk( data.data() + pos,
+					std::min( chunk, data.length() - pos ));
+		}
+		want_parser.parseEnd();
+
+		EXPECT_EQ(1153, want_parser.getNumItems());
+		EXPECT_EQ(38, want_parser.getNumMissingItems());
+		EXPECT_EQ(74, want_parser.getNumUsers());
+		EXPECT_EQ(74, want_parser.getNumTradingUsers());
+	}
+}
+
+/* A requested cancellation stops the parse at the next chunk,
+ * through Cancelled rather than a std::exception;
+ * the file parses in full once the request is withdrawn. */
+TEST( FixtureTest, Cancellation ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+
+	Cancellation::request();
+	{
+		WantParser want_parser;
+		bool cancelled = false;
+		try {
+			want_parser.parseFile(input);
+		} catch ( const std::exception & ) {
+			FAIL() << "Cancellation reported as an error";
+		} catch ( const Cancelled & ) {
+			cancelled = true;
+		}
+		EXPECT_TRUE(cancelled);
+		EXPECT_EQ(0, want_parser.getNumItems());
+	}
+	Cancellation::reset();
+
+	WantParser want_parser;
+	want_parser.parseFile(input);
+	EXPECT_EQ(1153, want_parser.getNumItems());
+}
+
+/* Re-parsing against the line index of a previous parse
+ * must produce the same graph, tokenizing changed lines only. */
+TEST( FixtureTest, LineIndex ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+	const std::string index = testing::TempDir() + "/iograph-index-"
+		+ std::to_string( ::getpid() ) + ".idx";
+
+	std::ifstream ifs(input, std::ios::binary);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	std::string data = ss.str();
+
+	/* Cold run. */
+	{
+		std::remove( index.c_str() );
+		WantParser want_parser;
+		EXPECT_FALSE( want_parser.loadIndex(index) );
+		want_parser.parseFile(input);
+		want_parser.saveIndex(index);
+		EXPECT_EQ(0, want_parser.getIndexStats().reused);
+		EXPECT_TRUE( want_parser.getIndexStats().changed_items.empty() );
+	}
+
+	/* Change one want-list; drop another. */
+	const std::string changed = "(user0001) 0001-VIC : 0662-WULE 1108-VIT\n";
+	const size_t first = data.find("(user0001) 0001-VIC");
+	data.replace( first, data.find('\n', first) + 1 - first, changed );
+	const size_t second = data.find("(user0001) 0092-WSYQZ");
+	data.erase( second, data.find('\n', second) + 1 - second );
+
+	std::stringstream expected;
+	{
+		std::stringstream is(data);
+		WantParser want_parser;
+		want_parser.parseStream(is);
+		want_parser.print(expected);
+	}
+
+	std::stringstream is(data);
+	WantParser want_parser;
+	EXPECT_TRUE( want_parser.loadIndex(index) );
+	want_parser.parseStream(is);
+
+	std::stringstream actual;
+	want_parser.print(actual);
+	EXPECT_EQ( expected.str(), actual.str() );
+
+	auto const stats = want_parser.getIndexStats();
+	EXPECT_EQ( 1, stats.tokenized );
+	EXPECT_EQ( 2, stats.dropped );
+	EXPECT_LT( 2000, stats.reused );
+	ASSERT_EQ( 1, stats.changed_items.size() );
+	EXPECT_EQ( "0001-VIC", stats.changed_items[0] );
+	std::remove( index.c_str() );
+
+	/* In memory, within the same process. */
+	std::stringstream again(data);
+	WantParser reparser;
+	EXPECT_TRUE( reparser.reuseIndex(want_parser) );
+	reparser.parseStream(again);
+	EXPECT_EQ( 0, reparser.getIndexStats().tokenized );
+	EXPECT_EQ( 0, reparser.getIndexStats().dropped );
+
+	/* The previous index is kept, e.g., to retry a failed run. */
+	std::stringstream retry(data);
+	WantParser retrier;
+	EXPECT_TRUE( retrier.reuseIndex(want_parser) );
+	retrier.parseStream(retry);
+	EXPECT_EQ( 0, retrier.getIndexStats().tokenized );
+}
+
+/* An index entry of the same hash but of another line
+ * is a collision; the line is tokenized anew. */
+TEST( CornerTests, LineIndexCollision ) {
+	const std::string index = testing::TempDir() + "/iograph-collision-"
+		+ std::to_string( ::getpid() ) + ".idx";
+
+	/* The single entry of the index of a single line. */
+	auto const entry = [&index]( const std::string & wants ) {
+		std::stringstream is(wants);
+		WantParser want_parser;
+		want_parser.loadIndex(index);
+		want_parser.parseStream(is);
+		want_parser.saveIndex(index);
+		std::ifstream ifs(index);
+		std::string header, line;
+		std::getline(ifs, header);
+		std::getline(ifs, line);
+		return std::make_pair( header, line );
+	};
+	const std::string wants = "(alice) A1 : B1 C1\n",
+		other = "(alice) A1 : D1\n";
+	std::remove( index.c_str() );
+	auto const mine = entry(wants);
+	std::remove( index.c_str() );
+	auto const theirs = entry(other);
+
+	/* The hash of the line, with the entry of the other line. */
+	{
+		std::ofstream ofs(index);
+		ofs << mine.first << '\n'
+			<< mine.second.substr( 0, mine.second.find(' ') )
+			<< theirs.second.substr( theirs.second.find(' ') ) << '\n';
+	}
+
+	std::stringstream expected;
+	{
+		std::stringstream is(wants);
+		WantParser want_parser;
+		want_parser.parseStream(is);
+		want_parser.print(expected);
+	}
+
+	std::stringstream is(wants), actual;
+	WantParser want_parser;
+	EXPECT_TRUE( want_parser.loadIndex(index) );
+	want_parser.parseStream(is);
+	want_parser.print(actual);
+	EXPECT_EQ( expected.str(), actual.str() );
+	EXPECT_EQ( 0, want_parser.getIndexStats().reused );
+	EXPECT_EQ( 1, want_parser.getIndexStats().tokenized );
+	std::remove( index.c_str() );
+}
+
+/* Saves are reported once, after the debounce period;
+ * scripted saves on a simulated clock. */
+TEST( FileWatcherTest, Debounce ) {
+	typedef FileWatcher::Clock Clock;
+	Clock::time_point now;
+	std::vector< Clock::time_point > saves;
+	auto const ms = []( int n ) { return std::chrono::milliseconds(n); };
+
+	/* The next save within the timeout, if any;
+	 * the clock runs to it, or to the timeout. */
+	auto const events = [&]( int timeout_ms ) {
+		if ( !saves.empty() && (( timeout_ms < 0 )
+				|| ( saves.front() <= now + ms(timeout_ms) ))) {
+			now = saves.front();
+			saves.erase( saves.begin() );
+			return true;
+		}
+		if ( timeout_ms >= 0 ) {
+			now += ms(timeout_ms);
+		}
+		return false;
+	};
+	FileWatcher watcher( events, [&]() { return now; }, 100 );
+
+	Clock::time_point changed;
+	EXPECT_FALSE( watcher.wait( changed, 50 ) );
+	EXPECT_EQ( Clock::time_point() + ms(50), now );
+
+	/* Several saves in quick succession: reported once, at the last. */
+	saves = { now + ms(20), now + ms(40), now + ms(60) };
+	EXPECT_TRUE( watcher.wait( changed, 5000 ) );
+	EXPECT_EQ( Clock::time_point() + ms(110), changed );
+	EXPECT_EQ( changed + ms(100), now );
+	EXPECT_FALSE( watcher.wait( changed, 200 ) );
+
+	/* Saves further apart than the debounce period: reported each. */
+	saves = { now + ms(10), now + ms(150) };
+	EXPECT_TRUE( watcher.wait( changed, -1 ) );
+	EXPECT_EQ( Clock::time_point() + ms(420), changed );
+	EXPECT_TRUE( watcher.wait( changed, -1 ) );
+	EXPECT_EQ( Clock::time_point() + ms(560), changed );
+
+	/* Interrupted, with no save to come. */
+	EXPECT_FALSE( watcher.wait( changed, -1 ) );
+}
+
+/* Saves to the file, in place or through a rename, as most editors do;
+ * made before waiting, so that they are already queued. */
+TEST( FileWatcherTest, Inotify ) {
+	const std::string fn = testing::TempDir() + "/iograph-watch-"
+		+ std::to_string( ::getpid() ) + ".txt";
+	std::ofstream(fn) << "v0" << std::endl;
+
+	FileWatcher watcher( fn, 50 );
+	FileWatcher::Clock::time_point changed;
+	EXPECT_FALSE( watcher.wait( changed, 0 ) );
+
+	for ( int i = 1; i <= 3; ++ i ) {
+		std::ofstream(fn) << "v" << i << std::endl;
+	}
+	EXPECT_TRUE( watcher.wait( changed, 0 ) );
+	EXPECT_FALSE( watcher.wait( changed, 0 ) );
+
+	std::ofstream(fn + ".swp") << "v4" << std::endl;
+	std::rename( (fn + ".swp").c_str(), fn.c_str() );
+	EXPECT_TRUE( watcher.wait( changed, 0 ) );
+
+	std::remove( fn.c_str() );
+}
+
+/* Compressed input files are detected and decompressed while parsed. */
+TEST( FixtureTest, GzipFile ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+	const std::string fn = testing::TempDir() + "/iograph-small-"
+		+ std::to_string( ::getpid() ) + ".txt.gz";
+
+	std::ifstream ifs(input, std::ios::binary);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	const std::string data = ss.str();
+
+	gzFile gz = gzopen( fn.c_str(), "wb" );
+	ASSERT_TRUE( gz != NULL );
+	gzwrite( gz, data.data(), data.length() );
+	gzclose( gz );
+
+	WantParser want_parser;
+	want_parser.parseFile(fn);
+	EXPECT_EQ(1153, want_parser.getNumItems());
+	EXPECT_EQ(38, want_parser.getNumMissingItems());
+	EXPECT_EQ(74, want_parser.getNumUsers());
+	EXPECT_EQ(74, want_parser.getNumTradingUsers());
+
+	/* Truncated. */
+	std::ifstream gzs(fn, std::ios::binary);
+	std::stringstream gzss;
+	gzss << gzs.rdbuf();
+	gzs.close();
+	const std::string compressed = gzss.str();
+	std::ofstream( fn, std::ios::binary | std::ios::trunc )
+		<< compressed.substr( 0, compressed.length() / 2 );
+
+	WantParser truncated;
+	EXPECT_THROW( truncated.parseFile(fn), std::runtime_error );
+	std::remove( fn.c_str() );
+}
+
+/* Several want-list files combined into one trade under namespaces. */
+TEST( FixtureTest, CombinedTrade ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+
+	WantParser want_parser;
+	want_parser.parseFiles({ input, input }, { "GR", "CY" });
+	EXPECT_EQ(2 * 1153, want_parser.getNumItems());
+	EXPECT_EQ(2 * 38, want_parser.getNumMissingItems());
+	EXPECT_EQ(2 * 74, want_parser.getNumUsers());
+	EXPECT_EQ(2 * 74, want_parser.getNumTradingUsers());
+
+	std::stringstream errors;
+	want_parser.printErrors(errors);
+	EXPECT_EQ("", errors.str());
+
+	/* Dummies remain dummies; wants stay within their namespace. */
+	std::stringstream lgf;
+	want_parser.print(lgf);
+	const std::string graph = lgf.str();
+	EXPECT_NE( std::string::npos, graph.find("\"GR:0001-VIC\"") );
+	EXPECT_NE( std::string::npos, graph.find("\"CY:0001-VIC\"") );
+	EXPECT_NE( std::string::npos, graph.find("\"%CY:GROUP-(USER0009)\"") );
+	EXPECT_NE( std::string::npos, graph.find("\"GR:0001-VIC\"\t\"GR:") );
+	EXPECT_EQ( std::string::npos, graph.find("\"GR:0001-VIC\"\t\"CY:") );
+
+	/* Default namespaces clash; invalid namespaces. */
+	WantParser same;
+	EXPECT_THROW( same.parseFiles({ input, input }), std::runtime_error );
+	WantParser invalid;
+	EXPECT_THROW( invalid.parseFiles({ input }, { "G R" }), std::runtime_error );
+	WantParser missing;
+	EXPECT_THROW( missing.parseFiles({ input, input + ".missing" }, { "GR", "CY" }),
+			std::runtime_error );
+}
+
+/* The URL input path over the loopback fixture server. */
+void testLoopback( const HttpFixtureServer::Response & response ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+
+	HttpFixtureServer server;
+	server.serveFile("/olwlg/generated-small-officialwants.txt", input, response);
+
+	WantParser want_parser;
+	want_parser.parseUrl( server.url("/olwlg/generated-small-officialwants.txt") );
+
+	EXPECT_EQ(1153, want_parser.getNumItems());
+	EXPECT_EQ(38, want_parser.getNumMissingItems());
+	EXPECT_EQ(74, want_parser.getNumUsers());
+	EXPECT_EQ(74, want_parser.getNumTradingUsers());
+
+	EXPECT_EQ(1, server.requests());
+	EXPECT_EQ("GET", server.lastRequest().method);
+	EXPECT_EQ("127.0.0.1:" + std::to_string(server.port()),
+			server.lastRequest().headers["host"]);
+}
+
+TEST( LoopbackTest, ContentLength ) {
+	testLoopback( HttpFixtureServer::Response() );
+}
+
+TEST( LoopbackTest, Trickle ) {
+	HttpFixtureServer::Response response;
+	response.piece = 4096;
+	response.delay = std::chrono::milliseconds(1);
+	testLoopback( response );
+}
+
+TEST( LoopbackTest, Gzip ) {
+	HttpFixtureServer::Response response;
+	response.gzip = true;
+	response.chunked = true;
+	response.piece = 7;
+	testLoopback( response );
+
+	/* Compressed on the wire only. */
+	HttpFixtureServer server;
+	server.serve("/wants.txt", std::string(10000, '#') + "\n", response);
+	std::string data;
+	HttpClient client;
+	auto const r = client.get( server.url("/wants.txt"),
+			[&]( const char * p, size_t n ) { data.append(p, n); },
+			{{ "Accept-Encoding", "gzip" }} );
+	EXPECT_EQ( "gzip", r.headers.at("content-encoding") );
+	EXPECT_EQ( 10001, data.length() );
+	EXPECT_EQ( 10001, r.length );
+	EXPECT_LT( r.transferred, 100 );
+
+	/* Not requested. */
+	data.clear();
+	auto const plain = client.get( server.url("/wants.txt"),
+			[&]( const char * p, size_t n ) { data.append(p, n); } );
+	EXPECT_EQ( 0, plain.headers.count("content-encoding") );
+	EXPECT_EQ( 10001, plain.transferred );
+}
+
+TEST( LoopbackTest, Chunked ) {
+	HttpFixtureServer::Response response;
+	response.chunked = true;
+	response.piece = 1000;
+	testLoopback( response );
+}
+
+TEST( LoopbackTest, CloseDelimited ) {
+	HttpFixtureServer::Response response;
+	response.content_length = false;
+	testLoopback( response );
+}
+
+TEST( LoopbackTest, KeepAlive ) {
+	HttpFixtureServer server;
+	server.serve("/a.txt", "first");
+	HttpFixtureServer::Response response;
+	response.chunked = true;
+	server.serve("/b.txt", "second", response);
+
+	HttpClient client;
+	std::string data;
+	auto sink = [&]( const char * p, size_t n ) { data.append(p, n); };
+
+	EXPECT_FALSE( client.get( server.url("/a.txt"), sink ).reused );
+	EXPECT_TRUE( client.get( server.url("/b.txt"), sink ).reused );
+	EXPECT_EQ( 404, client.get( server.url("/c.txt"), sink ).status );
+	EXPECT_TRUE( client.get( server.url("/a.txt"), sink ).reused );
+
+	EXPECT_EQ( "firstsecondfirst", data );
+	EXPECT_EQ( 1, client.connections() );
+	EXPECT_EQ( 1, server.connections() );
+}
+
+TEST( LoopbackTest, Timeout ) {
+	HttpFixtureServer server;
+	HttpFixtureServer::Response response;
+	response.delay = std::chrono::milliseconds(500);
+	server.serve("/slow.txt", "slow", response);
+
+	HttpClient client(50);
+	EXPECT_THROW( client.get( server.url("/slow.txt"), HttpClient::Sink() ),
+			std::runtime_error );
+}
+
+TEST( LoopbackTest, ConcurrentFetch ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+
+	HttpFixtureServer server;
+	HttpFixtureServer::Response response;
+	response.piece = 1 << 14;
+	response.delay = std::chrono::milliseconds(1);
+	server.serveFile("/small.txt", input, response);
+
+	std::vector< WantParser > want_parsers(4);
+	std::vector< std::string > urls;
+	std::vector< HttpClient::Sink > sinks;
+	for ( auto & want_parser : want_parsers ) {
+		urls.push_back( server.url("/small.txt") );
+		sinks.push_back( [&want_parser]( const char * p, size_t n ) {
+			want_parser.parseChunk(p, n);
+		});
+	}
+
+	auto const responses = HttpClient::getAll( urls, sinks );
+	EXPECT_EQ( 4, server.connections() );
+
+	for ( size_t i = 0; i < want_parsers.size(); ++ i ) {
+		want_parsers[i].parseEnd();
+		EXPECT_EQ( 200, responses[i].status );
+		EXPECT_EQ(1153, want_parsers[i].getNumItems());
+		EXPECT_EQ(74, want_parsers[i].getNumTradingUsers());
+	}
+}
+
+/* A cache directory of its own, removed with its files after each test. */
+class LoopbackCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		static int count = 0;
+		dir = testing::TempDir() + "/iograph-cache-"
+			+ std::to_string( ::getpid() ) + "-" + std::to_string( ++ count );
+	}
+
+	void TearDown() override {
+		for ( auto const & file : files() ) {
+			std::remove( ( dir + "/" + file ).c_str() );
+		}
+		::rmdir( dir.c_str() );
+	}
+
+	/* Names of the files in the cache directory, sorted. */
+	std::vector< std::string > files() const {
+		std::vector< std::string > names;
+		if ( DIR * d = ::opendir( dir.c_str() ) ) {
+			while ( const struct dirent * entry = ::readdir(d) ) {
+				const std::string name = entry->d_name;
+				if (( name != "." ) && ( name != ".." )) {
+					names.push_back( name );
+				}
+			}
+			::closedir(d);
+		}
+		std::sort( names.begin(), names.end() );
+		return names;
+	}
+
+	std::string dir;
+};
+
+TEST_F( LoopbackCacheTest, ConditionalCache ) {
+	const std::string input =
+		std::string(IOGRAPH_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+	HttpFixtureServer server;
+
+	HttpFixtureServer::Response response;
+	response.headers.push_back( std::make_pair("ETag", "\"v1\"") );
+	server.serveFile("/small.txt", input, response);
+
+	HttpCache cache(dir);
+	HttpClient client;
+	client.setCache( &cache );
+
+	/* Download, then reuse. */
+	for ( int i = 0; i < 2; ++ i ) {
+		WantParser want_parser;
+		want_parser.parseUrl( server.url("/small.txt"), client );
+		EXPECT_EQ(1153, want_parser.getNumItems());
+		EXPECT_EQ(74, want_parser.getNumTradingUsers());
+	}
+	EXPECT_EQ( 1, cache.stats().misses );
+	EXPECT_EQ( 1, cache.stats().hits );
+	EXPECT_EQ( cache.stats().bytes_downloaded, cache.stats().bytes_reused );
+	EXPECT_EQ( "\"v1\"", server.lastRequest().headers["if-none-match"] );
+
+	/* Modified on the server. */
+	response.headers[0].second = "\"v2\"";
+	server.serve("/small.txt", "#! ALLOW-DUMMIES\n", response);
+	std::string data;
+	auto const r = client.get( server.url("/small.txt"),
+			[&]( const char * p, size_t n ) { data.append(p, n); } );
+	EXPECT_FALSE( r.cached );
+	EXPECT_EQ( "#! ALLOW-DUMMIES\n", data );
+	EXPECT_EQ( 2, cache.stats().misses );
+	EXPECT_EQ( 2, cache.stats().stores );
+
+	HttpCache::Entry entry;
+	EXPECT_TRUE( cache.lookup( server.url("/small.txt"), entry ) );
+	EXPECT_EQ( "\"v2\"", entry.etag );
+	EXPECT_EQ( data.length(), entry.length );
+	EXPECT_EQ( 2u, files().size() );
+}
+
+/* Only complete 200 payloads reach the cache directory;
+ * errors and dropped connections leave no temporary files. */
+TEST_F( LoopbackCacheTest, NoTemporaryFiles ) {
+	HttpFixtureServer server;
+	HttpFixtureServer::Response response;
+	response.headers.push_back( std::make_pair("ETag", "\"v1\"") );
+	response.drop_after = 100;
+	server.serve("/dropped.txt", std::string(1000, '#'), response);
+
+	HttpCache cache(dir);
+	HttpClient client;
+	client.setCache( &cache );
+
+	EXPECT_EQ( 404, client.get( server.url("/missing.txt"),
+				HttpClient::Sink() ).status );
+	EXPECT_TRUE( files().empty() );
+
+	EXPECT_THROW( client.get( server.url("/dropped.txt"), HttpClient::Sink() ),
+			std::runtime_error );
+	EXPECT_TRUE( files().empty() );
+	EXPECT_EQ( 0, cache.stats().stores );
+
+	response.drop_after = std::string::npos;
+	server.serve("/complete.txt", std::string(1000, '#'), response);
+	EXPECT_EQ( 200, client.get( server.url("/complete.txt"),
+				HttpClient::Sink() ).status );
+	const std::vector< std::string > stored = files();
+	ASSERT_EQ( 2u, stored.size() );
+	EXPECT_EQ( ".body", stored[0].substr( stored[0].size() - 5 ) );
+	EXPECT_EQ( ".meta", stored[1].substr( stored[1].size() - 5 ) );
+}
+
+TEST( LoopbackTest, ConnectionDrop ) {
+	HttpFixtureServer server;
+	HttpFixtureServer::Response response;
+	response.drop_after = 100;
+	server.serve("/wants.txt", std::string(1000, '#'), response);
+
+	WantParser want_parser;
+	EXPECT_THROW( want_parser.parseUrl( server.url("/wants.txt") ),
+			std::runtime_error );
+}
+
+TEST( LoopbackTest, NotFound ) {
+	HttpFixtureServer server;
+
+	WantParser want_parser;
+	EXPECT_THROW( want_parser.parseUrl( server.url("/missing.txt") ),
+			std::runtime_error );
+}
+
+TEST( LoopbackTest, InvalidPort ) {
+	WantParser want_parser;
+	EXPECT_THROW( want_parser.parseUrl("http://127.0.0.1:99999/wants.txt"),
+			std::runtime_error );
+}
+
+/* Online trades; these require network access.
+ * Run with --gtest_also_run_disabled_tests. */
+TEST( WantParserTest, DISABLED_2016_April_GR_url ) {
 	const std::string input = "http://bgg.activityclub.org/olwlg/207635-officialwants.txt";
 
 	WantParser want_parser;
@@ -48,7 +995,7 @@ TEST( WantParserTest, 2016_April_GR_url ) {
 	EXPECT_EQ(74-2, want_parser.getNumTradingUsers());
 }
 
-TEST( WantParserTest, 2018_June_UK_url ) {
+TEST( WantParserTest, DISABLED_2018_June_UK_url ) {
 	const std::string input = "http://bgg.activityclub.org/olwlg/241767-officialwants.txt";
 
 	WantParser want_parser;
@@ -60,7 +1007,7 @@ TEST( WantParserTest, 2018_June_UK_url ) {
 	EXPECT_EQ(168-15, want_parser.getNumTradingUsers());
 }
 
-TEST( WantParserTest, 2018_April_Origins_url ) {
+TEST( WantParserTest, DISABLED_2018_April_Origins_url ) {
 	const std::string input = "http://bgg.activityclub.org/olwlg/240154-officialwants.txt";
 
 	WantParser want_parser;
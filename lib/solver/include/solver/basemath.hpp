@@ -22,7 +22,10 @@
 #ifndef _BASEMATH_HPP_
 #define _BASEMATH_HPP_
 
-#include <lemon/smart_graph.h>
+#include <iograph/memory.hpp>
+#include <solver/compressedadjacency.hpp>
+#include <solver/itemtable.hpp>
+#include <lemon/static_graph.h>
 
 class BaseMath {
 
@@ -121,23 +124,83 @@ public:
 	 */
 	const BaseMath & exportInputToDot( const std::string & fn ) const ;
 
+	/**
+	 * @brief Estimate the memory of the graphs and maps.
+	 * Adds the estimated bytes of the input graph
+	 * and its node and arc maps to the report.
+	 * @param report the memory report
+	 */
+	virtual void memoryUsage( MemoryReport & report ) const ;
+
+	/**
+	 * @brief Estimate the memory of the input graph.
+	 * Excludes its node and arc maps.
+	 * @return the estimated bytes
+	 */
+	size_t inputGraphBytes() const ;
+
+	/**
+	 * @brief Compress the input graph.
+	 * The targets and ranks of the wants of each item,
+	 * by the node and arc ids of the input graph.
+	 * Used by the benchmarks only; the solver
+	 * works on the input graph itself.
+	 * @return the compressed adjacency
+	 */
+	CompressedAdjacency compressAdjacency() const ;
+
+	/**
+	 * @brief Copy the input graph to plain arrays.
+	 * The targets and ranks of the out-arcs of each item,
+	 * read from the input graph and its rank map,
+	 * by node and arc ids, in compressed sparse row form;
+	 * to check and compare against compressAdjacency().
+	 * @param first_out the first arc of each node, plus the arc count
+	 * @param targets the target of each arc
+	 * @param ranks the rank of each arc
+	 */
+	void inputAdjacency( std::vector< uint32_t > & first_out,
+			std::vector< uint32_t > & targets,
+			std::vector< int > & ranks ) const ;
+
 protected:
 	/**
 	 * @brief Input Graph
 	 * Type of Input Graph, member and maps.
 	 * Nodes: items
 	 * Arc A->B: item A is offered for item B
+	 * Built once by graphReader(), in compressed sparse row form:
+	 * the out-arcs of each node have consecutive ids,
+	 * and so do their entries in the arc maps.
 	 */
-	typedef lemon::SmartDigraph InputGraph;	/**< type of input graph */
+	typedef lemon::StaticDigraph InputGraph;	/**< type of input graph */
 	const InputGraph _input_graph;		/**< actual input graph */
 
+	/**
+	 * @brief Input generation.
+	 * Incremented by every graphReader(), even if it fails;
+	 * indices derived from the input graph record it when built
+	 * and are stale once it differs.
+	 */
+	uint64_t _input_generation;
+
 
-	InputGraph::NodeMap< std::string >	/**< node maps: strings */
-		_name,				/**< official item name	*/
-		_username;			/**< owner's username	*/
+	/**
+	 * @brief Item table
+	 * Names, owners and dummy flags of the items
+	 * in contiguous arrays; the node maps below are views over it.
+	 * Compare owners by _user_id rather than by _username.
+	 */
+	ItemTable _items;
 
-	InputGraph::NodeMap< bool >	/**< node maps: boolean	*/
-		_dummy;			/**< item is a dummy */
+	ItemTable::NameMap< InputGraph >	/**< official item name	*/
+		_name;
+	ItemTable::UserMap< InputGraph >	/**< owner's username	*/
+		_username;
+	ItemTable::UserIdMap< InputGraph >	/**< owner's user id	*/
+		_user_id;
+	ItemTable::DummyMap< InputGraph >	/**< item is a dummy	*/
+		_dummy;
 
 	InputGraph::ArcMap< int >	/**< arc maps: integer	*/
 		_in_rank;		/**< rank of want	*/
@@ -162,11 +225,11 @@ protected:
 	 * Exports a graph to a file compatible with
 	 * graphviz, to visualize the graph.
 	 */
-	template < typename DGR >
+	template < typename DGR, typename LabelMap >
 	static void _exportToDot( std::ostream & os,
 			const DGR & g,
 			const std::string & title,
-			const typename DGR::template NodeMap< std::string > & node_label );
+			const LabelMap & node_label );
 
 private:
 	/**
@@ -191,12 +254,12 @@ private:
  * 	PRIVATE TEMPLATES - Utilities
  **************************************/
 
-template < typename DGR >
+template < typename DGR, typename LabelMap >
 void
 BaseMath::_exportToDot( std::ostream & os,
 		const DGR & g,
 		const std::string & title,
-		const typename DGR::template NodeMap< std::string > & node_label ) {
+		const LabelMap & node_label ) {
 
 	os << "digraph "
 		<< title
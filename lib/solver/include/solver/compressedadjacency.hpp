@@ -0,0 +1,193 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _COMPRESSEDADJACENCY_HPP_
+#define _COMPRESSEDADJACENCY_HPP_
+
+#include <lemon/core.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Compressed adjacency.
+ * The wants of each item, read-only and compressed;
+ * measured by the benchmarks against the input graph,
+ * and not used by the solver, whose algorithms need a lemon graph:
+ * - the targets of a node are delta encoded,
+ *   against the node itself and then the previous target,
+ *   as zigzag group varints: a control byte
+ *   with the byte lengths of four values, then their bytes;
+ *   the last one to three deltas are plain varints;
+ * - the ranks of a node are run-length encoded,
+ *   as the first rank and then runs of equal steps,
+ *   since they mostly grow by the same step.
+ * Node and arc ids are those of the CSR graph it is built from,
+ * so arc maps of that graph may be looked up by arc().
+ * The groups are decoded with SSSE3 if the CPU supports it; see simd().
+ */
+class CompressedAdjacency {
+
+public:
+	/**
+	 * @brief Decoded wants of a node.
+	 * Reused across nodes, so that decoding does not allocate.
+	 */
+	struct Wants {
+		uint32_t first_arc = 0;		/**< arc id of the first want */
+		std::vector< uint32_t > targets;
+		std::vector< int > ranks;
+
+		size_t size() const { return targets.size(); }
+	};
+
+	class OutArcIt;
+
+	/**
+	 * @brief Build from arrays in CSR form.
+	 * @param first_out the first arc of each node, plus the arc count
+	 * @param targets the target of each arc
+	 * @param ranks the rank of each arc
+	 * @throws std::logic_error if the arrays do not match
+	 * @throws std::runtime_error if the encoding exceeds 4 GiB
+	 */
+	void build( const std::vector< uint32_t > & first_out,
+			const std::vector< uint32_t > & targets,
+			const std::vector< int > & ranks );
+
+	/**
+	 * @brief Build from a lemon graph.
+	 * The out-arcs of each node must have consecutive ids,
+	 * as in lemon::StaticDigraph.
+	 * @param g the graph
+	 * @param rank the rank of each arc
+	 * @throws std::logic_error if the arc ids are not consecutive
+	 */
+	template < typename GR, typename RankMap >
+	void build( const GR & g, const RankMap & rank );
+
+	size_t numNodes() const ;
+	size_t numArcs() const ;
+
+	/**
+	 * @brief Arc id of the first want of a node.
+	 */
+	uint32_t firstArc( uint32_t node ) const ;
+
+	/**
+	 * @brief Number of wants of a node.
+	 */
+	uint32_t outDegree( uint32_t node ) const ;
+
+	/**
+	 * @brief Decode the wants of a node.
+	 * @param node the node id
+	 * @param wants overwritten with the wants, in arc id order
+	 */
+	void decode( uint32_t node, Wants & wants ) const ;
+
+	/**
+	 * @brief Decode the wants of a node with the given decoder.
+	 * @param node the node id
+	 * @param wants overwritten with the wants, in arc id order
+	 * @param simd use the SIMD decoder, else the scalar one
+	 * @throws std::logic_error if the SIMD decoder is not supported
+	 */
+	void decode( uint32_t node, Wants & wants, bool simd ) const ;
+
+	/**
+	 * @brief Bytes of the encoding.
+	 * Includes the per-node arc and byte offsets.
+	 */
+	size_t bytes() const ;
+
+	/**
+	 * @brief Are the SIMD decoders compiled in and supported by the CPU?
+	 */
+	static bool simd();
+
+private:
+	std::vector< uint32_t > _first_out;	/**< arc ids, per node, plus one */
+	std::vector< uint32_t > _offset;	/**< into _data, per node, plus one */
+	std::vector< uint8_t > _data;		/**< encoded nodes, then padding */
+};
+
+
+/************************************//*
+ * 	ITERATOR
+ **************************************/
+
+/**
+ * @brief Iterator over the wants of a node.
+ * Decodes the whole node into the given buffer on construction.
+ */
+class CompressedAdjacency::OutArcIt {
+
+public:
+	OutArcIt( const CompressedAdjacency & adjacency,
+			uint32_t node,
+			Wants & buffer ) :
+		_wants( buffer ), _i( 0 ) {
+		adjacency.decode( node, buffer );
+	}
+
+	bool valid() const { return _i < _wants.size(); }
+	OutArcIt & operator++() { ++ _i; return *this; }
+
+	uint32_t arc() const { return _wants.first_arc + _i; }
+	uint32_t target() const { return _wants.targets[_i]; }
+	int rank() const { return _wants.ranks[_i]; }
+
+private:
+	const Wants & _wants;
+	uint32_t _i;
+};
+
+
+/************************************//*
+ * 	TEMPLATE METHODS
+ **************************************/
+
+template < typename GR, typename RankMap >
+void
+CompressedAdjacency::build( const GR & g, const RankMap & rank ) {
+
+	const int nodes = g.maxNodeId() + 1;
+	std::vector< uint32_t > first_out( nodes + 1 ), targets;
+	std::vector< int > ranks;
+	targets.reserve( g.maxArcId() + 1 );
+	ranks.reserve( g.maxArcId() + 1 );
+
+	for ( int i = 0; i < nodes; ++ i ) {
+		first_out[i] = targets.size();
+		for ( typename GR::OutArcIt a( g, g.nodeFromId(i) );
+				a != lemon::INVALID; ++ a ) {
+			if ( static_cast< size_t >( g.id(a) ) != targets.size() ) {
+				throw std::logic_error("Out-arcs of a node "
+						"without consecutive ids");
+			}
+			targets.push_back( g.id( g.target(a) ));
+			ranks.push_back( rank[a] );
+		}
+	}
+	first_out[nodes] = targets.size();
+
+	build( first_out, targets, ranks );
+}
+
+#endif /* _COMPRESSEDADJACENCY_HPP_ */
@@ -0,0 +1,325 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _ITEMTABLE_HPP_
+#define _ITEMTABLE_HPP_
+
+#include <lemon/maps.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Item table.
+ * Names, owners and dummy flags of the items,
+ * indexed by the node id of the input graph,
+ * as a structure of arrays:
+ * - the names are stored back to back in a single arena,
+ *   addressed by offset and length;
+ * - the owners are ids into a deduplicated user table;
+ * - the dummy flags are packed, one bit per item.
+ * Lemon read-write maps over the table are given
+ * by NameMap, UserMap and DummyMap; read-only maps by UserIdMap.
+ */
+class ItemTable {
+
+public:
+	typedef uint32_t UserId;
+
+	/**
+	 * @brief User id of items without an owner.
+	 */
+	static constexpr UserId NO_USER = UINT32_MAX;
+
+	/**
+	 * @brief Item name, as a view into the arena.
+	 * Valid until the table is changed or cleared;
+	 * converts to std::string where a copy is needed.
+	 */
+	class Name;
+
+	/**
+	 * @brief Number of items.
+	 * One more than the greatest id set.
+	 */
+	size_t size() const ;
+
+	/**
+	 * @brief Number of distinct users.
+	 * User ids run from 0 to numUsers() - 1.
+	 */
+	size_t numUsers() const ;
+
+	/**
+	 * @brief Set the name of an item.
+	 * Appended to the arena;
+	 * the bytes of any previous name are not reclaimed.
+	 * @param id the item id
+	 * @param name the name
+	 */
+	void setName( int id, const std::string & name );
+
+	/**
+	 * @brief Set the owner of an item.
+	 * @param id the item id
+	 * @param user the username; added to the user table if new
+	 */
+	void setUser( int id, const std::string & user );
+
+	/**
+	 * @brief Set whether an item is a dummy.
+	 * @param id the item id
+	 * @param dummy the flag
+	 */
+	void setDummy( int id, bool dummy );
+
+	/**
+	 * @brief Name of an item.
+	 * @param id the item id
+	 * @return a view of the name in the arena
+	 */
+	Name name( int id ) const ;
+
+	/**
+	 * @brief User id of the owner of an item.
+	 * @param id the item id
+	 * @return the user id
+	 */
+	UserId userId( int id ) const ;
+
+	/**
+	 * @brief Username by user id.
+	 * @param user the user id
+	 * @return the username; empty for NO_USER
+	 */
+	const std::string & username( UserId user ) const ;
+
+	/**
+	 * @brief Is an item a dummy?
+	 * @param id the item id
+	 * @return the flag
+	 */
+	bool dummy( int id ) const ;
+
+	/**
+	 * @brief Estimated bytes of the table.
+	 * Includes the arena, the arrays and the user table.
+	 */
+	size_t bytes() const ;
+
+	/**
+	 * @brief Remove all items and users.
+	 * Keeps the allocated capacity, for the next read.
+	 */
+	void clear();
+
+	/**
+	 * @brief Lemon maps over the table.
+	 * Thin views, keyed by the nodes of the given graph;
+	 * the writable ones may be given to the lemon graph reader.
+	 */
+	template < typename GR > class NameMap;
+	template < typename GR > class UserMap;
+	template < typename GR > class DummyMap;
+	template < typename GR > class UserIdMap;
+
+private:
+	std::vector< char > _arena;		/**< names, back to back */
+	std::vector< uint32_t > _name_offset;	/**< into _arena, per item */
+	std::vector< uint32_t > _name_length;	/**< per item */
+	std::vector< UserId > _user;		/**< owner, per item */
+	std::vector< bool > _dummy;		/**< packed; per item */
+
+	std::vector< std::string > _users;	/**< usernames, by user id */
+	std::unordered_map< std::string, UserId > _user_index;
+
+	/**
+	 * @brief Make room for the given id.
+	 */
+	void _grow( int id );
+};
+
+
+/************************************//*
+ * 	NAME VIEW
+ **************************************/
+
+class ItemTable::Name {
+
+public:
+	typedef const char * const_iterator;
+
+	Name() : _data( nullptr ), _size( 0 ) {}
+	Name( const char * data, size_t size ) : _data( data ), _size( size ) {}
+
+	const char * data() const { return _data; }
+	size_t size() const { return _size; }
+	size_t length() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	const_iterator begin() const { return _data; }
+	const_iterator end() const { return _data + _size; }
+
+	/**
+	 * @brief A copy of the name.
+	 */
+	std::string str() const { return std::string( _data, _size ); }
+	operator std::string() const { return str(); }
+
+	friend bool operator==( Name a, Name b ) {
+		return ( a._size == b._size )
+			&& std::equal( a.begin(), a.end(), b.begin() );
+	}
+	friend bool operator==( Name a, const std::string & b ) {
+		return a == Name( b.data(), b.size() );
+	}
+	friend bool operator==( const std::string & a, Name b ) {
+		return b == a;
+	}
+	friend bool operator==( Name a, const char * b ) {
+		return a == Name( b, std::char_traits< char >::length(b) );
+	}
+	friend bool operator==( const char * a, Name b ) {
+		return b == a;
+	}
+	friend bool operator!=( Name a, Name b ) { return !( a == b ); }
+	friend bool operator!=( Name a, const std::string & b ) { return !( a == b ); }
+	friend bool operator!=( const std::string & a, Name b ) { return !( a == b ); }
+	friend bool operator!=( Name a, const char * b ) { return !( a == b ); }
+	friend bool operator!=( const char * a, Name b ) { return !( a == b ); }
+
+	friend std::string operator+( std::string a, Name b ) {
+		return a.append( b._data, b._size );
+	}
+	friend std::string operator+( const char * a, Name b ) {
+		return std::string( a ).append( b._data, b._size );
+	}
+	friend std::string operator+( Name a, const std::string & b ) {
+		return a.str().append( b );
+	}
+	friend std::string operator+( Name a, const char * b ) {
+		return a.str().append( b );
+	}
+
+	friend std::ostream & operator<<( std::ostream & os, Name n ) {
+		return os << n.str();
+	}
+
+private:
+	const char * _data;
+	size_t _size;
+};
+
+
+/************************************//*
+ * 	LEMON MAPS
+ **************************************/
+
+template < typename GR >
+class ItemTable::NameMap :
+	public lemon::MapBase< typename GR::Node, std::string > {
+
+public:
+	typedef typename GR::Node Key;
+	typedef std::string Value;	/**< as set; read back as a Name */
+
+	NameMap( const GR & g, ItemTable & table ) :
+		_g( g ), _table( table ) {}
+
+	ItemTable::Name operator[]( const Key & n ) const {
+		return _table.name( _g.id(n) );
+	}
+	void set( const Key & n, const Value & v ) {
+		_table.setName( _g.id(n), v );
+	}
+
+private:
+	const GR & _g;
+	ItemTable & _table;
+};
+
+template < typename GR >
+class ItemTable::UserMap :
+	public lemon::MapBase< typename GR::Node, std::string > {
+
+public:
+	typedef typename GR::Node Key;
+	typedef std::string Value;
+
+	UserMap( const GR & g, ItemTable & table ) :
+		_g( g ), _table( table ) {}
+
+	const Value & operator[]( const Key & n ) const {
+		return _table.username( _table.userId( _g.id(n) ));
+	}
+	void set( const Key & n, const Value & v ) {
+		_table.setUser( _g.id(n), v );
+	}
+
+private:
+	const GR & _g;
+	ItemTable & _table;
+};
+
+template < typename GR >
+class ItemTable::DummyMap :
+	public lemon::MapBase< typename GR::Node, bool > {
+
+public:
+	typedef typename GR::Node Key;
+	typedef bool Value;
+
+	DummyMap( const GR & g, ItemTable & table ) :
+		_g( g ), _table( table ) {}
+
+	Value operator[]( const Key & n ) const {
+		return _table.dummy( _g.id(n) );
+	}
+	void set( const Key & n, Value v ) {
+		_table.setDummy( _g.id(n), v );
+	}
+
+private:
+	const GR & _g;
+	ItemTable & _table;
+};
+
+template < typename GR >
+class ItemTable::UserIdMap :
+	public lemon::MapBase< typename GR::Node, ItemTable::UserId > {
+
+public:
+	typedef typename GR::Node Key;
+	typedef ItemTable::UserId Value;
+
+	UserIdMap( const GR & g, const ItemTable & table ) :
+		_g( g ), _table( table ) {}
+
+	Value operator[]( const Key & n ) const {
+		return _table.userId( _g.id(n) );
+	}
+
+private:
+	const GR & _g;
+	const ItemTable & _table;
+};
+
+#endif /* _ITEMTABLE_HPP_ */
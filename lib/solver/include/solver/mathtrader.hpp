@@ -19,8 +19,15 @@
 #define _MATHTRADER_HPP_
 
 #include <solver/basemath.hpp>
+#include <solver/solverstats.hpp>
+#include <iograph/progress.hpp>
 #include <lemon/list_graph.h>
 
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
 class MathTrader : public BaseMath {
 
 public:
@@ -49,9 +56,43 @@ public:
 	 */
 	MathTrader & setAlgorithm( const std::string & algorithm );
 
+	/**
+	 * @brief Back the flow network by huge pages.
+	 * While run() builds and solves the flow network,
+	 * its large arrays, and those of the algorithm,
+	 * are advised to be backed by transparent huge pages;
+	 * see HugePages. Falls back to small pages if unsupported.
+	 * The advised blocks and the huge-page memory
+	 * are added to the counters of getSolverStats().
+	 * @param option Set the option (default: true)
+	 * @return *this
+	 */
+	MathTrader & useHugePages( bool option = true );
+
+	/**
+	 * @brief Set Progress Callback.
+	 * Called when each phase of run(), mergeDummyItems(),
+	 * verify() and writeResults() starts:
+	 * 	flow-network, the algorithm (e.g., network-simplex),
+	 * 	flow-map, merge-dummies, verify, report
+	 * CAPACITY-SCALING also reports each augmenting path,
+	 * out of one per item.
+	 * The total cost is reported along with flow-map.
+	 * Each phase is also a checkpoint of the Cancellation,
+	 * and so are the copy of the input, each item and want
+	 * while building the flow network and each item
+	 * of mergeDummyItems() and verify();
+	 * of the algorithms, only CAPACITY-SCALING
+	 * may be cancelled while running.
+	 * @param progress The callback; empty to clear it.
+	 * @return *this
+	 */
+	MathTrader & setProgress( const ProgressCallback & progress );
+
 	/**
 	 * @brief MathTrade algorithm.
 	 * Runs the MathTrade algorithm.
+	 * Throws Cancelled if a Cancellation has been requested.
 	 */
 	void run();
 
@@ -64,6 +105,38 @@ public:
 	 */
 	MathTrader & mergeDummyItems();
 
+	/**
+	 * @brief Verify the results.
+	 * Checks the chosen trades in memory,
+	 * before or after mergeDummyItems():
+	 * - Every trading item receives from and sends to
+	 *   a trading item, i.e., the trades form vertex-disjoint loops.
+	 * - Every chosen arc is a want of the input graph,
+	 *   or, if merged, stands for the chain of wants it replaced:
+	 *   from the receiver through the dummy items of its user
+	 *   to the actual sender, starting with the rank of the merged arc.
+	 * Runs in time linear to the size of the graph.
+	 * Throws on the first discrepancy.
+	 * @return *this
+	 */
+	const MathTrader & verify() const ;
+
+	/**
+	 * @brief Get the trade loops.
+	 * Item names and owners by id,
+	 * and the item ids of the loops, each loop ending with its first item:
+	 * 	A B C A E F E ...
+	 * where each item receives the next one.
+	 * Dummy items are included, unless merged.
+	 * @param items Item names; cleared and filled in.
+	 * @param users Usernames of the owners; cleared and filled in.
+	 * @param loops Item ids; cleared and filled in.
+	 * @return *this
+	 */
+	const MathTrader & getLoops( std::vector< std::string > & items,
+			std::vector< std::string > & users,
+			std::vector< uint32_t > & loops ) const ;
+
 	/**
 	 * @brief Hide loops.
 	 * Trade loops will not be shown
@@ -138,6 +211,26 @@ public:
 	 */
 	const MathTrader & exportOutputToDot( const std::string & fn ) const ;
 
+	/**
+	 * @brief Display solver statistics.
+	 * Writes the statistics of the minimum cost flow algorithm
+	 * of the last run() to the given output stream.
+	 * @param os output stream (default: stdout)
+	 * @return *this
+	 */
+	const MathTrader & writeSolverStats( std::ostream & os = std::cout ) const ;
+
+	/**
+	 * @brief Estimate the memory of the graphs and maps.
+	 * Adds the estimated bytes of the input and output graphs,
+	 * their maps and the flow network of the last run() to the report.
+	 * The flow network arrays of the algorithm are the peak heap bytes
+	 * while solving, if counted by MemoryAccount,
+	 * otherwise the growth of the peak RSS.
+	 * @param report the memory report
+	 */
+	void memoryUsage( MemoryReport & report ) const override;
+
 
 	/************************
 	 * 	OUTPUT STATS	*
@@ -151,7 +244,21 @@ public:
 	 */
 	unsigned getNumTrades() const ;
 
+	/*! @brief Solver statistics.
+	 *
+	 *  Returns the statistics of the minimum cost flow algorithm
+	 *  of the last run().
+	 *
+	 *  @return solver statistics
+	 */
+	const SolverStats & getSolverStats() const ;
+
 private:
+	/**
+	 * @brief Unit tests corrupt the results to check verify().
+	 */
+	friend class MathTraderVerifyTest;
+
 	/**
 	 * @brief Minimum Cost Flow Algorithms
 	 * Enumerates all available minimum cost flow algorithm implementations.
@@ -166,6 +273,8 @@ private:
 
 	MCFA _mcfa;
 
+	bool _huge_pages;	/**< back the flow network by huge pages */
+
 	/**
 	 * @brief Output Options
 	 * Options that will determine what should be printed
@@ -206,7 +315,32 @@ private:
 	OutputGraph::ArcMap< int >	/**< arc maps: integer	*/
 		_out_rank;		/**< rank of want	*/
 	OutputGraph::ArcMap< bool >	/**< arc maps: boolean	*/
-		_chosen_arc;		/**< want has been chosen */
+		_chosen_arc,		/**< want has been chosen */
+		_merged_arc;		/**< added by mergeDummyItems() */
+	OutputGraph::ArcMap< std::pair< int, int > >	/**< merged want:	*/
+		_merged_path;		/**< range of its dummies in _merged_dummies */
+
+	/**
+	 * @brief Dummy items of the merged wants.
+	 * Input nodes, in the order of each chain,
+	 * one chain after the other.
+	 */
+	std::vector< InputGraph::Node > _merged_dummies;
+
+	/**
+	 * @brief Solver statistics of the last run.
+	 */
+	SolverStats _solver_stats;
+
+	/**
+	 * @brief Estimated bytes of the flow network maps of the last run.
+	 */
+	size_t _flow_network_bytes;
+
+	/**
+	 * @brief Progress callback; may be empty.
+	 */
+	ProgressCallback _progress;
 
 
 	/**
@@ -216,6 +350,20 @@ private:
 	 */
 	void _runMaximizeTrades();
 
+	/**
+	 * @brief Report progress; checkpoint.
+	 * Passes the progress to the callback, if any.
+	 * Throws Cancelled if a Cancellation has been requested.
+	 * @param progress the progress of the current phase
+	 */
+	void _reportProgress( const Progress & progress ) const ;
+
+	/**
+	 * @brief Report the start of a phase; checkpoint.
+	 * @param phase name of the phase; a string literal
+	 */
+	void _reportPhase( const char * phase ) const ;
+
 	/**
 	 * @brief Run math trade algorithm.
 	 * Runs the math trade algorithm on a given map and provides
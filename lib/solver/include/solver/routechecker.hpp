@@ -24,7 +24,9 @@
 
 #include <solver/basemath.hpp>
 
-#include <list>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 class RouteChecker : public BaseMath {
 
@@ -51,6 +53,27 @@ public:
 	 */
 	RouteChecker & loopReader( std::istream & is );
 
+	/**
+	 * @brief Set loops.
+	 * Sets the loops from an item table,
+	 * e.g., as given by a ResultParser, without going through text.
+	 * @param items Item names, indexed by id
+	 * @param loops Item ids of the loops, as in loopReader()
+	 * @return *this
+	 */
+	RouteChecker & loopReader( const std::vector< std::string > & items,
+			const std::vector< uint32_t > & loops );
+
+	/**
+	 * @brief Outcome of checking a set of loops.
+	 */
+	struct LoopCheck {
+		int visited = 0;		/**< visited non-dummy items */
+		int64_t total_cost = 0;		/**< total cost of the loops */
+		std::vector< std::string >
+			violations;		/**< all violations found */
+	};
+
 	/**
 	 * @brief Run the RouteChecker.
 	 * Checks the validity of the routes:
@@ -58,16 +81,64 @@ public:
 	 * - An arc A->B must either exist directly
 	 *   or go through a dummy node.
 	 * - Calculate the total cost.
+	 * Items and arcs are looked up through hash indices,
+	 * built on the first run after each graphReader().
+	 * Throws on the first violation.
+	 * Throws Cancelled if a Cancellation has been requested.
 	 */
 	void run();
 
+	/**
+	 * @brief Build the lookup indices.
+	 * Maps item names to nodes and (source, target) pairs to arcs.
+	 * Of multiple arcs between the same items,
+	 * the first one in OutArcIt order is kept.
+	 * Must be called after each graphReader()
+	 * and before calling check().
+	 * @return *this
+	 */
+	RouteChecker & buildIndex();
+
+	/**
+	 * @brief Check loops against the input graph.
+	 * Performs the checks of run() on the given loops,
+	 * but records every violation instead of throwing.
+	 * Only reads the input graph and the indices;
+	 * it may be called concurrently from multiple threads.
+	 * Each item name is looked up once.
+	 * Throws Cancelled if a Cancellation has been requested.
+	 * @param items Item names, indexed by id
+	 * @param loops Item ids of the loops, as in loopReader()
+	 * @return The cost, the visited items and the violations.
+	 */
+	LoopCheck check( const std::vector< std::string > & items,
+			const std::vector< uint32_t > & loops ) const ;
+
 	/**
 	 * @brief Print RouteChecker results and stats.
 	 */
 	const RouteChecker & writeResults( std::ostream & os = std::cout ) const ;
 
 private:
-	std::list< std::string > _loop_list;
+	/**
+	 * @brief Loops to be checked by run().
+	 */
+	std::vector< std::string > _items;	/**< item names by id */
+	std::vector< uint32_t > _loops;		/**< item ids of the loops */
+
+	/**
+	 * @brief Key of an arc in the arc index.
+	 */
+	uint64_t _arcKey( InputGraph::Node s, InputGraph::Node t ) const ;
+
+	/**
+	 * @brief Lookup indices.
+	 */
+	std::unordered_map< std::string, InputGraph::Node >
+		_node_index;	/**< item name to node */
+	std::unordered_map< uint64_t, InputGraph::Arc >
+		_arc_index;	/**< (source, target) ids to arc */
+	uint64_t _index_generation;	/**< input generation indexed */
 
 	/**
 	 * @brief Total cost
@@ -0,0 +1,67 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _SOLVERSTATS_HPP_
+#define _SOLVERSTATS_HPP_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Solver statistics.
+ * Statistics of the last run of the minimum cost flow algorithm.
+ * The flow network splits each item into an in-node and an out-node;
+ * its arcs are the wants plus one arc per item.
+ */
+struct SolverStats {
+	std::string algorithm;		/**< minimum cost flow algorithm */
+	int nodes = 0;			/**< nodes of the flow network */
+	int arcs = 0;			/**< arcs of the flow network */
+	int64_t total_cost = 0;		/**< cost of the optimal flow */
+	long peak_rss_kb = 0;		/**< peak resident set size after the run, in KiB */
+	long peak_rss_growth_kb = 0;	/**< growth of the peak during the run, in KiB */
+	int64_t peak_heap_bytes = -1;	/**< peak heap bytes of the algorithm,
+					  * if counted by MemoryAccount; -1 otherwise */
+
+	/**
+	 * Counters of the algorithm, in reporting order,
+	 * e.g. ("augmentations", 1234).
+	 */
+	std::vector< std::pair< std::string, int64_t > > counters;
+
+	/**
+	 * Parameters the algorithm was run with,
+	 * e.g. ("block-size", 45); not observed.
+	 */
+	std::vector< std::pair< std::string, int64_t > > parameters;
+
+	/**
+	 * Estimates derived from the parameters and the input,
+	 * e.g. ("phases", 12); not observed.
+	 */
+	std::vector< std::pair< std::string, int64_t > > estimates;
+
+	/**
+	 * What the algorithm does not expose, if anything,
+	 * e.g. "the cancelled cycles are not counted".
+	 */
+	std::string note;
+};
+
+#endif /* _SOLVERSTATS_HPP_ */
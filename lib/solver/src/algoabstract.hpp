@@ -22,6 +22,18 @@
 #ifndef _ALGOABSTRACT_HPP_
 #define _ALGOABSTRACT_HPP_
 
+#include <solver/solverstats.hpp>
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Called after each step of a run,
+ * with the number of steps so far.
+ * May throw to abandon the run.
+ */
+typedef std::function< void( int64_t ) > AlgoStepCallback;
+
 template< typename G >
 class AlgoAbstract {
 
@@ -31,8 +43,11 @@ public:
 	virtual ~AlgoAbstract() {}
 
 	virtual void run() = 0;
+	virtual void onStep( const AlgoStepCallback & step ) = 0;
+	virtual bool reportsSteps() const = 0;
 	virtual bool optimalSolution() const = 0;
 	virtual const AlgoAbstract & flowMap( ArcIntMap & ) const = 0;
+	virtual const SolverStats & stats() const = 0;
 };
 
 #endif /* _ALGOABSTRACT_HPP */
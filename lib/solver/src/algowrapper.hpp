@@ -24,6 +24,183 @@
 
 #include "algoabstract.hpp"
 
+#include <lemon/bin_heap.h>
+#include <lemon/capacity_scaling.h>
+#include <lemon/core.h>
+#include <lemon/cost_scaling.h>
+#include <lemon/cycle_canceling.h>
+#include <lemon/network_simplex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sys/resource.h>
+
+
+/************************************//*
+ * 	ALGORITHM COUNTERS
+ **************************************/
+
+/**
+ * @brief Heap that counts successful shortest path searches.
+ * CapacityScaling constructs a heap for each shortest path search
+ * and leaves it non-empty, topped by the deficit node found,
+ * only when the search succeeds; each success is an augmentation.
+ * The step callback is called before each search,
+ * with the augmentations so far, and may throw to cancel the run.
+ * Counted per thread, so that concurrent solves do not interfere.
+ */
+template< typename P, typename M >
+class CountingHeap : public lemon::BinHeap< P, M > {
+
+public:
+	explicit CountingHeap( M & map ) :
+		lemon::BinHeap< P, M >( map )
+	{
+		if ( step() != nullptr ) {
+			(*step())( augmentations() );
+		}
+	}
+
+	~CountingHeap() {
+		if ( !this->empty() ) {
+			++ augmentations();
+		}
+	}
+
+	static int64_t & augmentations() {
+		static thread_local int64_t n = 0;
+		return n;
+	}
+
+	static const AlgoStepCallback * & step() {
+		static thread_local const AlgoStepCallback * s = nullptr;
+		return s;
+	}
+};
+
+/**
+ * @brief CapacityScaling traits with a CountingHeap.
+ * Required for its augmentations to be reported.
+ */
+template< typename GR, typename V, typename C >
+struct CountingCapacityScalingTraits :
+	public lemon::CapacityScalingDefaultTraits< GR, V, C > {
+
+	typedef CountingHeap< C, lemon::RangeMap< int > > Heap;
+};
+
+/**
+ * @brief Algorithm-specific statistics.
+ * Specialized for each minimum cost flow algorithm.
+ * LEMON keeps the iteration counters of its algorithms private;
+ * each specialization reports as counters only what is observed,
+ * and separately the parameters of run() and what is derived from them,
+ * or says that nothing is observed.
+ * - steps() tells whether the algorithm reports its steps
+ * - before() is called just before the run, with the step callback
+ * - after() fills in the name and the counters of the stats
+ */
+template< typename A >
+struct AlgoStats {
+	static bool steps() { return false; }
+	static void before( const AlgoStepCallback * ) {}
+	template< typename G, typename M >
+	static void after( const G &, const M &, SolverStats & stats ) {
+		stats.algorithm = "UNKNOWN";
+	}
+};
+
+template< typename GR, typename V, typename C >
+struct AlgoStats< lemon::NetworkSimplex< GR, V, C > > {
+	static bool steps() { return false; }
+	static void before( const AlgoStepCallback * ) {}
+	template< typename G, typename M >
+	static void after( const G &, const M &, SolverStats & stats ) {
+
+		/**
+		 * Default pivot rule: BLOCK_SEARCH,
+		 * examining blocks of sqrt(arcs) arcs, at least 10.
+		 */
+		stats.algorithm = "NETWORK-SIMPLEX";
+		stats.note = "none; the pivots are not exposed";
+		stats.parameters.emplace_back( "block-size",
+				std::max( static_cast< int >(
+						std::sqrt( static_cast< double >( stats.arcs ))), 10 ));
+	}
+};
+
+template< typename GR, typename V, typename C, typename TR >
+struct AlgoStats< lemon::CostScaling< GR, V, C, TR > > {
+	static bool steps() { return false; }
+	static void before( const AlgoStepCallback * ) {}
+	template< typename G, typename M >
+	static void after( const G & g, const M & cost, SolverStats & stats ) {
+
+		/**
+		 * Default method: PARTIAL_AUGMENT, scaling factor 16.
+		 * Epsilon starts at the largest cost
+		 * times the number of nodes, including the root node,
+		 * and is divided by the factor in each phase,
+		 * until it reaches 1.
+		 */
+		const int64_t factor = 16;
+		int64_t max_cost = 0;
+		for ( typename G::ArcIt a(g); a != lemon::INVALID; ++ a ) {
+			max_cost = std::max( max_cost, static_cast< int64_t >( cost[a] ));
+		}
+
+		int64_t phases = 0;
+		for ( int64_t epsilon = max_cost * ( stats.nodes + 1 ); epsilon >= 1;
+				epsilon = ( epsilon < factor && epsilon > 1 ) ?
+				1 : epsilon / factor ) {
+			++ phases;
+		}
+
+		stats.algorithm = "COST-SCALING";
+		stats.note = "none; the refinements are not exposed";
+		stats.parameters.emplace_back( "scaling-factor", factor );
+		stats.estimates.emplace_back( "phases", phases );
+	}
+};
+
+template< typename GR, typename V, typename C >
+struct AlgoStats< lemon::CapacityScaling< GR, V, C,
+	CountingCapacityScalingTraits< GR, V, C > > > {
+	static bool steps() { return true; }
+	static void before( const AlgoStepCallback * step ) {
+		CountingHeap< C, lemon::RangeMap< int > >::augmentations() = 0;
+		CountingHeap< C, lemon::RangeMap< int > >::step() = step;
+	}
+	template< typename G, typename M >
+	static void after( const G &, const M &, SolverStats & stats ) {
+		CountingHeap< C, lemon::RangeMap< int > >::step() = nullptr;
+		stats.algorithm = "CAPACITY-SCALING";
+		stats.counters.emplace_back( "augmentations",
+				CountingHeap< C, lemon::RangeMap< int > >::augmentations() );
+	}
+};
+
+template< typename GR, typename V, typename C >
+struct AlgoStats< lemon::CycleCanceling< GR, V, C > > {
+	static bool steps() { return false; }
+	static void before( const AlgoStepCallback * ) {}
+	template< typename G, typename M >
+	static void after( const G &, const M &, SolverStats & stats ) {
+
+		/**
+		 * Default method: CANCEL_AND_TIGHTEN.
+		 * The number of cancellations is not exposed.
+		 */
+		stats.algorithm = "CYCLE-CANCELING";
+		stats.note = "none; the cancelled cycles are not exposed";
+	}
+};
+
+
+/************************************//*
+ * 	ALGORITHM WRAPPER
+ **************************************/
+
 template< typename A, typename G >
 class AlgoWrapper : public AlgoAbstract< G > {
 
@@ -52,6 +229,21 @@ public:
 	 */
 	void run();
 
+	/**
+	 * @brief Set the Step Callback.
+	 * Called during run() after each step,
+	 * if the algorithm reports its steps.
+	 * An exception thrown by the callback abandons the run.
+	 * @param step The callback; empty to clear it.
+	 */
+	void onStep( const AlgoStepCallback & step );
+
+	/**
+	 * @brief Does run() report its steps?
+	 * @return true if the step callback is called during run().
+	 */
+	bool reportsSteps() const ;
+
 	/**
 	 * @brief Has an optimal solution been found?
 	 * Checks whether the algorithm has found
@@ -69,6 +261,15 @@ public:
 	 */
 	const AlgoWrapper & flowMap( ArcIntMap & flow_map ) const ;
 
+	/**
+	 * @brief Get Solver Statistics.
+	 * Size of the flow network, cost of the flow,
+	 * peak memory and the counters of the algorithm.
+	 * run() must be called beforehand.
+	 * @return the statistics of run()
+	 */
+	const SolverStats & stats() const ;
+
 private:
 	const G & _graph;
 	const NodeIntMap & _supply;
@@ -77,6 +278,14 @@ private:
 
 	typedef typename A::ProblemType ProblemType;
 	ProblemType _rv;
+
+	SolverStats _stats;
+	AlgoStepCallback _step;
+
+	/**
+	 * @brief Peak resident set size of the process, in KiB.
+	 */
+	static long _peakRss();
 };
 
 
@@ -112,7 +321,39 @@ AlgoWrapper< A, G >::~AlgoWrapper() {
 template< typename A, typename G >
 void
 AlgoWrapper< A, G >::run() {
-	_rv = _algorithm.run();
+
+	const long peak_rss = _peakRss();
+	AlgoStats< A >::before( _step ? &_step : nullptr );
+
+	try {
+		_rv = _algorithm.run();
+	} catch ( ... ) {
+		/* E.g., cancelled by the step callback. */
+		AlgoStats< A >::before( nullptr );
+		throw;
+	}
+
+	_stats = SolverStats();
+	_stats.nodes = lemon::countNodes( _graph );
+	_stats.arcs = lemon::countArcs( _graph );
+	if ( _rv == ProblemType::OPTIMAL ) {
+		_stats.total_cost = _algorithm.totalCost();
+	}
+	_stats.peak_rss_kb = _peakRss();
+	_stats.peak_rss_growth_kb = _stats.peak_rss_kb - peak_rss;
+	AlgoStats< A >::after( _graph, _cost, _stats );
+}
+
+template< typename A, typename G >
+void
+AlgoWrapper< A, G >::onStep( const AlgoStepCallback & step ) {
+	_step = step;
+}
+
+template< typename A, typename G >
+bool
+AlgoWrapper< A, G >::reportsSteps() const {
+	return AlgoStats< A >::steps();
 }
 
 template< typename A, typename G >
@@ -128,4 +369,22 @@ AlgoWrapper< A, G >::flowMap( ArcIntMap & flow_map ) const {
 	return *this;
 }
 
+template< typename A, typename G >
+const SolverStats &
+AlgoWrapper< A, G >::stats() const {
+	return _stats;
+}
+
+template< typename A, typename G >
+long
+AlgoWrapper< A, G >::_peakRss() {
+
+	/* ru_maxrss is given in KiB on Linux. */
+	struct rusage usage;
+	if ( getrusage( RUSAGE_SELF, &usage ) != 0 ) {
+		return 0;
+	}
+	return usage.ru_maxrss;
+}
+
 #endif /* _ALGOWRAPPER_HPP_ */
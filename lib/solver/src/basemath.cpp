@@ -21,10 +21,16 @@
  */
 #include <solver/basemath.hpp>
 
+#include <iograph/trace.hpp>
+
 #include <lemon/connectivity.h>
 #include <lemon/lgf_reader.h>
+#include <lemon/smart_graph.h>
+#include <algorithm>
 #include <stdexcept>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 /************************************//*
@@ -32,10 +38,13 @@
  **************************************/
 
 BaseMath::BaseMath() :
-	/* input graph maps */
-	_name( _input_graph ),
-	_username( _input_graph ),
-	_dummy( _input_graph, false ),
+	_input_generation( 0 ),
+
+	/* input graph maps; views over the item table */
+	_name( _input_graph, _items ),
+	_username( _input_graph, _items ),
+	_user_id( _input_graph, _items ),
+	_dummy( _input_graph, _items ),
 	_in_rank( _input_graph, 0 ),
 
 	/* options */
@@ -54,16 +63,61 @@ BaseMath::~BaseMath() {
 BaseMath &
 BaseMath::graphReader( std::istream & is ) {
 
+	TraceZone zone("graph", "solver");
+	++ _input_generation;
+	_items.clear();
+
+	/**
+	 * Read into a temporary, growable graph;
+	 * the item table is filled in directly, by node id.
+	 */
+	typedef lemon::SmartDigraph ReadGraph;
+	ReadGraph read_graph;
+	ItemTable::NameMap< ReadGraph > name( read_graph, _items );
+	ItemTable::UserMap< ReadGraph > username( read_graph, _items );
+	ItemTable::DummyMap< ReadGraph > dummy( read_graph, _items );
+	ReadGraph::ArcMap< int > rank( read_graph );
+
+	digraphReader( read_graph, is ).
+		nodeMap( "item", name ).
+		nodeMap( "dummy", dummy ).
+		nodeMap( "username", username ).
+		arcMap( "rank", rank ).
+		run();
+
+	/**
+	 * Arcs sorted by source, in the order read otherwise.
+	 */
+	const int n_arcs = read_graph.maxArcId() + 1;
+	std::vector< int > order( n_arcs );
+	for ( int i = 0; i < n_arcs; ++ i ) {
+		order[i] = i;
+	}
+	std::stable_sort( order.begin(), order.end(), [&]( int a, int b ) {
+		return read_graph.id( read_graph.source( read_graph.arcFromId(a) ))
+			< read_graph.id( read_graph.source( read_graph.arcFromId(b) ));
+	});
+
+	std::vector< std::pair< int, int > > arcs;
+	arcs.reserve( n_arcs );
+	for ( int i : order ) {
+		auto const a = read_graph.arcFromId(i);
+		arcs.emplace_back( read_graph.id( read_graph.source(a) ),
+				read_graph.id( read_graph.target(a) ));
+	}
+
 	/**
 	 * The only instance where we are allowed to modify
 	 * the input graph.
+	 * Node ids are kept; arc ids follow the sorted order,
+	 * and so do the ranks.
 	 */
-	digraphReader( const_cast< InputGraph & >(_input_graph), is ).
-		nodeMap( "item", _name ).
-		nodeMap( "dummy", _dummy ).
-		nodeMap( "username", _username ).
-		arcMap( "rank", _in_rank ).
-		run();
+	const_cast< InputGraph & >(_input_graph).build(
+			read_graph.maxNodeId() + 1, arcs.begin(), arcs.end() );
+	for ( int i = 0; i < n_arcs; ++ i ) {
+		_in_rank.set( _input_graph.arcFromId(i),
+				rank[ read_graph.arcFromId( order[i] ) ] );
+	}
 
 	return *this;
 }
@@ -161,6 +215,59 @@ BaseMath::writeStrongComponents( std::ostream & os ) const {
 	return *this;
 }
 
+void
+BaseMath::memoryUsage( MemoryReport & report ) const {
+
+	const size_t arcs = _input_graph.maxArcId() + 1;
+
+	report.add( "BaseMath input graph", inputGraphBytes() );
+	report.add( "BaseMath item table", _items.bytes() );
+	report.add( "BaseMath arc maps", arcs * sizeof(int) );	/* _in_rank */
+}
+
+size_t
+BaseMath::inputGraphBytes() const {
+
+	auto const & g = this->_input_graph;
+	const size_t nodes = g.maxNodeId() + 1,
+	      arcs = g.maxArcId() + 1;
+
+	/* StaticDigraph: first out/in arcs per node, plus one;
+	 * source, target and next out/in arcs per arc. */
+	return ( nodes + 1 ) * 2 * sizeof(int) + arcs * 4 * sizeof(int);
+}
+
+CompressedAdjacency
+BaseMath::compressAdjacency() const {
+
+	CompressedAdjacency adjacency;
+	adjacency.build( _input_graph, _in_rank );
+	return adjacency;
+}
+
+void
+BaseMath::inputAdjacency( std::vector< uint32_t > & first_out,
+		std::vector< uint32_t > & targets,
+		std::vector< int > & ranks ) const {
+
+	const int nodes = _input_graph.maxNodeId() + 1;
+	first_out.assign( nodes + 1, 0 );
+	targets.assign( _input_graph.maxArcId() + 1, 0 );
+	ranks.assign( _input_graph.maxArcId() + 1, 0 );
+
+	/* The out-arcs of each node have consecutive ids. */
+	for ( int i = 0; i < nodes; ++ i ) {
+		first_out[ i + 1 ] = first_out[i];
+		for ( InputGraph::OutArcIt a( _input_graph, _input_graph.nodeFromId(i) );
+				a != lemon::INVALID; ++ a ) {
+			const int id = _input_graph.id(a);
+			targets[id] = _input_graph.id( _input_graph.target(a) );
+			ranks[id] = _in_rank[a];
+			++ first_out[ i + 1 ];
+		}
+	}
+}
+
 
 /************************************//*
  * 	PUBLIC METHODS - Utilities
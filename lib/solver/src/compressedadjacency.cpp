@@ -0,0 +1,355 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <solver/compressedadjacency.hpp>
+
+/* The SSSE3 decoder is compiled in on any x86 target,
+ * and chosen at run time if the CPU supports it. */
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define COMPRESSEDADJACENCY_SSSE3
+#include <tmmintrin.h>
+#endif
+
+
+/************************************//*
+ * 	ENCODING
+ **************************************/
+
+namespace {
+
+/**
+ * @brief Zigzag: small deltas of either sign to small values.
+ * Modulo 2^32, so that any target follows from any other.
+ */
+inline uint32_t
+zigzag( uint32_t delta ) {
+	return ( delta << 1 ) ^ static_cast< uint32_t >(
+			static_cast< int32_t >(delta) >> 31 );
+}
+
+inline uint32_t
+unzigzag( uint32_t value ) {
+	return ( value >> 1 ) ^ ( 0u - ( value & 1 ));
+}
+
+inline unsigned
+byteLength( uint32_t value ) {
+	return ( value < (1u << 8) ) ? 1
+		: ( value < (1u << 16) ) ? 2
+		: ( value < (1u << 24) ) ? 3
+		: 4;
+}
+
+void
+putVarint( std::vector< uint8_t > & data, uint32_t value ) {
+	while ( value >= 0x80 ) {
+		data.push_back( static_cast< uint8_t >( value | 0x80 ));
+		value >>= 7;
+	}
+	data.push_back( static_cast< uint8_t >(value) );
+}
+
+inline uint32_t
+getVarint( const uint8_t * & p ) {
+	uint32_t value = 0;
+	for ( unsigned shift = 0; ; shift += 7 ) {
+		const uint8_t byte = *p++;
+		value |= static_cast< uint32_t >( byte & 0x7f ) << shift;
+		if ( byte < 0x80 ) {
+			return value;
+		}
+	}
+}
+
+/**
+ * @brief Decode the full groups of the targets of a node.
+ * @param p the first control byte; moved past the groups
+ * @param out the targets
+ * @param degree the number of targets
+ * @param prev the node; overwritten with the last target decoded
+ * @return the number of targets decoded
+ */
+uint32_t
+decodeGroups( const uint8_t * & p, uint32_t * out,
+		uint32_t degree, uint32_t & prev ) {
+	uint32_t i = 0;
+	for ( ; i + 4 <= degree; i += 4 ) {
+		const uint8_t control = *p++;
+		for ( unsigned k = 0; k < 4; ++ k ) {
+			const unsigned len = (( control >> ( 2 * k )) & 3 ) + 1;
+			uint32_t value = 0;
+			for ( unsigned j = 0; j < len; ++ j ) {
+				value |= static_cast< uint32_t >( p[j] ) << ( 8 * j );
+			}
+			p += len;
+			prev += unzigzag(value);
+			out[ i + k ] = prev;
+		}
+	}
+	return i;
+}
+
+#if defined(COMPRESSEDADJACENCY_SSSE3)
+/**
+ * @brief Group varint tables, by control byte.
+ * Bits 2k and 2k+1 of the control byte hold
+ * the byte length, minus one, of the k-th value.
+ */
+struct GroupTables {
+	uint8_t length[256];			/**< data bytes of the group */
+	alignas(16) uint8_t shuffle[256][16];	/**< for _mm_shuffle_epi8 */
+
+	GroupTables() {
+		for ( unsigned control = 0; control < 256; ++ control ) {
+			unsigned offset = 0;
+			for ( unsigned k = 0; k < 4; ++ k ) {
+				const unsigned len = (( control >> ( 2 * k )) & 3 ) + 1;
+				for ( unsigned j = 0; j < 4; ++ j ) {
+					/* High bit set: the byte is zeroed. */
+					shuffle[control][ 4 * k + j ] =
+						( j < len ) ? ( offset + j ) : 0x80;
+				}
+				offset += len;
+			}
+			length[control] = offset;
+		}
+	}
+};
+
+const GroupTables &
+groupTables() {
+	static const GroupTables tables;
+	return tables;
+}
+
+/**
+ * @brief Decode the full groups with SSSE3; as decodeGroups().
+ * Shuffles the bytes of four values into four lanes,
+ * then undoes the zigzag and sums the deltas in the lanes.
+ */
+__attribute__(( target("ssse3") ))
+uint32_t
+decodeGroupsSsse3( const uint8_t * & p, uint32_t * out,
+		uint32_t degree, uint32_t & prev ) {
+	auto const & tables = groupTables();
+	const __m128i one = _mm_set1_epi32(1);
+	__m128i last = _mm_set1_epi32( static_cast< int >(prev) );
+	uint32_t i = 0;
+	for ( ; i + 4 <= degree; i += 4 ) {
+		const uint8_t control = *p++;
+		const __m128i bytes = _mm_loadu_si128(
+				reinterpret_cast< const __m128i * >(p) );
+		const __m128i values = _mm_shuffle_epi8( bytes,
+				_mm_load_si128( reinterpret_cast< const __m128i * >(
+						tables.shuffle[control] )));
+		p += tables.length[control];
+
+		__m128i deltas = _mm_xor_si128( _mm_srli_epi32( values, 1 ),
+				_mm_sub_epi32( _mm_setzero_si128(),
+					_mm_and_si128( values, one )));
+		deltas = _mm_add_epi32( deltas, _mm_slli_si128( deltas, 4 ));
+		deltas = _mm_add_epi32( deltas, _mm_slli_si128( deltas, 8 ));
+		deltas = _mm_add_epi32( deltas, last );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( out + i ), deltas );
+		last = _mm_shuffle_epi32( deltas, 0xff );
+	}
+	prev = static_cast< uint32_t >( _mm_cvtsi128_si32(last) );
+	return i;
+}
+#endif
+
+/**
+ * @brief Bytes readable past the end of the last node,
+ * for the unaligned 16-byte loads of the SIMD decoder.
+ */
+constexpr size_t PADDING = 16;
+
+} /* namespace */
+
+
+/************************************//*
+ * 	PUBLIC METHODS - BUILD
+ **************************************/
+
+void
+CompressedAdjacency::build( const std::vector< uint32_t > & first_out,
+		const std::vector< uint32_t > & targets,
+		const std::vector< int > & ranks ) {
+
+	if ( first_out.empty()
+			|| ( first_out.back() != targets.size() )
+			|| ( targets.size() != ranks.size() )) {
+		throw std::logic_error("Adjacency arrays do not match");
+	}
+
+	const size_t nodes = first_out.size() - 1;
+	_first_out = first_out;
+	_offset.assign( nodes + 1, 0 );
+	_data.clear();
+	_data.reserve( targets.size() * 2 );
+
+	for ( size_t v = 0; v < nodes; ++ v ) {
+
+		if ( _data.size() > UINT32_MAX ) {
+			throw std::runtime_error("Compressed adjacency exceeds 4 GiB");
+		}
+		_offset[v] = _data.size();
+
+		const uint32_t begin = first_out[v], end = first_out[v + 1];
+		if ( end < begin ) {
+			throw std::logic_error("Adjacency arrays do not match");
+		}
+
+		/* Targets: groups of four, then the rest one by one. */
+		uint32_t prev = v, i = begin;
+		for ( ; i + 4 <= end; i += 4 ) {
+			const size_t control = _data.size();
+			_data.push_back(0);
+			for ( unsigned k = 0; k < 4; ++ k ) {
+				uint32_t value = zigzag( targets[ i + k ] - prev );
+				const unsigned len = byteLength(value);
+				_data[control] |= ( len - 1 ) << ( 2 * k );
+				for ( unsigned j = 0; j < len; ++ j, value >>= 8 ) {
+					_data.push_back( static_cast< uint8_t >(value) );
+				}
+				prev = targets[ i + k ];
+			}
+		}
+		for ( ; i < end; ++ i ) {
+			putVarint( _data, zigzag( targets[i] - prev ));
+			prev = targets[i];
+		}
+
+		/* Ranks: the first, then runs of equal steps. */
+		if ( begin == end ) {
+			continue;
+		}
+		putVarint( _data, zigzag( ranks[begin] ));
+		for ( i = begin + 1; i < end; ) {
+			auto const stepAt = [&]( uint32_t j ) {
+				return static_cast< uint32_t >( ranks[j] )
+					- static_cast< uint32_t >( ranks[ j - 1 ] );
+			};
+			const uint32_t step = stepAt(i);
+			uint32_t run = 1;
+			while ( ( i + run < end ) && ( stepAt( i + run ) == step )) {
+				++ run;
+			}
+			putVarint( _data, zigzag(step) );
+			putVarint( _data, run );
+			i += run;
+		}
+	}
+	if ( _data.size() > UINT32_MAX ) {
+		throw std::runtime_error("Compressed adjacency exceeds 4 GiB");
+	}
+	_offset[nodes] = _data.size();
+
+	_data.resize( _data.size() + PADDING, 0 );
+	_data.shrink_to_fit();
+}
+
+
+/************************************//*
+ * 	PUBLIC METHODS - ACCESS
+ **************************************/
+
+size_t
+CompressedAdjacency::numNodes() const {
+	return _first_out.empty() ? 0 : _first_out.size() - 1;
+}
+
+size_t
+CompressedAdjacency::numArcs() const {
+	return _first_out.empty() ? 0 : _first_out.back();
+}
+
+uint32_t
+CompressedAdjacency::firstArc( uint32_t node ) const {
+	return _first_out[node];
+}
+
+uint32_t
+CompressedAdjacency::outDegree( uint32_t node ) const {
+	return _first_out[ node + 1 ] - _first_out[node];
+}
+
+void
+CompressedAdjacency::decode( uint32_t node, Wants & wants ) const {
+	decode( node, wants, simd() );
+}
+
+void
+CompressedAdjacency::decode( uint32_t node, Wants & wants, bool simd ) const {
+
+	if ( simd && !CompressedAdjacency::simd() ) {
+		throw std::logic_error("SIMD decoder not supported");
+	}
+
+	const uint32_t degree = outDegree(node);
+	wants.first_arc = _first_out[node];
+	wants.targets.resize(degree);
+	wants.ranks.resize(degree);
+	if ( degree == 0 ) {
+		return;
+	}
+
+	const uint8_t * p = _data.data() + _offset[node];
+	uint32_t * out = wants.targets.data();
+	uint32_t prev = node, i;
+
+#if defined(COMPRESSEDADJACENCY_SSSE3)
+	i = simd ? decodeGroupsSsse3( p, out, degree, prev )
+		: decodeGroups( p, out, degree, prev );
+#else
+	i = decodeGroups( p, out, degree, prev );
+#endif
+	for ( ; i < degree; ++ i ) {
+		prev += unzigzag( getVarint(p) );
+		out[i] = prev;
+	}
+
+	int * rank = wants.ranks.data();
+	uint32_t value = unzigzag( getVarint(p) );
+	rank[0] = static_cast< int >(value);
+	for ( i = 1; i < degree; ) {
+		const uint32_t step = unzigzag( getVarint(p) );
+		for ( uint32_t run = getVarint(p); run > 0 && i < degree; -- run ) {
+			value += step;
+			rank[ i ++ ] = static_cast< int >(value);
+		}
+	}
+}
+
+size_t
+CompressedAdjacency::bytes() const {
+	return ( _first_out.capacity() + _offset.capacity() ) * sizeof(uint32_t)
+		+ _data.capacity();
+}
+
+bool
+CompressedAdjacency::simd() {
+#if defined(COMPRESSEDADJACENCY_SSSE3)
+	static const bool supported = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3") != 0;
+	}();
+	return supported;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,165 @@
+/* This file is part of MathTrader++.
+ *
+ * Copyright (C) 2018 George Ioannidis
+ *
+ * MathTrader++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MathTrader++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MathTrader++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <solver/itemtable.hpp>
+
+#include <iograph/memory.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+constexpr ItemTable::UserId ItemTable::NO_USER;
+
+
+/************************************//*
+ * 	PUBLIC METHODS - SIZES
+ **************************************/
+
+size_t
+ItemTable::size() const {
+	return _user.size();
+}
+
+size_t
+ItemTable::numUsers() const {
+	return _users.size();
+}
+
+
+/************************************//*
+ * 	PUBLIC METHODS - SETTERS
+ **************************************/
+
+void
+ItemTable::setName( int id, const std::string & name ) {
+
+	_grow( id );
+	if ( _arena.size() + name.size() > UINT32_MAX ) {
+		throw std::runtime_error("Item names exceed 4 GiB");
+	}
+	_name_offset[id] = _arena.size();
+	_name_length[id] = name.size();
+	_arena.insert( _arena.end(), name.begin(), name.end() );
+}
+
+void
+ItemTable::setUser( int id, const std::string & user ) {
+
+	_grow( id );
+	auto const it = _user_index.emplace( user, _users.size() );
+	if ( it.second ) {
+		_users.push_back( user );
+	}
+	_user[id] = it.first->second;
+}
+
+void
+ItemTable::setDummy( int id, bool dummy ) {
+
+	_grow( id );
+	_dummy[id] = dummy;
+}
+
+
+/************************************//*
+ * 	PUBLIC METHODS - GETTERS
+ **************************************/
+
+ItemTable::Name
+ItemTable::name( int id ) const {
+
+	if ( _name_length[id] == 0 ) {
+		return Name();
+	}
+	return Name( &_arena[ _name_offset[id] ], _name_length[id] );
+}
+
+ItemTable::UserId
+ItemTable::userId( int id ) const {
+	return _user[id];
+}
+
+const std::string &
+ItemTable::username( UserId user ) const {
+
+	static const std::string none;
+	return ( user == NO_USER ) ? none : _users[user];
+}
+
+bool
+ItemTable::dummy( int id ) const {
+	return _dummy[id];
+}
+
+size_t
+ItemTable::bytes() const {
+
+	size_t bytes = _arena.capacity()
+		+ ( _name_offset.capacity() + _name_length.capacity() ) * sizeof(uint32_t)
+		+ _user.capacity() * sizeof(UserId)
+		+ _dummy.capacity() / 8;
+
+	/* Each user: its name, once in the table and once in the index. */
+	for ( auto const & user : _users ) {
+		bytes += 2 * ( sizeof(std::string) + MemoryReport::heapBytes(user) )
+			+ sizeof(UserId) + MemoryReport::NODE_OVERHEAD;
+	}
+	return bytes;
+}
+
+
+void
+ItemTable::clear() {
+
+	_arena.clear();
+	_name_offset.clear();
+	_name_length.clear();
+	_user.clear();
+	_dummy.clear();
+	_users.clear();
+	_user_index.clear();
+}
+
+
+/************************************//*
+ * 	PRIVATE METHODS
+ **************************************/
+
+void
+ItemTable::_grow( int id ) {
+
+	if ( id < 0 ) {
+		throw std::logic_error("Negative item id");
+	}
+	const size_t n = id + 1;
+	if ( n > _user.size() ) {
+
+		/* Items are usually added in id order;
+		 * grow geometrically. */
+		if ( n > _user.capacity() ) {
+			const size_t capacity = std::max( n, 2 * _user.capacity() );
+			_name_offset.reserve( capacity );
+			_name_length.reserve( capacity );
+			_user.reserve( capacity );
+			_dummy.reserve( capacity );
+		}
+		_name_offset.resize( n, 0 );
+		_name_length.resize( n, 0 );
+		_user.resize( n, NO_USER );
+		_dummy.resize( n, false );
+	}
+}
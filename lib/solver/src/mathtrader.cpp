@@ -20,8 +20,6 @@
 /* STL libraries */
 #include <fstream>
 #include <iomanip>
-#include <list>
-#include <map>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -35,6 +33,9 @@
 #include <lemon/cycle_canceling.h>
 #include <lemon/network_simplex.h>
 
+#include <iograph/arena.hpp>
+#include <iograph/trace.hpp>
+
 #include "algowrapper.hpp"
 
 
@@ -48,6 +49,7 @@ MathTrader::MathTrader() :
 
 	/* options */
 	_mcfa( NETWORK_SIMPLEX ),		/**< Option: algorithm 	*/
+	_huge_pages( false ),
 	_hide_loops( false ),
 	_hide_non_trades( false ),
 	_hide_stats( false ),
@@ -65,7 +67,12 @@ MathTrader::MathTrader() :
 	_receive( _output_graph ),
 	_trade( _output_graph, false ),
 	_out_rank( _output_graph ),
-	_chosen_arc( _output_graph, false )
+	_chosen_arc( _output_graph, false ),
+	_merged_arc( _output_graph, false ),
+	_merged_path( _output_graph ),
+
+	/* statistics */
+	_flow_network_bytes( 0 )
 {
 }
 
@@ -99,6 +106,18 @@ MathTrader::setAlgorithm( const std::string & algorithm ) {
 	return *this;
 }
 
+MathTrader &
+MathTrader::useHugePages( bool v ) {
+	_huge_pages = v;
+	return *this;
+}
+
+MathTrader &
+MathTrader::setProgress( const ProgressCallback & progress ) {
+	_progress = progress;
+	return *this;
+}
+
 
 /************************************//*
  * 	PUBLIC METHODS - OUTPUT OPTIONS
@@ -142,6 +161,9 @@ MathTrader::sortByItem( bool v ) {
 void
 MathTrader::run() {
 
+	TraceZone zone("solve", "solver");
+	Cancellation::check();
+
 	/**
 	 * Copy input to output,
 	 * as we will never modify the input.
@@ -152,6 +174,8 @@ MathTrader::run() {
 		nodeCrossRef( _node_out2in ).
 		arcCrossRef( _arc_out2in ).
 		run();
+	_merged_dummies.clear();
+	Cancellation::check();
 
 	mapCopy( _output_graph,
 			composeMap(_in_rank, _arc_out2in),
@@ -168,33 +192,45 @@ MathTrader::run() {
 MathTrader &
 MathTrader::mergeDummyItems() {
 
+	TraceZone zone("merge-dummies", "solver");
+	_reportPhase("merge-dummies");
+
 	OutputGraph & g = this->_output_graph;
 	OutputGraph::NodeMap< bool > iterated(g,false);
 
+	/**
+	 * Temporaries of the merge;
+	 * freed at once on return.
+	 */
+	Arena arena;
+
 	/**
 	 * List to mark new arcs to add
 	 */
 	typedef struct NewArc_s {
 		const OutputGraph::Node *s, *t;
 		int rank;
+		std::pair< int, int > path;	/**< dummies in _merged_dummies */
 
 		/**
 		 * Constructor
 		 */
 		NewArc_s( const OutputGraph::Node *s_,
 				const OutputGraph::Node *t_,
-				int rank_ ) :
+				int rank_,
+				const std::pair< int, int > & path_ ) :
 			s( s_ ),
 			t( t_ ),
-			rank( rank_ ) {}
+			rank( rank_ ),
+			path( path_ ) {}
 
 	} NewArc_t;
-	std::list< NewArc_t > arcs_to_add;
+	ArenaList< NewArc_t > arcs_to_add( arena );
 
 	/**
 	 * List to mark nodes for deletion.
 	 */
-	std::list< int > id_to_delete;
+	ArenaList< int > id_to_delete( arena );
 
 	/**
 	 * Create static arc lookup to quickly find the arcs
@@ -205,10 +241,13 @@ MathTrader::mergeDummyItems() {
 	lemon::ArcLookUp< OutputGraph > arc_lookup(g);
 
 	/**
-	 * Iterate all nodes and check if they are dummies.
+	 * Iterate all nodes and check if they are dummies;
+	 * the graph is left untouched if cancelled meanwhile.
 	 */
 	for ( OutputGraph::NodeIt n(g); n != lemon::INVALID; ++ n ) {
 
+		Cancellation::check();
+
 		/**
 		 * Node of input graph.
 		 * The _dummy map uses INPUT nodes.
@@ -328,6 +367,17 @@ MathTrader::mergeDummyItems() {
 
 				const int rank = _out_rank[arc];
 #endif
+				/**
+				 * Record the dummies of the chain,
+				 * for verify() to follow the wants it replaces.
+				 */
+				std::pair< int, int > path;
+				path.first = _merged_dummies.size();
+				for ( OutputGraph::Node d = next; d != *sender; d = _receive[d] ) {
+					_merged_dummies.push_back( _node_out2in[d] );
+				}
+				path.second = _merged_dummies.size();
+
 				/**
 				 * We have found the real items of this chain.
 				 * Updated send/receive maps.
@@ -338,7 +388,7 @@ MathTrader::mergeDummyItems() {
 				/**
 				 * Schedule corresponding arc to be added.
 				 */
-				arcs_to_add.push_back(NewArc_t(receiver,sender,rank));
+				arcs_to_add.push_back(NewArc_t(receiver,sender,rank,path));
 			}
 		}
 	}
@@ -350,6 +400,8 @@ MathTrader::mergeDummyItems() {
 		auto const & arc = g.addArc( *(new_arc.s), *(new_arc.t) );
 		this->_out_rank[arc] = new_arc.rank;
 		this->_chosen_arc[arc] = true;
+		this->_merged_arc[arc] = true;
+		this->_merged_path[arc] = new_arc.path;
 	}
 
 	/**
@@ -362,10 +414,158 @@ MathTrader::mergeDummyItems() {
 	return *this;
 }
 
+const MathTrader &
+MathTrader::verify() const {
+
+	TraceZone zone("verify", "solver");
+	_reportPhase("verify");
+
+	auto const & g = this->_output_graph;
+	auto const & ig = this->_input_graph;
+
+	/**
+	 * Trading items must form loops:
+	 * the item it receives from must send to it.
+	 */
+	int trading = 0;
+	for ( OutputGraph::NodeIt n(g); n != lemon::INVALID; ++ n ) {
+
+		Cancellation::check();
+		if ( !_trade[n] ) {
+			continue;
+		}
+		trading ++ ;
+
+		auto const & sender = _receive[n];
+		if ( !g.valid(sender) || !_trade[sender] || ( _send[sender] != n ) ) {
+			throw std::runtime_error("Item "
+					+ _name[ _node_out2in[n] ]
+					+ " does not receive from a trading item");
+		}
+	}
+
+	/**
+	 * Each trading item has a single chosen want,
+	 * to the item it receives.
+	 */
+	int chosen = 0;
+	for ( OutputGraph::ArcIt a(g); a != lemon::INVALID; ++ a ) {
+
+		if ( !_chosen_arc[a] ) {
+			continue;
+		}
+		chosen ++ ;
+
+		auto const & receiver = g.source(a);
+		auto const & sender = g.target(a);
+		auto const & r_i = _node_out2in[receiver];
+		auto const & s_i = _node_out2in[sender];
+
+		if ( !_trade[receiver] || ( _receive[receiver] != sender )) {
+			throw std::runtime_error("Chosen want from "
+					+ _name[r_i]
+					+ " to "
+					+ _name[s_i]
+					+ " is not a trade");
+		}
+
+		/**
+		 * Original want: same items and rank in the input graph.
+		 * Merged want: the chain of wants it replaced,
+		 * from the receiver through dummy items of its user
+		 * to the sender; the first with the rank of the merged want.
+		 */
+		bool found = false;
+		if ( !_merged_arc[a] ) {
+			auto const & a_i = _arc_out2in[a];
+			found = ( ig.source(a_i) == r_i ) && ( ig.target(a_i) == s_i )
+				&& ( _in_rank[a_i] == _out_rank[a] );
+		} else {
+			auto const & path = _merged_path[a];
+			found = ( path.first < path.second )
+				&& ( path.second <= static_cast< int >( _merged_dummies.size() ));
+			InputGraph::Node prev = r_i;
+			for ( int k = path.first; found && ( k <= path.second ); ++ k ) {
+				auto const & next = ( k < path.second ) ?
+					_merged_dummies[k] : s_i;
+				if ( k < path.second ) {
+					found = _dummy[next] && ( _user_id[next] == _user_id[r_i] );
+				}
+
+				/* The want prev -> next, among the out-arcs of prev. */
+				bool want = false;
+				for ( InputGraph::OutArcIt a_i(ig, prev);
+						found && !want && ( a_i != lemon::INVALID ); ++ a_i ) {
+					want = ( ig.target(a_i) == next ) && (( k > path.first )
+							|| ( _in_rank[a_i] == _out_rank[a] ));
+				}
+				found = found && want;
+				prev = next;
+			}
+		}
+		if ( !found ) {
+			throw std::runtime_error("No want from "
+					+ _name[r_i]
+					+ " to "
+					+ _name[s_i]);
+		}
+	}
+
+	if ( chosen != trading ) {
+		throw std::runtime_error( std::to_string(chosen)
+				+ " chosen wants for "
+				+ std::to_string(trading)
+				+ " trading items");
+	}
+
+	return *this;
+}
+
+const MathTrader &
+MathTrader::getLoops( std::vector< std::string > & items,
+		std::vector< std::string > & users,
+		std::vector< uint32_t > & loops ) const {
+
+	auto const & g = this->_output_graph;
+
+	items.clear();
+	users.clear();
+	loops.clear();
+
+	/**
+	 * Walk each loop once, from its first trading item;
+	 * each item gets the next id.
+	 */
+	OutputGraph::NodeMap< bool > visited( g, false );
+	for ( OutputGraph::NodeIt n(g); n != lemon::INVALID; ++ n ) {
+
+		if ( !_trade[n] || visited[n] ) {
+			continue;
+		}
+
+		const uint32_t start = items.size();
+		OutputGraph::Node cur = n;
+		do {
+			visited[cur] = true;
+			loops.push_back( items.size() );
+			items.push_back( _name[ _node_out2in[cur] ] );
+			users.push_back( _username[ _node_out2in[cur] ] );
+			cur = _receive[cur];
+		} while (( cur != n ) && !visited[cur] );
+
+		loops.push_back( start );
+	}
+
+	return *this;
+}
+
 
 const MathTrader &
 MathTrader::writeResults( std::ostream & os ) const {
 
+	TraceZone zone("report", "solver");
+	_reportPhase("report");
+
 #define TABWIDTH 50
 
 	/**
@@ -436,9 +636,10 @@ MathTrader::writeResults( std::ostream & os ) const {
 	}
 
 	/**
-	 * Users trading
+	 * Users trading, by user id
 	 */
-	std::unordered_map< std::string, int > users_trading;
+	std::vector< bool > user_trading( _items.numUsers(), false );
+	int users_trading = 0;
 
 	/**
 	 * For each trade cycle: print it
@@ -475,9 +676,11 @@ MathTrader::writeResults( std::ostream & os ) const {
 				 * Statistics:
 				 * track trading user.
 				 */
-				auto it = users_trading.emplace( _username[_node_out2in[cur_node]], 0 );
-				int & count = it.first->second;
-				++ count;
+				const auto user = _user_id[_node_out2in[cur_node]];
+				if (( user != ItemTable::NO_USER ) && !user_trading[user] ) {
+					user_trading[user] = true;
+					++ users_trading;
+				}
 
 				auto const next_node = _receive[cur_node];
 
@@ -523,11 +726,17 @@ MathTrader::writeResults( std::ostream & os ) const {
 		os << "ITEM SUMMARY (" << total_trades << " total trades):" << std::endl;
 		os << std::endl;
 
+		/**
+		 * Temporaries of the summary;
+		 * freed at once at the end of the summary.
+		 */
+		Arena arena;
+
 		/**
 		 * Structure to summarize an item
 		 */
 		typedef struct Summary_s {
-			const std::string
+			const ArenaString
 				user,
 				item_name,
 				receive_user,
@@ -536,24 +745,25 @@ MathTrader::writeResults( std::ostream & os ) const {
 				send_item;
 
 			Summary_s(
+					Arena & arena,
 					const std::string & user_,
-					const std::string & item_,
+					ItemTable::Name item_,
 					const std::string & ruser_ = "",
-					const std::string & ritem_ = "",
+					ItemTable::Name ritem_ = ItemTable::Name(),
 					const std::string & suser_ = "",
-					const std::string & sitem_ = ""
+					ItemTable::Name sitem_ = ItemTable::Name()
 					) :
-				user( user_ ),
-				item_name( item_ ),
-				receive_user( ruser_ ),
-				receive_item( ritem_ ),
-				send_user( suser_ ),
-				send_item( sitem_ )
+				user( user_.begin(), user_.end(), arena ),
+				item_name( item_.begin(), item_.end(), arena ),
+				receive_user( ruser_.begin(), ruser_.end(), arena ),
+				receive_item( ritem_.begin(), ritem_.end(), arena ),
+				send_user( suser_.begin(), suser_.end(), arena ),
+				send_item( sitem_.begin(), sitem_.end(), arena )
 			{}
 
 		} Summary_t;
 
-		std::multimap< std::string, Summary_t > summary_multimap;
+		ArenaMultimap< ArenaString, Summary_t > summary_multimap( arena );
 
 		for ( FinalGraph::NodeIt n(final_graph); n != lemon::INVALID; ++ n ){
 
@@ -567,31 +777,36 @@ MathTrader::writeResults( std::ostream & os ) const {
 			/**
 			 * Key
 			 */
-			const std::string
-				/* This user */
-				& user	= _username[ni],
-				& item	= _name[ni],
-				& key	= (!_sort_by_item) ? user : item;
+			const std::string & user = _username[ni];
+			const ItemTable::Name
+				item	= _name[ni],
+				key	= (!_sort_by_item) ?
+					ItemTable::Name( user.data(), user.size() ) : item;
 
 			if ( _trade[n] ) {
 
-				const std::string
-					/* User she receives from */
-					& ruser	= _username[ _node_out2in[_receive[n]] ],
-					& ritem	=     _name[ _node_out2in[_receive[n]] ],
-
-					/* User she sends to */
-					& suser	= _username[ _node_out2in[_send[n]] ],
-					& sitem	=     _name[ _node_out2in[_send[n]] ];
-
-				summary_multimap.emplace(key,
-						Summary_t(user,item,
+				/* User she receives from */
+				const std::string & ruser =
+					_username[ _node_out2in[_receive[n]] ];
+				const ItemTable::Name ritem =
+					_name[ _node_out2in[_receive[n]] ];
+
+				/* User she sends to */
+				const std::string & suser =
+					_username[ _node_out2in[_send[n]] ];
+				const ItemTable::Name sitem =
+					_name[ _node_out2in[_send[n]] ];
+
+				summary_multimap.emplace(
+						ArenaString(key.begin(), key.end(), arena),
+						Summary_t(arena,user,item,
 							ruser,ritem,
 							suser,sitem));
 			} else if ( !_hide_non_trades ) {
 
-				summary_multimap.emplace(key,
-						Summary_t(user,item));
+				summary_multimap.emplace(
+						ArenaString(key.begin(), key.end(), arena),
+						Summary_t(arena,user,item));
 			}
 		}
 
@@ -677,7 +892,7 @@ MathTrader::writeResults( std::ostream & os ) const {
 		}
 
 		os << std::endl
-			<< "Users trading = " << users_trading.size()
+			<< "Users trading = " << users_trading
 			<< std::endl;
 	}
 
@@ -701,17 +916,8 @@ MathTrader::exportOutputToDot( std::ostream & os ) const {
 	auto const cycle_forest = filterNodes( trading_graph, _trade );
 	typedef decltype(cycle_forest) CycleForest;
 
-	/**
-	 * Create item_name map for template method.
-	 * TODO workaround until fixed.
-	 */
-	CycleForest::NodeMap< std::string > item_name(cycle_forest);
-	mapCopy( cycle_forest,
-			composeMap(_name, _node_out2in),
-			item_name);
-
 	_exportToDot< CycleForest >( os, cycle_forest,
-			"Output_Graph", item_name);
+			"Output_Graph", composeMap(_name, _node_out2in));
 
 	return *this;
 }
@@ -727,6 +933,78 @@ MathTrader::exportOutputToDot( const std::string & fn ) const {
 	return *this;
 }
 
+const MathTrader &
+MathTrader::writeSolverStats( std::ostream & os ) const {
+
+	auto const & stats = this->_solver_stats;
+
+	os << "Solver = " << stats.algorithm << std::endl;
+	os << "Flow network = " << stats.nodes << " nodes, "
+		<< stats.arcs << " arcs" << std::endl;
+	os << "Total cost = " << stats.total_cost << std::endl;
+	os << "Peak memory = " << stats.peak_rss_kb << " KiB"
+		<< " (+" << stats.peak_rss_growth_kb << " KiB while solving)"
+		<< std::endl;
+	if ( stats.peak_heap_bytes >= 0 ) {
+		os << "Peak heap = " << ( stats.peak_heap_bytes / 1024 ) << " KiB"
+			<< std::endl;
+	}
+	for ( auto const & counter : stats.counters ) {
+		os << "Solver " << counter.first << " = " << counter.second << std::endl;
+	}
+	for ( auto const & parameter : stats.parameters ) {
+		os << "Solver parameter " << parameter.first
+			<< " = " << parameter.second << std::endl;
+	}
+	for ( auto const & estimate : stats.estimates ) {
+		os << "Solver estimated " << estimate.first
+			<< " = " << estimate.second << std::endl;
+	}
+	if ( !stats.note.empty() ) {
+		os << "Solver counters: " << stats.note << std::endl;
+	}
+
+	return *this;
+}
+
+void
+MathTrader::memoryUsage( MemoryReport & report ) const {
+
+	BaseMath::memoryUsage( report );
+
+	auto const & g = this->_output_graph;
+	const size_t nodes = g.maxNodeId() + 1,
+	      arcs = g.maxArcId() + 1;
+	const size_t in_nodes = _input_graph.maxNodeId() + 1,
+	      in_arcs = _input_graph.maxArcId() + 1;
+
+	/* ListDigraph: first in/out arcs and prev/next node per node;
+	 * target, source and prev/next in/out arcs per arc. */
+	report.add( "MathTrader output graph",
+			nodes * 4 * sizeof(int) + arcs * 6 * sizeof(int) );
+
+	report.add( "MathTrader output maps",
+			/* _node_in2out, _arc_in2out */
+			in_nodes * sizeof(OutputGraph::Node)
+			+ in_arcs * sizeof(OutputGraph::Arc)
+			/* _node_out2in, _send, _receive, _trade */
+			+ nodes * 3 * sizeof(OutputGraph::Node) + nodes / 8
+			/* _arc_out2in, _out_rank, _chosen_arc, _merged_arc, _merged_path */
+			+ arcs * ( sizeof(InputGraph::Arc) + sizeof(int)
+				+ sizeof(std::pair< int, int >) ) + arcs / 4
+			+ _merged_dummies.capacity() * sizeof(InputGraph::Node) );
+
+	report.add( "Flow network maps", _flow_network_bytes );
+
+	auto const & stats = this->_solver_stats;
+	if ( stats.peak_heap_bytes >= 0 ) {
+		report.add( "Flow algorithm arrays", stats.peak_heap_bytes );
+	} else {
+		report.add( "Flow algorithm arrays (RSS growth)",
+				stats.peak_rss_growth_kb * 1024 );
+	}
+}
+
 /********************************
  * 	PUBLIC METHODS - STATS	*
  ********************************/
@@ -738,6 +1016,11 @@ MathTrader::getNumTrades() const {
 	return countArcs(cycle_forest);
 }
 
+const SolverStats &
+MathTrader::getSolverStats() const {
+	return this->_solver_stats;
+}
+
 /************************************//*
  * 	PRIVATE METHODS - Flows
  **************************************/
@@ -745,6 +1028,16 @@ MathTrader::getNumTrades() const {
 void
 MathTrader::_runMaximizeTrades() {
 
+	TraceZone network_zone("flow-network", "solver");
+	_reportPhase("flow-network");
+
+	/**
+	 * The maps of the flow network below and the arrays
+	 * of the algorithm are the largest blocks of the run;
+	 * back them by huge pages, if so requested.
+	 */
+	HugePages::Scope huge_pages( _huge_pages );
+
 	typedef OutputGraph StartGraph;
 	const StartGraph & start_graph = this->_output_graph;
 
@@ -807,6 +1100,7 @@ MathTrader::_runMaximizeTrades() {
 	 */
 	for ( StartGraph::NodeIt n(start_graph); n != lemon::INVALID; ++ n ) {
 
+		Cancellation::check();
 		auto const & self_arc = split_graph.arc(n);
 		cost_map[ self_arc ] = ( _dummy[_node_out2in[n]] ) ? 0 : 1e9;
 		reverse_map[ self_arc ] = false;
@@ -820,6 +1114,7 @@ MathTrader::_runMaximizeTrades() {
 	 */
 	for ( StartGraph::ArcIt a(start_graph); a != lemon::INVALID; ++ a ) {
 
+		Cancellation::check();
 		auto const & match_arc = split_graph.arc(a);
 		const int rank = _out_rank[a];
 
@@ -841,12 +1136,26 @@ MathTrader::_runMaximizeTrades() {
 	 * Flow map; the solver will populate it.
 	 */
 	SplitOrient::ArcMap< int64_t > flow_map( split_orient );
+	network_zone.end();
+
+	/**
+	 * Supply per node; capacity, cost, flow and direction per arc.
+	 */
+	const size_t split_arcs = countArcs( split_orient );
+	_flow_network_bytes = countNodes( split_orient ) * sizeof(int64_t)
+		+ split_arcs * 3 * sizeof(int64_t) + split_arcs / 8;
 
 	/**
 	 * Run flow algorithm.
 	 */
 	this->_runFlowAlgorithm( split_orient,
 			supply_map, capacity_map, cost_map, flow_map );
+	if ( _huge_pages ) {
+		_solver_stats.counters.emplace_back( "huge_page_blocks",
+				huge_pages.blocks() );
+		_solver_stats.counters.emplace_back( "huge_page_bytes",
+				huge_pages.bytes() );
+	}
 
 	/**
 	 * Map the flow map back to the original graph.
@@ -915,10 +1224,13 @@ MathTrader::_runFlowAlgorithm( const DGR & g,
 	 * Define and apply the solver
 	 */
 	std::unique_ptr< AlgoAbstract< DGR > > trade_ptr;
+	const char * zone_name = nullptr;
+	const int64_t heap_bytes = MemoryAccount::current();
 
 	switch ( _mcfa ) {
 		case NETWORK_SIMPLEX: {
 			typedef lemon::NetworkSimplex< DGR, int64_t > FlowAlgorithm;
+			zone_name = "network-simplex";
 			trade_ptr.reset(new AlgoWrapper< FlowAlgorithm, DGR >
 				(g, supply_map, capacity_map, cost_map));
 			break;
@@ -926,13 +1238,16 @@ MathTrader::_runFlowAlgorithm( const DGR & g,
 
 		case COST_SCALING: {
 			typedef lemon::CostScaling< DGR, int64_t > FlowAlgorithm;
+			zone_name = "cost-scaling";
 			trade_ptr.reset(new AlgoWrapper< FlowAlgorithm, DGR >
 				(g, supply_map, capacity_map, cost_map));
 			break;
 		}
 
 		case CAPACITY_SCALING: {
-			typedef lemon::CapacityScaling< DGR, int64_t > FlowAlgorithm;
+			typedef lemon::CapacityScaling< DGR, int64_t, int64_t,
+				CountingCapacityScalingTraits< DGR, int64_t, int64_t > > FlowAlgorithm;
+			zone_name = "capacity-scaling";
 			trade_ptr.reset(new AlgoWrapper< FlowAlgorithm, DGR >
 				(g, supply_map, capacity_map, cost_map));
 			break;
@@ -940,6 +1255,7 @@ MathTrader::_runFlowAlgorithm( const DGR & g,
 
 		case CYCLE_CANCELING: {
 			typedef lemon::CycleCanceling< DGR, int64_t > FlowAlgorithm;
+			zone_name = "cycle-canceling";
 			trade_ptr.reset(new AlgoWrapper< FlowAlgorithm, DGR >
 				(g, supply_map, capacity_map, cost_map));
 			break;
@@ -953,10 +1269,29 @@ MathTrader::_runFlowAlgorithm( const DGR & g,
 		}
 	}
 
+	/**
+	 * Report the start of the algorithm and, if it can tell,
+	 * each of its steps: one augmenting path per item.
+	 */
+	Progress progress;
+	progress.phase = zone_name;
+	progress.interruptible = trade_ptr->reportsSteps();
+	if ( trade_ptr->reportsSteps() ) {
+		progress.total = countNodes( g ) / 2;
+		trade_ptr->onStep( [this, &progress]( int64_t steps ) {
+			progress.done = steps;
+			this->_reportProgress( progress );
+		});
+	}
+	_reportProgress( progress );
+
 	/**
 	 * Run and get the Problem Type
 	 */
-	trade_ptr->run();
+	{
+		TraceZone zone(zone_name, "solver");
+		trade_ptr->run();
+	}
 
 	/**
 	 * Check if perfect match has been found.
@@ -966,9 +1301,49 @@ MathTrader::_runFlowAlgorithm( const DGR & g,
 	}
 
 	/**
-	 * Get the flow map
+	 * Get the flow map and the statistics
 	 */
 	trade_ptr->flowMap( flow_map );
+	_solver_stats = trade_ptr->stats();
+	if ( MemoryAccount::enabled() ) {
+		_solver_stats.peak_heap_bytes = MemoryAccount::peak() - heap_bytes;
+	}
+	if ( _huge_pages ) {
+		/* While the arrays of the algorithm are still allocated. */
+		_solver_stats.counters.emplace_back( "anon_huge_kb",
+				HugePages::residentKb() );
+	}
+
+	/**
+	 * The objective is known once solved.
+	 */
+	Progress solved;
+	solved.phase = "flow-map";
+	solved.objective = _solver_stats.total_cost;
+	solved.has_objective = true;
+	_reportProgress( solved );
+}
+
+
+/************************************//*
+ * 	PRIVATE METHODS - Progress
+ **************************************/
+
+void
+MathTrader::_reportProgress( const Progress & progress ) const {
+
+	if ( _progress ) {
+		_progress( progress );
+	}
+	Cancellation::check();
+}
+
+void
+MathTrader::_reportPhase( const char * phase ) const {
+
+	Progress progress;
+	progress.phase = phase;
+	_reportProgress( progress );
 }
 
 
@@ -21,6 +21,9 @@
  */
 #include <solver/routechecker.hpp>
 
+#include <iograph/progress.hpp>
+#include <iograph/trace.hpp>
+
 #include <lemon/dfs.h>
 #include <lemon/maps.h>
 #include <lemon/path.h>
@@ -32,7 +35,8 @@
  **************************************/
 
 RouteChecker::RouteChecker() :
-	BaseMath()
+	BaseMath(),
+	_index_generation( 0 )
 {
 }
 
@@ -47,7 +51,13 @@ RouteChecker::~RouteChecker() {
 RouteChecker &
 RouteChecker::loopReader( std::istream & is ) {
 
-	_loop_list.clear();
+	_items.clear();
+	_loops.clear();
+
+	/**
+	 * Item ids by name.
+	 */
+	std::unordered_map< std::string, uint32_t > ids;
 
 	/**
 	 * Read buffer
@@ -66,12 +76,26 @@ RouteChecker::loopReader( std::istream & is ) {
 			item = item.substr(1, std::string::npos);
 		}
 
-		_loop_list.push_back( item );
+		auto const pair = ids.emplace( item,
+				static_cast< uint32_t >( _items.size() ));
+		if ( pair.second ) {
+			_items.push_back( item );
+		}
+		_loops.push_back( pair.first->second );
 	}
 
 	return *this;
 }
 
+RouteChecker &
+RouteChecker::loopReader( const std::vector< std::string > & items,
+		const std::vector< uint32_t > & loops ) {
+
+	_items = items;
+	_loops = loops;
+	return *this;
+}
+
 
 /************************************//*
  * 	PUBLIC METHODS - RUNNABLE
@@ -81,9 +105,54 @@ void
 RouteChecker::run() {
 
 	/**
-	 * New loop flag.
+	 * Index the items and arcs of a new input graph.
 	 */
-	bool new_loop = true;
+	if ( _index_generation != this->_input_generation ) {
+		buildIndex();
+	}
+
+	auto const result = check( _items, _loops );
+	if ( !result.violations.empty() ) {
+		throw std::runtime_error( result.violations.front() );
+	}
+
+	this->_visited = result.visited;
+	this->_total_cost = result.total_cost;
+}
+
+RouteChecker &
+RouteChecker::buildIndex() {
+
+	auto const & g = this->_input_graph;
+	using RouteGraph = InputGraph;
+
+	_node_index.clear();
+	_arc_index.clear();
+	_node_index.reserve( lemon::countNodes(g) );
+	_arc_index.reserve( lemon::countArcs(g) );
+
+	for ( RouteGraph::NodeIt n(g); n != lemon::INVALID; ++n ) {
+		Cancellation::check();
+		_node_index.emplace( _name[n], n );
+
+		/**
+		 * Keep the first arc to each target,
+		 * as a scan over OutArcIt would find.
+		 */
+		for ( RouteGraph::OutArcIt a(g,n); a != lemon::INVALID; ++a ) {
+			_arc_index.emplace( _arcKey(n, g.target(a)), a );
+		}
+	}
+	_index_generation = this->_input_generation;
+
+	return *this;
+}
+
+RouteChecker::LoopCheck
+RouteChecker::check( const std::vector< std::string > & items,
+		const std::vector< uint32_t > & loops ) const {
+
+	TraceZone zone("check", "solver");
 
 	/**
 	 * Graph to be used.
@@ -91,104 +160,143 @@ RouteChecker::run() {
 	auto const & g = this->_input_graph;
 	using RouteGraph = InputGraph;
 
+	if ( _index_generation != this->_input_generation ) {
+		throw std::logic_error("RouteChecker::check() called"
+				" before indexing the input graph");
+	}
+
+	LoopCheck result;
+
 	/**
-	 * Frequency map
+	 * Look up each item once.
 	 */
-	RouteGraph::NodeMap< bool > visit(g, false);
-	int start_id = 0, prev_id = 0;
+	std::vector< RouteGraph::Node > nodes( items.size(), lemon::INVALID );
+	for ( size_t id = 0; id < items.size(); ++ id ) {
+		Cancellation::check();
+		auto const it = _node_index.find( items[id] );
+		if ( it != _node_index.end() ) {
+			nodes[id] = it->second;
+		}
+	}
 
 	/**
-	 * Initialize total cost
+	 * Visited flags.
+	 * A NodeMap would register itself with the graph,
+	 * which is shared between concurrent checks.
 	 */
-	this->_visited = 0;
-	this->_total_cost = 0;
+	std::vector< bool > visit( g.maxNodeId() + 1, false );
+
+	/**
+	 * New loop flag, first item of the loop
+	 * and previous node, if it has been found.
+	 */
+	bool new_loop = true;
+	uint32_t start = 0;
+	RouteGraph::Node prev = lemon::INVALID;
 
 	/**
 	 * Parse all items.
 	 */
-	for ( auto const & item : _loop_list ) {
+	for ( auto const id : loops ) {
 
-		/**
-		 * Look up node.
-		 */
-		auto const & n = mapFind( g, _name, item );
+		Cancellation::check();
+		if ( id >= items.size() ) {
+			throw std::logic_error("Item id "
+					+ std::to_string(id)
+					+ " out of range");
+		}
 
 		/**
 		 * Sanity check: node has been found
 		 */
+		auto const & n = nodes[id];
 		if ( n == lemon::INVALID ) {
-			// TODO: don't use exceptions
-			throw std::runtime_error("Could not find item "
-					+ item);
+			result.violations.push_back("Could not find item "
+					+ items[id]);
 		}
-		const int cur_id = g.id(n);
 
 		if ( new_loop ) {
 			new_loop = false;
-			start_id = cur_id;
+			start = id;
 		} else {
 
-			bool found = false;
-
-			auto const & s = g.nodeFromId(prev_id);
-			auto const & t = n;
-			int64_t cost = 0;
-
 			/**
-			 * Iterate all outgoing arcs of @s.
+			 * Check the arc and the visit of the previous item,
+			 * unless it is unknown.
 			 */
-			for ( RouteGraph::OutArcIt a(g,s); a != lemon::INVALID; ++a ) {
-
-				auto const & next = g.target(a);
-
-				if ( next == t ) {
+			if ( prev != lemon::INVALID ) {
+
+				auto const & s = prev;
+
+				/**
+				 * Look up the arc @s -> @t.
+				 */
+				if ( n != lemon::INVALID ) {
+
+					auto const & t = n;
+					auto const a = _arc_index.find( _arcKey(s, t) );
+					if ( a != _arc_index.end() ) {
+
+						/**
+						 * Target node is directly
+						 * accessible.
+						 */
+						result.total_cost += _getCost(
+								_in_rank[a->second],
+								_dummy[s]);
+					} else {
+						result.violations.push_back(
+							"No path between items "
+							+ _name[s]
+							+ " and "
+							+ _name[t]
+							+ "; hint: are you using"
+							" --show-dummy-items?");
+					}
+				}
 
-					/**
-					 * Target node is directly
-					 * accessible.
-					 */
-					found = true;
-					cost = _getCost(_in_rank[a], _dummy[s]);
-					break;
+				/**
+				 * Check if already visited.
+				 */
+				if ( visit[ g.id(s) ] ) {
+					result.violations.push_back("Multiple visits"
+							" for item " + _name[s]);
 				}
-			}
+				visit[ g.id(s) ] = true;
 
-			if ( !found ) {
-				throw std::runtime_error("No path between items "
-					+ _name[s]
-					+ " and "
-					+ _name[t]
-					+ "; hint: are you using --show-dummy-items?");
+				/**
+				 * Count visited nodes
+				 */
+				if ( !_dummy[s] ) {
+					result.visited ++ ;
+				}
 			}
 
-			_total_cost += cost;
-
 			/**
 			 * Flag a new loop if needed.
 			 */
-			if ( cur_id == start_id ) {
+			if ( id == start ) {
 				new_loop = true;
 			}
-
-			/**
-			 * Check if already visited.
-			 */
-			if ( visit[s] ) {
-				throw std::runtime_error("Multiple visits"
-						" for item " + _name[s]);
-			}
-			visit[s] = true;
-
-			/**
-			 * Count visited nodes
-			 */
-			if ( !_dummy[s] ) {
-				_visited ++ ;
-			}
 		}
-		prev_id = cur_id;
+		prev = n;
 
 	} /* end for loop */
+
+	return result;
+}
+
+
+/************************************//*
+ * 	PRIVATE METHODS
+ **************************************/
+
+uint64_t
+RouteChecker::_arcKey( InputGraph::Node s, InputGraph::Node t ) const {
+
+	auto const & g = this->_input_graph;
+	return ( static_cast< uint64_t >( g.id(s) ) << 32 )
+		| static_cast< uint32_t >( g.id(t) );
 }
 
 
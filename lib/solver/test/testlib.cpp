@@ -18,11 +18,505 @@
 
 #include <algorithm>
 #include <sstream>
+#include <string>
 #include <thread>	// Google Test runs on threads
+#include <vector>
 
 #include <gtest/gtest.h>
+#include <lemon/smart_graph.h>
+#include <lemon/static_graph.h>
+#include <solver/compressedadjacency.hpp>
+#include <solver/itemtable.hpp>
 #include <solver/mathtrader.hpp>
+#include <solver/routechecker.hpp>
+#include <iograph/resultparser.hpp>
 #include <iograph/wantparser.hpp>
+#include "config.hpp"
+
+void testFixture( const std::string & fixture, unsigned num_trades ) {
+	const std::string input =
+		std::string(SOLVER_PROJECT_FIXTURES_DIR)
+		+ "/" + fixture + "-officialwants.txt";
+
+	WantParser want_parser;
+	std::stringstream graph;
+	want_parser.parseFile(input);
+	want_parser.print(graph);
+
+	MathTrader trade_solver;
+	trade_solver.graphReader(graph);
+	trade_solver.setPriorities(want_parser.getPriorityScheme());
+	trade_solver.run();
+	EXPECT_NO_THROW( trade_solver.verify() );
+	trade_solver.mergeDummyItems();
+	EXPECT_NO_THROW( trade_solver.verify() );
+	EXPECT_EQ(num_trades, trade_solver.getNumTrades());
+}
+
+TEST( FixtureTest, GeneratedSmall ) {
+	testFixture( "generated-small", 1035 );
+}
+
+TEST( FixtureTest, GeneratedMedium ) {
+	testFixture( "generated-medium", 2020 );
+}
+
+TEST( FixtureTest, GeneratedLarge ) {
+	testFixture( "generated-large", 3695 );
+}
+
+/* The maps of the item table read back what has been set;
+ * users are deduplicated. */
+TEST( ItemTableTest, Views ) {
+	lemon::SmartDigraph g;
+	ItemTable items;
+	ItemTable::NameMap< lemon::SmartDigraph > name( g, items );
+	ItemTable::UserMap< lemon::SmartDigraph > user( g, items );
+	ItemTable::UserIdMap< lemon::SmartDigraph > user_id( g, items );
+	ItemTable::DummyMap< lemon::SmartDigraph > dummy( g, items );
+
+	std::vector< lemon::SmartDigraph::Node > nodes;
+	for ( int i = 0; i < 100; ++ i ) {
+		auto const n = g.addNode();
+		nodes.push_back(n);
+		name.set( n, "0" + std::to_string(i) + "-LONG-ITEM-NAME-BEYOND-SSO" );
+		user.set( n, "user" + std::to_string(i % 7) );
+		dummy.set( n, ( i % 3 ) == 0 );
+	}
+
+	EXPECT_EQ(100, items.size());
+	EXPECT_EQ(7, items.numUsers());
+	EXPECT_EQ("042-LONG-ITEM-NAME-BEYOND-SSO", name[nodes[42]]);
+	EXPECT_EQ("user1", user[nodes[43]]);
+	EXPECT_EQ(user_id[nodes[1]], user_id[nodes[8]]);
+	EXPECT_NE(user_id[nodes[1]], user_id[nodes[2]]);
+	EXPECT_TRUE(dummy[nodes[42]]);
+	EXPECT_FALSE(dummy[nodes[43]]);
+
+	/* Names are views into the table, not copies. */
+	auto const view = name[nodes[42]];
+	EXPECT_EQ(items.name( g.id(nodes[42]) ).data(), view.data());
+	EXPECT_EQ("(user0) 042-LONG-ITEM-NAME-BEYOND-SSO", "(user0) " + view);
+
+	items.clear();
+	EXPECT_EQ(0, items.size());
+	EXPECT_EQ(0, items.numUsers());
+	name.set( nodes[0], "A" );
+	user.set( nodes[0], "user9" );
+	EXPECT_EQ(1, items.size());
+	EXPECT_EQ(1, items.numUsers());
+	EXPECT_EQ("A", name[nodes[0]]);
+}
+
+/* Targets with deltas of either sign, ranks in runs,
+ * and nodes with and without full groups. */
+TEST( CompressedAdjacencyTest, RoundTrip ) {
+	const int nodes = 1000;
+	std::vector< std::pair< int, int > > arcs;
+	for ( int v = 0; v < nodes; ++ v ) {
+		for ( int k = 0; k < v % 11; ++ k ) {
+			arcs.emplace_back( v, ( v * 7919 + k * k * k * 104729 ) % nodes );
+		}
+	}
+	lemon::StaticDigraph g;
+	g.build( nodes, arcs.begin(), arcs.end() );
+	lemon::StaticDigraph::ArcMap< int > rank( g );
+	for ( int i = 0; i < g.maxArcId() + 1; ++ i ) {
+		rank.set( g.arcFromId(i), ( i % 5 ) ? 2 * i : 1000000 - i );
+	}
+
+	CompressedAdjacency adjacency;
+	adjacency.build( g, rank );
+	EXPECT_EQ(static_cast< size_t >(nodes), adjacency.numNodes());
+	EXPECT_EQ(arcs.size(), adjacency.numArcs());
+
+	CompressedAdjacency::Wants wants;
+	for ( int v = 0; v < nodes; ++ v ) {
+		size_t degree = 0;
+		for ( CompressedAdjacency::OutArcIt a( adjacency, v, wants );
+				a.valid(); ++ a, ++ degree ) {
+			auto const arc = g.arcFromId( a.arc() );
+			EXPECT_EQ(v, g.id( g.source(arc) ));
+			EXPECT_EQ(g.id( g.target(arc) ), static_cast< int >( a.target() ));
+			EXPECT_EQ(rank[arc], a.rank());
+		}
+		EXPECT_EQ(adjacency.outDegree(v), degree);
+	}
+
+	/* Out-arcs of a SmartDigraph run from the last added. */
+	lemon::SmartDigraph smart;
+	auto const n = smart.addNode();
+	smart.addArc( n, n );
+	smart.addArc( n, n );
+	lemon::SmartDigraph::ArcMap< int > smart_rank( smart, 1 );
+	EXPECT_THROW(adjacency.build( smart, smart_rank ), std::logic_error);
+}
+
+/* Deltas of every byte length, in every position of a group;
+ * the SIMD decoder, where supported, must agree with the scalar one. */
+TEST( CompressedAdjacencyTest, Decoders ) {
+	const uint32_t nodes = 300;
+	const uint32_t deltas[] = { 1, 0x100, 0x10000, 0x1000000, 0x7fffffff };
+	std::vector< uint32_t > first_out, targets;
+	std::vector< int > ranks;
+	for ( uint32_t v = 0; v < nodes; ++ v ) {
+		first_out.push_back( targets.size() );
+		uint32_t target = v;
+		for ( uint32_t k = 0; k < v % 23; ++ k ) {
+			const uint32_t delta = deltas[ ( v + k * k ) % 5 ];
+			target += ( ( v + k ) % 2 ) ? delta : 0u - delta;
+			targets.push_back(target);
+			ranks.push_back( static_cast< int >( k * 3 ));
+		}
+	}
+	first_out.push_back( targets.size() );
+
+	CompressedAdjacency adjacency;
+	adjacency.build( first_out, targets, ranks );
+
+	CompressedAdjacency::Wants scalar, simd;
+	for ( uint32_t v = 0; v < nodes; ++ v ) {
+		adjacency.decode( v, scalar, false );
+		const std::vector< uint32_t > expected( targets.begin() + first_out[v],
+				targets.begin() + first_out[ v + 1 ] );
+		EXPECT_EQ(expected, scalar.targets);
+
+		if ( CompressedAdjacency::simd() ) {
+			adjacency.decode( v, simd, true );
+			EXPECT_EQ(scalar.targets, simd.targets);
+			EXPECT_EQ(scalar.ranks, simd.ranks);
+		} else {
+			EXPECT_THROW(adjacency.decode( v, simd, true ), std::logic_error);
+		}
+	}
+}
+
+/* Node rows in id order, arc rows out of source order;
+ * distinct out-degrees and ranks, so that any reordering shows. */
+TEST( InputGraphTest, ReadOrder ) {
+	std::stringstream lgf(
+		"@nodes\n"
+		"label\titem\tofficial_name\tusername\tdummy\n"
+		"\"A\"\t\"A\"\t\"A\"\t\"U0\"\t0\n"
+		"\"B\"\t\"B\"\t\"B\"\t\"U1\"\t0\n"
+		"\"C\"\t\"C\"\t\"C\"\t\"U2\"\t0\n"
+		"\"D\"\t\"D\"\t\"D\"\t\"U3\"\t0\n"
+		"@arcs\n"
+		"\t\trank\n"
+		"\"C\"\t\"A\"\t1\n"
+		"\"A\"\t\"B\"\t2\n"
+		"\"C\"\t\"D\"\t3\n"
+		"\"A\"\t\"D\"\t4\n"
+		"\"B\"\t\"A\"\t5\n"
+		"\"A\"\t\"C\"\t6\n" );
+
+	MathTrader trade_solver;
+	trade_solver.graphReader(lgf);
+
+	/* Node ids are those of the rows. */
+	std::stringstream dot;
+	trade_solver.exportInputToDot(dot);
+	const std::vector< std::string > names = { "A", "B", "C", "D" };
+	for ( size_t i = 0; i < names.size(); ++ i ) {
+		const std::string node = "n" + std::to_string(i)
+			+ " [label=\"" + names[i] + "\"]";
+		EXPECT_NE(std::string::npos, dot.str().find(node)) << node;
+	}
+
+	/* Arc ids by source, in the order read within each source,
+	 * and each rank on its own (source, target). */
+	std::vector< uint32_t > first_out, targets;
+	std::vector< int > ranks;
+	trade_solver.inputAdjacency( first_out, targets, ranks );
+	EXPECT_EQ(std::vector< uint32_t >({ 0, 3, 4, 6, 6 }), first_out);
+	EXPECT_EQ(std::vector< uint32_t >({ 1, 3, 2, 0, 0, 3 }), targets);
+	EXPECT_EQ(std::vector< int >({ 2, 4, 6, 5, 1, 3 }), ranks);
+}
+
+/* All algorithms find the same number of trades at the same cost,
+ * and report their statistics. */
+TEST( SolverStatsTest, GeneratedSmall ) {
+	const std::string input =
+		std::string(SOLVER_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+
+	WantParser want_parser;
+	want_parser.parseFile(input);
+	std::stringstream lgf;
+	want_parser.print(lgf);
+	const std::string graph = lgf.str();
+
+	int64_t total_cost = -1;
+	for ( const std::string algorithm : { "NETWORK-SIMPLEX", "COST-SCALING",
+			"CAPACITY-SCALING", "CYCLE-CANCELING" } ) {
+
+		std::stringstream is(graph);
+		MathTrader trade_solver;
+		trade_solver.graphReader(is);
+		trade_solver.setPriorities(want_parser.getPriorityScheme());
+		trade_solver.setAlgorithm(algorithm);
+		trade_solver.run();
+		trade_solver.mergeDummyItems();
+		EXPECT_EQ(1035, trade_solver.getNumTrades());
+
+		auto const & stats = trade_solver.getSolverStats();
+		EXPECT_EQ(algorithm, stats.algorithm);
+		EXPECT_GT(stats.nodes, 0);
+		EXPECT_GE(stats.arcs, stats.nodes / 2);
+		EXPECT_GT(stats.peak_rss_kb, 0);
+		if ( total_cost < 0 ) {
+			total_cost = stats.total_cost;
+		}
+		EXPECT_EQ(total_cost, stats.total_cost) << algorithm;
+
+		if ( algorithm == "CAPACITY-SCALING" ) {
+			/* One augmenting path per unit of supply, i.e. per item. */
+			ASSERT_EQ(1, stats.counters.size());
+			EXPECT_EQ("augmentations", stats.counters[0].first);
+			EXPECT_EQ(stats.nodes / 2, stats.counters[0].second);
+			EXPECT_TRUE(stats.note.empty());
+		} else {
+			/* Nothing is observed; parameters and estimates are not counters. */
+			EXPECT_TRUE(stats.counters.empty()) << algorithm;
+			EXPECT_FALSE(stats.note.empty()) << algorithm;
+		}
+	}
+}
+
+/* CAPACITY-SCALING reports each augmenting path
+ * and may be cancelled while running;
+ * any algorithm may be cancelled between the phases,
+ * and so may the merge and the route checker. */
+TEST( SolverProgressTest, GeneratedSmall ) {
+	const std::string input =
+		std::string(SOLVER_PROJECT_FIXTURES_DIR)
+		+ "/generated-small-officialwants.txt";
+
+	WantParser want_parser;
+	want_parser.parseFile(input);
+	std::stringstream lgf;
+	want_parser.print(lgf);
+	const std::string graph = lgf.str();
+
+	std::vector< std::string > phases;
+	int64_t steps = 0, total = 0;
+	{
+		std::stringstream is(graph);
+		MathTrader trade_solver;
+		trade_solver.graphReader(is);
+		trade_solver.setAlgorithm("CAPACITY-SCALING");
+		trade_solver.setProgress( [&]( const Progress & progress ) {
+			if ( phases.empty() || ( phases.back() != progress.phase )) {
+				phases.push_back( progress.phase );
+			}
+			steps = std::max( steps, progress.done );
+			total = progress.total ? progress.total : total;
+			if ( progress.has_objective ) {
+				EXPECT_GT(progress.objective, 0);
+			}
+		});
+		trade_solver.run();
+		trade_solver.mergeDummyItems();
+		EXPECT_EQ(1035, trade_solver.getNumTrades());
+	}
+	const std::vector< std::string > expected = {
+		"flow-network", "capacity-scaling", "flow-map", "merge-dummies" };
+	EXPECT_EQ(expected, phases);
+	EXPECT_GT(total, 1035);
+	EXPECT_GT(steps, 0);
+
+	/* Cancel at the first augmenting path. */
+	std::stringstream is(graph);
+	MathTrader trade_solver;
+	trade_solver.graphReader(is);
+	trade_solver.setAlgorithm("CAPACITY-SCALING");
+	trade_solver.setProgress( [&]( const Progress & progress ) {
+		if ( progress.done == 1 ) {
+			Cancellation::request();
+		}
+	});
+	EXPECT_THROW(trade_solver.run(), Cancelled);
+	Cancellation::reset();
+
+	/* An algorithm that cannot be interrupted, cancelled before it starts. */
+	std::stringstream simplex_is(graph);
+	MathTrader simplex_solver;
+	simplex_solver.graphReader(simplex_is);
+	simplex_solver.setAlgorithm("NETWORK-SIMPLEX");
+	Cancellation::request();
+	EXPECT_THROW(simplex_solver.run(), Cancelled);
+	Cancellation::reset();
+
+	/* A cancelled merge leaves the results untouched. */
+	simplex_solver.run();
+	const unsigned trades = simplex_solver.getNumTrades();
+	Cancellation::request();
+	EXPECT_THROW(simplex_solver.mergeDummyItems(), Cancelled);
+	Cancellation::reset();
+	EXPECT_EQ(trades, simplex_solver.getNumTrades());
+	EXPECT_NO_THROW(simplex_solver.verify());
+	simplex_solver.mergeDummyItems();
+	EXPECT_EQ(1035, simplex_solver.getNumTrades());
+
+	std::stringstream checker_is(graph), loops("0001-FVIB\n0001-FVIB\n");
+	RouteChecker route_checker;
+	route_checker.graphReader(checker_is);
+	route_checker.loopReader(loops);
+	Cancellation::request();
+	EXPECT_THROW(route_checker.run(), Cancelled);
+	Cancellation::reset();
+}
+
+/* verify() rejects results corrupted after the merge:
+ * two loops of alice, each through a dummy item of hers,
+ * with merged wants of the same rank. */
+class MathTraderVerifyTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		WantParser want_parser;
+		std::stringstream wants(
+			"#! ALLOW-DUMMIES\n"
+			"(alice) A1 : %A1\n"
+			"(alice) %A1 : B1\n"
+			"(alice) A2 : %A2\n"
+			"(alice) %A2 : C1\n"
+			"(bob) B1 : A1\n"
+			"(carol) C1 : A2\n" ), graph;
+		want_parser.parseStream(wants);
+		want_parser.print(graph);
+
+		trade_solver.graphReader(graph);
+		trade_solver.run();
+		trade_solver.mergeDummyItems();
+		ASSERT_EQ(4, trade_solver.getNumTrades());
+		ASSERT_NO_THROW( trade_solver.verify() );
+	}
+
+	MathTrader::OutputGraph::Node node( const std::string & name ) const {
+		auto const & g = trade_solver._output_graph;
+		for ( MathTrader::OutputGraph::NodeIt n(g); n != lemon::INVALID; ++ n ) {
+			if ( trade_solver._name[ trade_solver._node_out2in[n] ] == name ) {
+				return n;
+			}
+		}
+		return lemon::INVALID;
+	}
+
+	MathTrader::OutputGraph::Arc mergedArc( const std::string & receiver ) const {
+		auto const & g = trade_solver._output_graph;
+		for ( MathTrader::OutputGraph::ArcIt a(g); a != lemon::INVALID; ++ a ) {
+			if ( trade_solver._merged_arc[a] && ( g.source(a) == node(receiver) )) {
+				return a;
+			}
+		}
+		return lemon::INVALID;
+	}
+
+	void setReceive( const std::string & receiver, const std::string & sender ) {
+		trade_solver._receive[ node(receiver) ] = node(sender);
+	}
+
+	void unchoose( MathTrader::OutputGraph::Arc a ) {
+		trade_solver._chosen_arc[a] = false;
+	}
+
+	void swapMergedPaths( MathTrader::OutputGraph::Arc a,
+			MathTrader::OutputGraph::Arc b ) {
+		std::swap( trade_solver._merged_path[a], trade_solver._merged_path[b] );
+	}
+
+	const ItemTable & items() const {
+		return trade_solver._items;
+	}
+
+	MathTrader trade_solver;
+};
+
+/* A re-read replaces the item table, not appends to it. */
+TEST_F( MathTraderVerifyTest, ReRead ) {
+	WantParser want_parser;
+	std::stringstream wants( "(bob) B1 : C1\n(carol) C1 : B1\n" ), graph;
+	want_parser.parseStream(wants);
+	want_parser.print(graph);
+
+	trade_solver.graphReader(graph);
+	EXPECT_EQ(2, items().size());
+	EXPECT_EQ(2, items().numUsers());
+
+	trade_solver.run();
+	EXPECT_EQ(2, trade_solver.getNumTrades());
+	EXPECT_NO_THROW( trade_solver.verify() );
+	EXPECT_TRUE( node("C1") != lemon::INVALID );
+	EXPECT_TRUE( node("A1") == lemon::INVALID );
+}
+
+TEST_F( MathTraderVerifyTest, CorruptReceive ) {
+	setReceive( "A1", "C1" );
+	EXPECT_THROW( trade_solver.verify(), std::runtime_error );
+}
+
+TEST_F( MathTraderVerifyTest, CorruptChosenArc ) {
+	unchoose( mergedArc("A1") );
+	EXPECT_THROW( trade_solver.verify(), std::runtime_error );
+}
+
+/* A1 wants a dummy item of alice with the rank of its merged want,
+ * but not the one that leads to its actual sender. */
+TEST_F( MathTraderVerifyTest, CorruptMergedPath ) {
+	auto const a1 = mergedArc("A1"), a2 = mergedArc("A2");
+	ASSERT_TRUE( a1 != lemon::INVALID );
+	ASSERT_TRUE( a2 != lemon::INVALID );
+	swapMergedPaths( a1, a2 );
+	EXPECT_THROW( trade_solver.verify(), std::runtime_error );
+}
+
+/* The solved loops, dummy items included, must pass the RouteChecker;
+ * a loop through a missing arc must not. */
+TEST( RouteCheckerTest, GeneratedMedium ) {
+	const std::string input =
+		std::string(SOLVER_PROJECT_FIXTURES_DIR)
+		+ "/generated-medium-officialwants.txt";
+
+	WantParser want_parser;
+	std::stringstream graph;
+	want_parser.parseFile(input);
+	want_parser.print(graph);
+	const std::string lgf = graph.str();
+
+	MathTrader trade_solver;
+	trade_solver.graphReader(graph);
+	trade_solver.run();
+
+	std::stringstream results, loops;
+	trade_solver.writeResults(results);
+	ResultParser result_parser;
+	result_parser.parse(results);
+	result_parser.print(loops);
+
+	std::stringstream checker_graph(lgf);
+	RouteChecker route_checker;
+	route_checker.graphReader(checker_graph);
+	route_checker.loopReader(loops);
+	EXPECT_NO_THROW( route_checker.run() );
+
+	/* Same loops, without going through text. */
+	route_checker.loopReader( result_parser.getItems(),
+			result_parser.getLoops() );
+	EXPECT_NO_THROW( route_checker.run() );
+
+	std::stringstream broken("0001-FVIB\n0001-FVIB\n");
+	route_checker.loopReader(broken);
+	EXPECT_THROW( route_checker.run(), std::runtime_error );
+
+	/* check() reports all violations instead of the first one. */
+	const std::vector< std::string > items = { "0001-FVIB", "UNKNOWN" };
+	const std::vector< uint32_t > ids = {
+		0, 0,	// no self-arc
+		1, 1,	// unknown item, twice
+	};
+	auto const result = route_checker.check( items, ids );
+	EXPECT_EQ( 3u, result.violations.size() );
+}
 
 void testUsecase( unsigned trade_num, unsigned num_trades ) {
 	const std::string input = "http://bgg.activityclub.org/olwlg/"
@@ -37,19 +531,23 @@ void testUsecase( unsigned trade_num, unsigned num_trades ) {
 	MathTrader trade_solver;
 	trade_solver.graphReader(graph);
 	trade_solver.run();
+	EXPECT_NO_THROW( trade_solver.verify() );
 	trade_solver.mergeDummyItems();
+	EXPECT_NO_THROW( trade_solver.verify() );
 	EXPECT_EQ(num_trades, trade_solver.getNumTrades());
 }
 
-TEST( WantParserTest, 2016_April_GR_url ) {
+/* Online trades; these require network access.
+ * Run with --gtest_also_run_disabled_tests. */
+TEST( WantParserTest, DISABLED_2016_April_GR_url ) {
 	testUsecase( 207635, 268 );
 }
 
-TEST( WantParserTest, 2018_Origins_url ) {
+TEST( WantParserTest, DISABLED_2018_Origins_url ) {
 	testUsecase( 240154, 1349 );
 }
 
-TEST( WantParserTest, 2018_June_UK_url ) {
+TEST( WantParserTest, DISABLED_2018_June_UK_url ) {
 	testUsecase( 241767, 241 );
 }
 
@@ -58,3 +556,36 @@ int main( int argc, char ** argv ) {
 	testing::InitGoogleTest( &argc, argv );
 	return RUN_ALL_TESTS();
 }
+
+/* Re-reading a graph of the same size invalidates the indices. */
+TEST( RouteCheckerTest, ReReadSameSize ) {
+	auto const lgf = []( const std::string & wants ) {
+		WantParser want_parser;
+		std::stringstream is(wants), graph;
+		want_parser.parseStream(is);
+		want_parser.print(graph);
+		return graph.str();
+	};
+
+	RouteChecker route_checker;
+	std::stringstream first( lgf("(alice) A1 : B1\n(bob) B1 : A1\n") );
+	route_checker.graphReader(first);
+	std::stringstream first_loop("A1\nB1\nA1\n");
+	route_checker.loopReader(first_loop);
+	EXPECT_NO_THROW( route_checker.run() );
+
+	std::stringstream second( lgf("(carol) C1 : D1\n(dave) D1 : C1\n") );
+	route_checker.graphReader(second);
+	const std::vector< std::string > items = { "C1", "D1" };
+	const std::vector< uint32_t > ids = { 0, 1, 0 };
+	EXPECT_THROW( route_checker.check( items, ids ), std::logic_error );
+
+	std::stringstream second_loop("C1\nD1\nC1\n");
+	route_checker.loopReader(second_loop);
+	EXPECT_NO_THROW( route_checker.run() );
+	EXPECT_TRUE( route_checker.check( items, ids ).violations.empty() );
+
+	std::stringstream stale_loop("A1\nB1\nA1\n");
+	route_checker.loopReader(stale_loop);
+	EXPECT_THROW( route_checker.run(), std::runtime_error );
+}